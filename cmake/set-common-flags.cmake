@@ -4,7 +4,7 @@
 function(set_common_flags target_name)
     target_compile_options(${target_name} PRIVATE -std=c++17 -Wall -Werror -Wformat=2 -Wwrite-strings -Wvla
             -fvisibility=hidden -fno-common -funsigned-char -Wextra -Wunused -Wcomment -Wchar-subscripts -Wuninitialized
-            -Wunused-result -Wfatal-errors)
+            -Wunused-result -Wfatal-errors -fopenmp-simd)
     if (CMAKE_CXX_COMPILER_ID STREQUAL "Clang")
         target_compile_options(${target_name} PRIVATE -Wmissing-declarations -Wmissing-field-initializers -Wshadow
                 -Wpedantic)
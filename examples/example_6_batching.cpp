@@ -0,0 +1,77 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/hit.h"
+#include <glog/logging.h>
+
+using namespace std;
+using namespace hit;
+
+// defined in example_1_ckks.cpp
+extern vector<double> random_vector(int dim, double maxNorm);
+
+/* A common workload is to multiply the same encrypted matrix (say, a layer of a model)
+ * by many encrypted vectors (say, a batch of inputs). This example compares calling
+ * `multiply` once per vector to `multiply_batch`, which handles the whole batch at once,
+ * and reports the throughput of each in vectors per second.
+ *
+ * ******** Batching ********
+ * When a matrix is narrower than its encoding unit, most of the columns of each unit are
+ * zero padding. `multiply_batch` uses these columns to hold products with other vectors in
+ * the batch, so the expensive parts of the product (relinearization, rescaling, and most of
+ * the rotations which sum the columns) are shared by several vectors. The outputs are the
+ * same as calling `multiply` on each vector, including their level and scale, so
+ * `multiply_batch` can be used as a drop-in replacement.
+ */
+void example_6_driver() {
+	int num_slots = 8192;
+	int max_depth = 2;
+	int log_scale = 40;
+	int batch_size = 32;
+	double max_norm = 10;
+
+	HomomorphicEval he_inst = HomomorphicEval(num_slots, max_depth, log_scale);
+	LinearAlgebra la_inst = LinearAlgebra(he_inst); // NOLINT(modernize-use-auto)
+
+	// A 64x128 unit holds a 64x24 matrix in a single unit with 104 columns of padding,
+	// so products with four vectors (each using 32 columns) fit in each unit.
+	EncodingUnit unit = la_inst.make_unit(64);
+	int height = 64;
+	int width = 24;
+	Matrix mat = Matrix(height, width, random_vector(height * width, max_norm));
+	EncryptedMatrix enc_mat = la_inst.encrypt_matrix(mat, unit);
+
+	vector<Vector> vecs(batch_size);
+	vector<EncryptedColVector> enc_vecs(batch_size);
+	for (int k = 0; k < batch_size; k++) {
+		vecs[k] = Vector(random_vector(width, max_norm));
+		enc_vecs[k] = la_inst.encrypt_col_vector(vecs[k], unit);
+	}
+
+	// Multiply the matrix by each vector individually.
+	timepoint start = chrono::steady_clock::now();
+	vector<EncryptedRowVector> results(batch_size);
+	for (int k = 0; k < batch_size; k++) {
+		results[k] = la_inst.multiply(enc_mat, enc_vecs[k]);
+	}
+	timepoint end = chrono::steady_clock::now();
+	double unbatched_secs = static_cast<double>(max<uint64_t>(elapsed_time_in_ms(start, end), 1)) / 1000;
+
+	// Multiply the matrix by the whole batch.
+	start = chrono::steady_clock::now();
+	vector<EncryptedRowVector> batch_results = la_inst.multiply_batch(enc_mat, enc_vecs);
+	end = chrono::steady_clock::now();
+	double batched_secs = static_cast<double>(max<uint64_t>(elapsed_time_in_ms(start, end), 1)) / 1000;
+
+	double max_err = 0;
+	for (int k = 0; k < batch_size; k++) {
+		Vector expected = prec_prod(mat, vecs[k]);
+		max_err = max(max_err, relative_error(expected, la_inst.decrypt(results[k], true)));
+		max_err = max(max_err, relative_error(expected, la_inst.decrypt(batch_results[k], true)));
+	}
+
+	LOG(INFO) << "Multiplied a " << height << "x" << width << " matrix by " << batch_size << " vectors";
+	LOG(INFO) << "  multiply:       " << batch_size / unbatched_secs << " vectors/sec";
+	LOG(INFO) << "  multiply_batch: " << batch_size / batched_secs << " vectors/sec";
+	LOG(INFO) << "  maximum relative error: " << max_err;
+}
@@ -0,0 +1,84 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/hit.h"
+#include <glog/logging.h>
+#include <seal/seal.h>
+
+using namespace std;
+using namespace hit;
+
+// defined in example_1_ckks.cpp
+extern vector<double> random_vector(int dim, double maxNorm);
+
+/* Every out-of-place LinearAlgebra function (`add`, `hadamard_multiply`, `rescale_to_next`, ...)
+ * has an overload for temporary arguments which modifies the temporary in place and moves it into
+ * the result, rather than copying all of its ciphertexts. This means that chained expressions like
+ *
+ *     rescale_to_next(relinearize(hadamard_multiply(a, b)))
+ *
+ * only allocate ciphertexts for the first intermediate result. This example measures the memory
+ * allocated by SEAL while evaluating such a chain when each intermediate result is an lvalue (which
+ * must be copied, as every call did before these overloads existed), and when each intermediate
+ * result is a temporary.
+ */
+
+// Run `f` with all SEAL allocations served from a fresh memory pool, and return the number of
+// bytes allocated by that pool.
+size_t pool_bytes_allocated(const function<void()> &f) {
+	seal::MemoryPoolHandle pool = seal::MemoryPoolHandle::New();
+	seal::MMProfGuard guard(make_unique<seal::MMProfFixed>(pool));
+	f();
+	return pool.alloc_byte_count();
+}
+
+void example_7_driver() {
+	int num_slots = 8192;
+	int max_depth = 1;
+	int log_scale = 40;
+	int dim = 128;
+	double max_norm = 10;
+
+	HomomorphicEval he_inst = HomomorphicEval(num_slots, max_depth, log_scale);
+	LinearAlgebra la_inst = LinearAlgebra(he_inst); // NOLINT(modernize-use-auto)
+
+	EncodingUnit unit = la_inst.make_unit(64);
+	Matrix mat_a = Matrix(dim, dim, random_vector(dim * dim, max_norm));
+	Matrix mat_b = Matrix(dim, dim, random_vector(dim * dim, max_norm));
+	EncryptedMatrix enc_mat_a = la_inst.encrypt_matrix(mat_a, unit);
+	EncryptedMatrix enc_mat_b = la_inst.encrypt_matrix(mat_b, unit);
+
+	// Each intermediate result is named, so each call copies its input.
+	EncryptedMatrix copied_result;
+	timepoint start = chrono::steady_clock::now();
+	size_t copied_bytes = pool_bytes_allocated([&]() {
+		EncryptedMatrix prod = la_inst.hadamard_multiply(enc_mat_a, enc_mat_b);
+		EncryptedMatrix relin_prod = la_inst.relinearize(prod);
+		copied_result = la_inst.rescale_to_next(relin_prod);
+	});
+	timepoint end = chrono::steady_clock::now();
+	uint64_t copied_ms = elapsed_time_in_ms(start, end);
+
+	// Each intermediate result is a temporary, so each call reuses the ciphertexts of its input.
+	EncryptedMatrix moved_result;
+	start = chrono::steady_clock::now();
+	size_t moved_bytes = pool_bytes_allocated([&]() {
+		moved_result =
+			la_inst.rescale_to_next(la_inst.relinearize(la_inst.hadamard_multiply(enc_mat_a, enc_mat_b)));
+	});
+	end = chrono::steady_clock::now();
+	uint64_t moved_ms = elapsed_time_in_ms(start, end);
+
+	Matrix expected = element_prod(mat_a, mat_b);
+	double max_err = max(relative_error(expected, la_inst.decrypt(copied_result, true)),
+	                     relative_error(expected, la_inst.decrypt(moved_result, true)));
+
+	LOG(INFO) << "Evaluated rescale_to_next(relinearize(hadamard_multiply(a, b))) on " << dim << "x" << dim
+	          << " matrices (" << enc_mat_a.num_vertical_units() * enc_mat_a.num_horizontal_units()
+	          << " ciphertexts each)";
+	LOG(INFO) << "  with lvalue intermediates:    " << copied_bytes / (1 << 20) << " MB allocated, " << copied_ms
+	          << " ms";
+	LOG(INFO) << "  with temporary intermediates: " << moved_bytes / (1 << 20) << " MB allocated, " << moved_ms
+	          << " ms";
+	LOG(INFO) << "  maximum relative error: " << max_err;
+}
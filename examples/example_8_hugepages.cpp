@@ -0,0 +1,59 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/hit.h"
+#include <glog/logging.h>
+#include <seal/seal.h>
+
+using namespace std;
+using namespace hit;
+
+// defined in example_1_ckks.cpp
+extern vector<double> random_vector(int dim, double maxNorm);
+
+/* Rotations and relinearizations perform a key switch, which reads an evaluation key that is many
+ * times larger than the ciphertext being switched. With 4 KB pages, every key switch touches
+ * thousands of pages, and the resulting TLB misses are a noticeable part of its cost.
+ * `HomomorphicEval::advise_huge_pages` asks the kernel to back the evaluation keys with 2 MB
+ * transparent huge pages instead. This example measures the time for a sequence of key switches
+ * before and after giving that advice. The speedup depends on the kernel's transparent huge page
+ * settings (see /sys/kernel/mm/transparent_hugepage/enabled); if they are disabled, no memory is
+ * advised and both timings should match.
+ */
+
+// Time `num_iters` rotations and relinearizations of `ct`
+uint64_t time_key_switches(HomomorphicEval &he_inst, const CKKSCiphertext &ct, int num_iters) {
+	CKKSCiphertext prod = he_inst.multiply(ct, ct);
+	CKKSCiphertext rot;
+	CKKSCiphertext relin;
+	timepoint start = chrono::steady_clock::now();
+	for (int i = 0; i < num_iters; i++) {
+		he_inst.rotate_left(ct, 1 << (i % 8), rot);
+		he_inst.relinearize(prod, relin);
+	}
+	timepoint end = chrono::steady_clock::now();
+	return elapsed_time_in_ms(start, end);
+}
+
+void example_8_driver() {
+	int num_slots = 8192;
+	int max_depth = 3;
+	int log_scale = 40;
+	int num_iters = 64;
+	double max_norm = 10;
+
+	HomomorphicEval he_inst = HomomorphicEval(num_slots, max_depth, log_scale);
+	CKKSCiphertext ct = he_inst.encrypt(random_vector(num_slots, max_norm));
+
+	// warm up SEAL's memory pools so that neither timing includes their first allocations
+	time_key_switches(he_inst, ct, 1);
+
+	uint64_t base_ms = time_key_switches(he_inst, ct, num_iters);
+	size_t advised_bytes = he_inst.advise_huge_pages();
+	uint64_t huge_page_ms = time_key_switches(he_inst, ct, num_iters);
+
+	LOG(INFO) << "Evaluated " << num_iters << " rotations and relinearizations with " << num_slots << " slots";
+	LOG(INFO) << "  advised " << bytes_to_str(advised_bytes) << " of evaluation keys to use huge pages";
+	LOG(INFO) << "  with default pages: " << base_ms << " ms";
+	LOG(INFO) << "  with huge pages:    " << huge_page_ms << " ms";
+}
@@ -5,6 +5,8 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+
 #include "../common.h"
 #include "../sealutils.h"
 
@@ -34,7 +36,7 @@ namespace hit {
 
         if (proto_ct.has_seal_ct()) {
             istringstream ctstream(proto_ct.seal_ct());
-            seal_ct.load(*context, ctstream);
+            seal_ct.overwrite().load(*context, ctstream);
         }
     }
 
@@ -51,7 +53,7 @@ namespace hit {
     protobuf::Ciphertext *CKKSCiphertext::serialize() const {
         auto *proto_ct = new protobuf::Ciphertext();
 
-        if (!raw_pt.empty()) {
+        if (!raw_pt.get().empty()) {
             LOG_AND_THROW_STREAM(
                 "HIT does not support serializing ciphertexts with plaintext data attached! Use the homomorphic "
                 "evaluator to serialize ciphertexts.");
@@ -62,9 +64,9 @@ namespace hit {
         proto_ct->set_he_level(he_level_);
 
         // if the seal_ct is initialized, serialize it
-        if (seal_ct.parms_id() != parms_id_zero) {
+        if (seal_ct.get().parms_id() != parms_id_zero) {
             ostringstream sealctBuf;
-            seal_ct.save(sealctBuf);
+            seal_ct.get().save(sealctBuf);
             proto_ct->set_seal_ct(sealctBuf.str());
         }
 
@@ -99,9 +101,18 @@ namespace hit {
     }
 
     vector<double> CKKSCiphertext::plaintext() const {
-        if (raw_pt.empty()) {
+        if (raw_pt.get().empty()) {
             LOG_AND_THROW_STREAM("Ciphertext does not contain a plaintext.");
         }
-        return raw_pt;
+        const vector<double> &pt = raw_pt.get();
+        if (pt_rotation_ == 0) {
+            return pt;
+        }
+        vector<double> rotated_pt(pt.size());
+        for (size_t first = 0; first < pt.size(); first += num_slots_) {
+            rotate_copy(pt.begin() + first, pt.begin() + first + pt_rotation_, pt.begin() + first + num_slots_,
+                        rotated_pt.begin() + first);
+        }
+        return rotated_pt;
     }
 }  // namespace hit
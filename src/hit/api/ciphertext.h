@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include "copyonwrite.h"
 #include "hit/protobuf/ciphertext.pb.h"
 #include "metadata.h"
 #include "seal/context.h"
@@ -10,6 +11,8 @@
 
 namespace hit {
     /* This is a wrapper around the SEAL `Ciphertext` type.
+     * The SEAL ciphertext and the raw plaintext are copy-on-write: copying a CKKSCiphertext
+     * is cheap, and the payload is only duplicated when one of the copies is modified.
      */
     struct CKKSCiphertext : public CiphertextMetadata<std::vector<double>> {
         // A default constructor is useful since we often write, e.g, `Ciphertext a;`
@@ -44,6 +47,7 @@ namespace hit {
         std::vector<double> plaintext() const override;
 
         // all evaluators need access for encryption and decryption
+        friend class BoundsEstimator;
         friend class DebugEval;
         friend class DepthFinder;
         friend class HomomorphicEval;
@@ -58,14 +62,23 @@ namespace hit {
         // The raw plaintxt. This is used with some of the evaluators tha track ciphertext
         // metadata (e.g., DebugEval and PlaintextEval), but not by the Homomorphic evaluator.
         // This plaintext is not CKKS-encoded; in particular it is not scaled by the scale factor.
-        std::vector<double> raw_pt;
+        CopyOnWrite<std::vector<double>> raw_pt;
+
+        // PlaintextEval rotates a ciphertext by updating this offset instead of moving the values in `raw_pt`:
+        // slot i of the plaintext is stored at index (i + pt_rotation_) % num_slots_ of `raw_pt`
+        // (in each sample, for a batched PlaintextEval). `plaintext()` applies the rotation.
+        int pt_rotation_ = 0;
 
         // SEAL ciphertext
-        seal::Ciphertext seal_ct;
+        CopyOnWrite<seal::Ciphertext> seal_ct;
 
         // `scale` is used by the ScaleEstimator evaluator
         double scale_ = pow(2, 30);
 
+        // an interval containing the value in every slot, which is used by the BoundsEstimator evaluator
+        double lower_bound_ = 0;
+        double upper_bound_ = 0;
+
         // flag indicating whether this CT has been initialized or not
         // CKKSCiphertexts are initialized upon encryption
         bool initialized = false;
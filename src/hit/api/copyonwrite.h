@@ -0,0 +1,78 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+namespace hit {
+    /* A value of type T whose storage is shared between copies until one of them is modified.
+     * Copying a CopyOnWrite<T> only copies a pointer, so copies which are only read never
+     * duplicate the underlying value. The first mutable access to a shared value clones it,
+     * so a modification is never visible through any other copy.
+     *
+     * Thread safety matches that of T: distinct objects may be used concurrently, even when
+     * they share storage, but a single object may not be modified concurrently with any other
+     * access to that same object.
+     */
+    template <typename T>
+    class CopyOnWrite {
+       public:
+        CopyOnWrite() = default;
+
+        // Read-only access to the value. A default-constructed or moved-from object holds
+        // a default-constructed T.
+        const T &get() const {
+            if (!value) {
+                return empty();
+            }
+            return *value;
+        }
+
+        // Mutable access to the value. If the value is shared with another copy,
+        // it is cloned first.
+        T &mutate() {
+            if (!value) {
+                value = std::make_shared<T>();
+            } else if (!unique()) {
+                value = std::make_shared<T>(*value);
+            }
+            return *value;
+        }
+
+        // Mutable access to the value for a caller which is about to replace it entirely.
+        // This is the same as `mutate()`, except that a shared value is replaced by a
+        // default-constructed T rather than cloned. An unshared value is returned as-is,
+        // so its allocation can be reused.
+        T &overwrite() {
+            if (!value || !unique()) {
+                value = std::make_shared<T>();
+            }
+            return *value;
+        }
+
+        // Output true if this object shares its value with another copy.
+        bool shared() const {
+            return value && value.use_count() > 1;
+        }
+
+       private:
+        bool unique() const {
+            if (value.use_count() > 1) {
+                return false;
+            }
+            // `use_count` is a relaxed load. Other copies may have released the value on other
+            // threads after reading it; make sure those reads happen before we modify it.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return true;
+        }
+
+        static const T &empty() {
+            static const T empty_value;
+            return empty_value;
+        }
+
+        std::shared_ptr<T> value;
+    };
+}  // namespace hit
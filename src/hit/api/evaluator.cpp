@@ -26,13 +26,22 @@ namespace hit {
         LOG_AND_THROW_STREAM("Decrypt can only be called with Homomorphic or Debug evaluators");
     }
 
+    CKKSCiphertext CKKSEvaluator::encrypt_placeholder() {
+        return encrypt_placeholder(-1);
+    }
+
+    CKKSCiphertext CKKSEvaluator::encrypt_placeholder(int) {
+        LOG_AND_THROW_STREAM("Placeholder ciphertexts can only be encrypted with DepthFinder, OpCount, "
+                             << "or BoundsEstimator evaluators");
+    }
+
     CKKSCiphertext CKKSEvaluator::rotate_right(const CKKSCiphertext &ct, int steps) {
-        CKKSCiphertext output = ct;
-        rotate_right_inplace(output, steps);
+        CKKSCiphertext output;
+        rotate_right(ct, steps, output);
         return output;
     }
 
-    void CKKSEvaluator::rotate_right_inplace(CKKSCiphertext &ct, int steps) {
+    void CKKSEvaluator::rotate_right(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) {
         if (steps < 0) {
             LOG_AND_THROW_STREAM("rotate_right must have a positive number of steps, got " << steps);
         }
@@ -40,17 +49,25 @@ namespace hit {
             LOG_AND_THROW_STREAM("Input to rotate_right must be a linear ciphertext");
         }
         VLOG(VLOG_EVAL) << "Rotate " << abs(steps) << " steps right.";
-        rotate_right_inplace_internal(ct, steps);
-        print_stats(ct);
+        if (&ct == &dest) {
+            rotate_right_inplace_internal(dest, steps);
+        } else {
+            rotate_right_internal(ct, steps, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::rotate_right_inplace(CKKSCiphertext &ct, int steps) {
+        rotate_right(ct, steps, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::rotate_left(const CKKSCiphertext &ct, int steps) {
-        CKKSCiphertext output = ct;
-        rotate_left_inplace(output, steps);
+        CKKSCiphertext output;
+        rotate_left(ct, steps, output);
         return output;
     }
 
-    void CKKSEvaluator::rotate_left_inplace(CKKSCiphertext &ct, int steps) {
+    void CKKSEvaluator::rotate_left(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) {
         if (steps < 0) {
             LOG_AND_THROW_STREAM("rotate_left must have a positive number of steps, got " << steps);
         }
@@ -58,29 +75,45 @@ namespace hit {
             LOG_AND_THROW_STREAM("Input to rotate_left must be a linear ciphertext");
         }
         VLOG(VLOG_EVAL) << "Rotate " << abs(steps) << " steps left.";
-        rotate_left_inplace_internal(ct, steps);
-        print_stats(ct);
+        if (&ct == &dest) {
+            rotate_left_inplace_internal(dest, steps);
+        } else {
+            rotate_left_internal(ct, steps, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::rotate_left_inplace(CKKSCiphertext &ct, int steps) {
+        rotate_left(ct, steps, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::negate(const CKKSCiphertext &ct) {
-        CKKSCiphertext output = ct;
-        negate_inplace(output);
+        CKKSCiphertext output;
+        negate(ct, output);
         return output;
     }
 
-    void CKKSEvaluator::negate_inplace(CKKSCiphertext &ct) {
+    void CKKSEvaluator::negate(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Negate";
-        negate_inplace_internal(ct);
-        print_stats(ct);
+        if (&ct == &dest) {
+            negate_inplace_internal(dest);
+        } else {
+            negate_internal(ct, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::negate_inplace(CKKSCiphertext &ct) {
+        negate(ct, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::add(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        CKKSCiphertext temp = ct1;
-        add_inplace(temp, ct2);
-        return temp;
+        CKKSCiphertext output;
+        add(ct1, ct2, output);
+        return output;
     }
 
-    void CKKSEvaluator::add_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+    void CKKSEvaluator::add(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Add ciphertexts";
         if (ct1.scale() != ct2.scale()) {
             LOG_AND_THROW_STREAM("Inputs to add must have the same scale: " << log2(ct1.scale()) << " bits != "
@@ -90,37 +123,64 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to add must be at the same level: " << ct1.he_level()
                                                                              << " != " << ct2.he_level());
         }
-        add_inplace_internal(ct1, ct2);
-        print_stats(ct1);
+        if (&ct1 == &dest) {
+            add_inplace_internal(dest, ct2);
+        } else if (&ct2 == &dest) {
+            // addition is commutative
+            add_inplace_internal(dest, ct1);
+        } else {
+            add_internal(ct1, ct2, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::add_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        add(ct1, ct2, ct1);
     }
 
     CKKSCiphertext CKKSEvaluator::add_plain(const CKKSCiphertext &ct, double scalar) {
-        CKKSCiphertext output = ct;
-        add_plain_inplace(output, scalar);
+        CKKSCiphertext output;
+        add_plain(ct, scalar, output);
         return output;
     }
 
-    void CKKSEvaluator::add_plain_inplace(CKKSCiphertext &ct, double scalar) {
+    void CKKSEvaluator::add_plain(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Add scalar " << scalar << " to ciphertext";
-        add_plain_inplace_internal(ct, scalar);
-        print_stats(ct);
+        if (&ct == &dest) {
+            add_plain_inplace_internal(dest, scalar);
+        } else {
+            add_plain_internal(ct, scalar, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::add_plain_inplace(CKKSCiphertext &ct, double scalar) {
+        add_plain(ct, scalar, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::add_plain(const CKKSCiphertext &ct, const vector<double> &plain) {
-        CKKSCiphertext output = ct;
-        add_plain_inplace(output, plain);
+        CKKSCiphertext output;
+        add_plain(ct, plain, output);
         return output;
     }
 
-    void CKKSEvaluator::add_plain_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+    void CKKSEvaluator::add_plain(const CKKSCiphertext &ct, const vector<double> &plain, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Add plaintext to ciphertext";
         if (plain.size() != ct.num_slots()) {
             LOG_AND_THROW_STREAM("Public argument to add_plain must have exactly as many "
                                  << " coefficients as the ciphertext has plaintext slots: "
                                  << "Expected " << ct.num_slots() << " coeffs, got " << plain.size());
         }
-        add_plain_inplace_internal(ct, plain);
-        print_stats(ct);
+        if (&ct == &dest) {
+            add_plain_inplace_internal(dest, plain);
+        } else {
+            add_plain_internal(ct, plain, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::add_plain_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+        add_plain(ct, plain, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::add_many(const vector<CKKSCiphertext> &cts) {
@@ -129,16 +189,25 @@ namespace hit {
         }
         VLOG(VLOG_EVAL) << "Add ciphertext vector of size " << cts.size();
 
-        CKKSCiphertext dest = cts[0];
         for (int i = 1; i < cts.size(); i++) {
-            if (cts[i].scale() != dest.scale()) {
+            if (cts[i].scale() != cts[0].scale()) {
                 LOG_AND_THROW_STREAM("Inputs to add_many must have the same scale: "
-                                     << log2(cts[i].scale()) << " bits != " << log2(dest.scale()) << " bits");
+                                     << log2(cts[i].scale()) << " bits != " << log2(cts[0].scale()) << " bits");
             }
-            if (cts[i].he_level() != dest.he_level()) {
+            if (cts[i].he_level() != cts[0].he_level()) {
                 LOG_AND_THROW_STREAM("Inputs to add_many must be at the same level: " << cts[i].he_level()
-                                                                                      << " != " << dest.he_level());
+                                                                                      << " != " << cts[0].he_level());
             }
+        }
+
+        CKKSCiphertext dest;
+        if (cts.size() == 1) {
+            dest = cts[0];
+        } else {
+            // the first sum is written directly to `dest`, rather than to a copy of `cts[0]`
+            add_internal(cts[0], cts[1], dest);
+        }
+        for (int i = 2; i < cts.size(); i++) {
             add_inplace_internal(dest, cts[i]);
         }
         print_stats(dest);
@@ -146,12 +215,12 @@ namespace hit {
     }
 
     CKKSCiphertext CKKSEvaluator::sub(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        CKKSCiphertext temp = ct1;
-        sub_inplace(temp, ct2);
-        return temp;
+        CKKSCiphertext output;
+        sub(ct1, ct2, output);
+        return output;
     }
 
-    void CKKSEvaluator::sub_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+    void CKKSEvaluator::sub(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Subtract ciphertexts";
         if (ct1.scale() != ct2.scale()) {
             LOG_AND_THROW_STREAM("Inputs to sub must have the same scale: " << log2(ct1.scale()) << " bits != "
@@ -161,46 +230,74 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to sub must be at the same level: " << ct1.he_level()
                                                                              << " != " << ct2.he_level());
         }
-        sub_inplace_internal(ct1, ct2);
-        print_stats(ct1);
+        if (&ct1 == &dest) {
+            sub_inplace_internal(dest, ct2);
+        } else if (&ct2 == &dest) {
+            // `dest` may not be an input of `sub_internal`; this copy shares `ct2`'s storage
+            CKKSCiphertext temp = ct2;
+            sub_internal(ct1, temp, dest);
+        } else {
+            sub_internal(ct1, ct2, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::sub_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        sub(ct1, ct2, ct1);
     }
 
     CKKSCiphertext CKKSEvaluator::sub_plain(const CKKSCiphertext &ct, double scalar) {
-        CKKSCiphertext output = ct;
-        sub_plain_inplace(output, scalar);
+        CKKSCiphertext output;
+        sub_plain(ct, scalar, output);
         return output;
     }
 
-    void CKKSEvaluator::sub_plain_inplace(CKKSCiphertext &ct, double scalar) {
+    void CKKSEvaluator::sub_plain(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Subtract scalar " << scalar << " from ciphertext";
-        sub_plain_inplace_internal(ct, scalar);
-        print_stats(ct);
+        if (&ct == &dest) {
+            sub_plain_inplace_internal(dest, scalar);
+        } else {
+            sub_plain_internal(ct, scalar, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::sub_plain_inplace(CKKSCiphertext &ct, double scalar) {
+        sub_plain(ct, scalar, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::sub_plain(const CKKSCiphertext &ct, const vector<double> &plain) {
-        CKKSCiphertext output = ct;
-        sub_plain_inplace(output, plain);
+        CKKSCiphertext output;
+        sub_plain(ct, plain, output);
         return output;
     }
 
-    void CKKSEvaluator::sub_plain_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+    void CKKSEvaluator::sub_plain(const CKKSCiphertext &ct, const vector<double> &plain, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Subtract plaintext from ciphertext";
         if (plain.size() != ct.num_slots()) {
             LOG_AND_THROW_STREAM("Public argument to sub_plain must have exactly as many "
                                  << " coefficients as the ciphertext has plaintext slots: "
                                  << "Expected " << ct.num_slots() << " coeffs, got " << plain.size());
         }
-        sub_plain_inplace_internal(ct, plain);
-        print_stats(ct);
+        if (&ct == &dest) {
+            sub_plain_inplace_internal(dest, plain);
+        } else {
+            sub_plain_internal(ct, plain, dest);
+        }
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::sub_plain_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+        sub_plain(ct, plain, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::multiply(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        CKKSCiphertext temp = ct1;
-        multiply_inplace(temp, ct2);
-        return temp;
+        CKKSCiphertext output;
+        multiply(ct1, ct2, output);
+        return output;
     }
 
-    void CKKSEvaluator::multiply_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+    void CKKSEvaluator::multiply(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Multiply ciphertexts";
         if (ct1.needs_relin() || ct2.needs_relin()) {
             LOG_AND_THROW_STREAM("Inputs to multiply must be linear ciphertexts");
@@ -216,37 +313,56 @@ namespace hit {
             LOG_AND_THROW_STREAM("Inputs to multiply must have the same scale: " << log2(ct1.scale()) << " bits != "
                                                                                  << log2(ct2.scale()) << " bits");
         }
-        multiply_inplace_internal(ct1, ct2);
-        ct1.needs_rescale_ = true;
-        ct1.needs_relin_ = true;
-        ct1.scale_ *= ct1.scale_;
-        print_stats(ct1);
+        if (&ct1 == &dest) {
+            multiply_inplace_internal(dest, ct2);
+        } else if (&ct2 == &dest) {
+            // multiplication is commutative
+            multiply_inplace_internal(dest, ct1);
+        } else {
+            multiply_internal(ct1, ct2, dest);
+        }
+        dest.needs_rescale_ = true;
+        dest.needs_relin_ = true;
+        dest.scale_ *= dest.scale_;
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::multiply_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        multiply(ct1, ct2, ct1);
     }
 
     CKKSCiphertext CKKSEvaluator::multiply_plain(const CKKSCiphertext &ct, double scalar) {
-        CKKSCiphertext output = ct;
-        multiply_plain_inplace(output, scalar);
+        CKKSCiphertext output;
+        multiply_plain(ct, scalar, output);
         return output;
     }
 
-    void CKKSEvaluator::multiply_plain_inplace(CKKSCiphertext &ct, double scalar) {
+    void CKKSEvaluator::multiply_plain(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Multiply ciphertext by scalar " << scalar;
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must have nominal scale");
         }
-        multiply_plain_inplace_internal(ct, scalar);
-        ct.needs_rescale_ = true;
-        ct.scale_ *= ct.scale_;
-        print_stats(ct);
+        if (&ct == &dest) {
+            multiply_plain_inplace_internal(dest, scalar);
+        } else {
+            multiply_plain_internal(ct, scalar, dest);
+        }
+        dest.needs_rescale_ = true;
+        dest.scale_ *= dest.scale_;
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::multiply_plain_inplace(CKKSCiphertext &ct, double scalar) {
+        multiply_plain(ct, scalar, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::multiply_plain(const CKKSCiphertext &ct, const vector<double> &plain) {
-        CKKSCiphertext output = ct;
-        multiply_plain_inplace(output, plain);
+        CKKSCiphertext output;
+        multiply_plain(ct, plain, output);
         return output;
     }
 
-    void CKKSEvaluator::multiply_plain_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+    void CKKSEvaluator::multiply_plain(const CKKSCiphertext &ct, const vector<double> &plain, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Multiply by plaintext";
         if (ct.num_slots() != plain.size()) {
             LOG_AND_THROW_STREAM("Public argument to multiply_plain must have exactly as many "
@@ -256,19 +372,27 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must have nominal scale");
         }
-        multiply_plain_inplace_internal(ct, plain);
-        ct.needs_rescale_ = true;
-        ct.scale_ *= ct.scale_;
-        print_stats(ct);
+        if (&ct == &dest) {
+            multiply_plain_inplace_internal(dest, plain);
+        } else {
+            multiply_plain_internal(ct, plain, dest);
+        }
+        dest.needs_rescale_ = true;
+        dest.scale_ *= dest.scale_;
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::multiply_plain_inplace(CKKSCiphertext &ct, const vector<double> &plain) {
+        multiply_plain(ct, plain, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::square(const CKKSCiphertext &ct) {
-        CKKSCiphertext output = ct;
-        square_inplace(output);
+        CKKSCiphertext output;
+        square(ct, output);
         return output;
     }
 
-    void CKKSEvaluator::square_inplace(CKKSCiphertext &ct) {
+    void CKKSEvaluator::square(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Square ciphertext";
         if (ct.needs_relin()) {
             LOG_AND_THROW_STREAM("Input to square must be a linear ciphertext");
@@ -276,11 +400,19 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Input to square must have nominal scale");
         }
-        square_inplace_internal(ct);
-        ct.needs_rescale_ = true;
-        ct.needs_relin_ = true;
-        ct.scale_ *= ct.scale_;
-        print_stats(ct);
+        if (&ct == &dest) {
+            square_inplace_internal(dest);
+        } else {
+            square_internal(ct, dest);
+        }
+        dest.needs_rescale_ = true;
+        dest.needs_relin_ = true;
+        dest.scale_ *= dest.scale_;
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::square_inplace(CKKSCiphertext &ct) {
+        square(ct, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::reduce_level_to(const CKKSCiphertext &ct, const CKKSCiphertext &target) {
@@ -300,12 +432,12 @@ namespace hit {
     }
 
     CKKSCiphertext CKKSEvaluator::reduce_level_to(const CKKSCiphertext &ct, int level) {
-        CKKSCiphertext output = ct;
-        reduce_level_to_inplace(output, level);
+        CKKSCiphertext output;
+        reduce_level_to(ct, level, output);
         return output;
     }
 
-    void CKKSEvaluator::reduce_level_to_inplace(CKKSCiphertext &ct, int level) {
+    void CKKSEvaluator::reduce_level_to(const CKKSCiphertext &ct, int level, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Decreasing HE level to " << level;
         if (ct.he_level() < level) {
             LOG_AND_THROW_STREAM("Input to reduce_level_to is already below the target level: " << ct.he_level() << "<"
@@ -317,36 +449,60 @@ namespace hit {
         if (ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Input to reduce_level_to must have nominal scale");
         }
-        reduce_level_to_inplace_internal(ct, level);
+        if (&ct == &dest) {
+            reduce_level_to_inplace_internal(dest, level);
+        } else {
+            reduce_level_to_internal(ct, level, dest);
+        }
         // updates he_level and scale
-        reduce_metadata_to_level(ct, level);
-        print_stats(ct);
+        reduce_metadata_to_level(dest, level);
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::reduce_level_to_inplace(CKKSCiphertext &ct, int level) {
+        reduce_level_to(ct, level, ct);
     }
 
     CKKSCiphertext CKKSEvaluator::rescale_to_next(const CKKSCiphertext &ct) {
-        CKKSCiphertext output = ct;
-        rescale_to_next_inplace(output);
+        CKKSCiphertext output;
+        rescale_to_next(ct, output);
         return output;
     }
 
-    void CKKSEvaluator::rescale_to_next_inplace(CKKSCiphertext &ct) {
+    void CKKSEvaluator::rescale_to_next(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Rescaling ciphertext";
         if (!ct.needs_rescale()) {
             LOG_AND_THROW_STREAM("Input to rescale_to_next_inplace must have squared scale");
         }
-        rescale_to_next_inplace_internal(ct);
-        rescale_metata_to_next(ct);
-        print_stats(ct);
+        if (&ct == &dest) {
+            rescale_to_next_inplace_internal(dest);
+        } else {
+            rescale_to_next_internal(ct, dest);
+        }
+        rescale_metata_to_next(dest);
+        print_stats(dest);
     }
 
-    void CKKSEvaluator::relinearize_inplace(CKKSCiphertext &ct) {
+    void CKKSEvaluator::rescale_to_next_inplace(CKKSCiphertext &ct) {
+        rescale_to_next(ct, ct);
+    }
+
+    void CKKSEvaluator::relinearize(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
         VLOG(VLOG_EVAL) << "Relinearizing ciphertext";
         if (!ct.needs_relin()) {
             LOG_AND_THROW_STREAM("Input to relinearize_inplace must be a linear ciphertext");
         }
-        relinearize_inplace_internal(ct);
-        ct.needs_relin_ = false;
-        print_stats(ct);
+        if (&ct == &dest) {
+            relinearize_inplace_internal(dest);
+        } else {
+            relinearize_internal(ct, dest);
+        }
+        dest.needs_relin_ = false;
+        print_stats(dest);
+    }
+
+    void CKKSEvaluator::relinearize_inplace(CKKSCiphertext &ct) {
+        relinearize(ct, ct);
     }
 
     void CKKSEvaluator::reduce_metadata_to_level(CKKSCiphertext &ct, int level) {
@@ -357,6 +513,20 @@ namespace hit {
         }
     }
 
+    void CKKSEvaluator::copy_metadata(const CKKSCiphertext &src, CKKSCiphertext &dest) {
+        if (&src == &dest) {
+            return;
+        }
+        dest.raw_pt = src.raw_pt;
+        dest.pt_rotation_ = src.pt_rotation_;
+        dest.scale_ = src.scale_;
+        dest.initialized = src.initialized;
+        dest.he_level_ = src.he_level_;
+        dest.num_slots_ = src.num_slots_;
+        dest.needs_relin_ = src.needs_relin_;
+        dest.needs_rescale_ = src.needs_rescale_;
+    }
+
     void CKKSEvaluator::rescale_metata_to_next(CKKSCiphertext &ct) {
         uint64_t prime = get_last_prime_internal(ct);
         ct.he_level_--;
@@ -364,6 +534,11 @@ namespace hit {
         ct.needs_rescale_ = false;
     }
 
+    // default implementation for evaluators which don't use SEAL
+    bool CKKSEvaluator::has_rotation_key(int) const {
+        return false;
+    }
+
     // default implementation for evaluators which don't use SEAL
     uint64_t CKKSEvaluator::get_last_prime_internal(const CKKSCiphertext &ct) const {
         if (ct.needs_rescale()) {
@@ -389,4 +564,89 @@ namespace hit {
     void CKKSEvaluator::rescale_to_next_inplace_internal(CKKSCiphertext &){};
     void CKKSEvaluator::relinearize_inplace_internal(CKKSCiphertext &){};
     void CKKSEvaluator::print_stats(const CKKSCiphertext &) const {};
+
+    // default out-of-place implementations copy the input, then operate in place
+    void CKKSEvaluator::rotate_right_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) {
+        dest = ct;
+        rotate_right_inplace_internal(dest, steps);
+    }
+
+    void CKKSEvaluator::rotate_left_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) {
+        dest = ct;
+        rotate_left_inplace_internal(dest, steps);
+    }
+
+    void CKKSEvaluator::negate_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        dest = ct;
+        negate_inplace_internal(dest);
+    }
+
+    void CKKSEvaluator::add_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
+        dest = ct1;
+        add_inplace_internal(dest, ct2);
+    }
+
+    void CKKSEvaluator::add_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
+        dest = ct;
+        add_plain_inplace_internal(dest, scalar);
+    }
+
+    void CKKSEvaluator::add_plain_internal(const CKKSCiphertext &ct, const vector<double> &plain,
+                                           CKKSCiphertext &dest) {
+        dest = ct;
+        add_plain_inplace_internal(dest, plain);
+    }
+
+    void CKKSEvaluator::sub_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
+        dest = ct1;
+        sub_inplace_internal(dest, ct2);
+    }
+
+    void CKKSEvaluator::sub_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
+        dest = ct;
+        sub_plain_inplace_internal(dest, scalar);
+    }
+
+    void CKKSEvaluator::sub_plain_internal(const CKKSCiphertext &ct, const vector<double> &plain,
+                                           CKKSCiphertext &dest) {
+        dest = ct;
+        sub_plain_inplace_internal(dest, plain);
+    }
+
+    void CKKSEvaluator::multiply_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2,
+                                          CKKSCiphertext &dest) {
+        dest = ct1;
+        multiply_inplace_internal(dest, ct2);
+    }
+
+    void CKKSEvaluator::multiply_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
+        dest = ct;
+        multiply_plain_inplace_internal(dest, scalar);
+    }
+
+    void CKKSEvaluator::multiply_plain_internal(const CKKSCiphertext &ct, const vector<double> &plain,
+                                                CKKSCiphertext &dest) {
+        dest = ct;
+        multiply_plain_inplace_internal(dest, plain);
+    }
+
+    void CKKSEvaluator::square_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        dest = ct;
+        square_inplace_internal(dest);
+    }
+
+    void CKKSEvaluator::reduce_level_to_internal(const CKKSCiphertext &ct, int level, CKKSCiphertext &dest) {
+        dest = ct;
+        reduce_level_to_inplace_internal(dest, level);
+    }
+
+    void CKKSEvaluator::rescale_to_next_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        dest = ct;
+        rescale_to_next_inplace_internal(dest);
+    }
+
+    void CKKSEvaluator::relinearize_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        dest = ct;
+        relinearize_inplace_internal(dest);
+    }
 }  // namespace hit
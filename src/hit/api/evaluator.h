@@ -51,6 +51,14 @@ namespace hit {
         virtual CKKSCiphertext encrypt(const std::vector<double> &coeffs) = 0;
         virtual CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) = 0;
 
+        // Encrypt a placeholder: a ciphertext with the same metadata as the output of `encrypt`, but no
+        // contents. Evaluators which only track metadata (DepthFinder and OpCount) never read the coefficients
+        // passed to `encrypt`, so a dry run can use placeholders without allocating any plaintext vectors.
+        // The BoundsEstimator gives placeholders the input range it was constructed with.
+        // Other evaluators throw an exception.
+        virtual CKKSCiphertext encrypt_placeholder();
+        virtual CKKSCiphertext encrypt_placeholder(int level);
+
         // Decrypt a ciphertext to (approximately) recover the plaintext coefficients.
         // This function will log a message if you try to decrypt a ciphertext which
         // is not at level 0. Sometimes it is expected for a ciphertext to be at a higher
@@ -61,10 +69,23 @@ namespace hit {
         // Get the number of plaintext slots expected by this evaluator
         virtual int num_slots() const = 0;
 
+        // Returns true if this evaluator holds a dedicated key for rotating by `steps`, where positive
+        // `steps` rotate left and negative `steps` rotate right. Rotations by other amounts may still be
+        // supported by composing several key switches. Evaluators which don't use keys (e.g., OpCount) model
+        // the keys HomomorphicEval would generate for the `galois_steps` passed to their constructor, so that
+        // a dry run performs the same rotations as the homomorphic computation.
+        virtual bool has_rotation_key(int steps) const;
+
         /******************
          * Evaluation API *
          ******************/
 
+        /* Most operations come in three forms: one which returns a new ciphertext, one which
+         * modifies its (first) input in place, and one which writes its result to `dest`.
+         * Reusing the same `dest` for many results avoids allocating a new ciphertext for each one.
+         * `dest` may be the same object as any of the inputs.
+         */
+
         /* Rotate a plaintext vector cyclically to the right by any positive number of steps:
          *     rotate_right(<1,2,3,4>, 1) = <4,1,2,3>
          * Input: A linear ciphertext with nominal or squared scale
@@ -73,6 +94,14 @@ namespace hit {
          */
         CKKSCiphertext rotate_right(const CKKSCiphertext &ct, int steps);
 
+        /* Rotate a plaintext vector cyclically to the right by any positive number of steps:
+         *     rotate_right(<1,2,3,4>, 1) = <4,1,2,3>
+         * Input: A linear ciphertext with nominal or squared scale
+         *        and the number of steps to rotate.
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void rotate_right(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest);
+
         /* Rotate a plaintext vector cyclically to the right by any positive number of steps:
          *     rotate_right(<1,2,3,4>, 1) = <4,1,2,3>
          * Input: A linear ciphertext with nominal or squared scale
@@ -89,6 +118,14 @@ namespace hit {
          */
         CKKSCiphertext rotate_left(const CKKSCiphertext &ct, int steps);
 
+        /* Rotate a plaintext vector cyclically to the left by any positive number of steps:
+         *     rotate_left(<1,2,3,4>, 1) = <2,3,4,1>
+         * Input: A linear ciphertext with nominal or squared scale
+         *        and the number of steps to rotate.
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void rotate_left(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest);
+
         /* Rotate a plaintext vector cyclically to the left by any positive number of steps:
          *     rotate_left(<1,2,3,4>, 1) = <2,3,4,1>
          * Input: A linear ciphertext with nominal or squared scale
@@ -103,6 +140,12 @@ namespace hit {
          */
         CKKSCiphertext add_plain(const CKKSCiphertext &ct, double scalar);
 
+        /* Add a scalar to each plaintext slot.
+         * Input: An arbitrary ciphertext (any degree and any scale) and a public scalar
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void add_plain(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest);
+
         /* Add a scalar to each plaintext slot.
          * Input: An arbitrary ciphertext (any degree and any scale) and a public scalar
          * Output (Inplace): A ciphertext with the same properties as the input.
@@ -115,6 +158,12 @@ namespace hit {
          */
         CKKSCiphertext add_plain(const CKKSCiphertext &ct, const std::vector<double> &plain);
 
+        /* Add a public plaintext component-wise to the encrypted plaintext.
+         * Input: An arbitrary ciphertext (any degree and any scale) and a public plaintext
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void add_plain(const CKKSCiphertext &ct, const std::vector<double> &plain, CKKSCiphertext &dest);
+
         /* Add a public plaintext component-wise to the encrypted plaintext.
          * Input: An arbitrary ciphertext (any degree and any scale) and a public plaintext
          * Output (Inplace): A ciphertext with the same properties as the input.
@@ -129,6 +178,14 @@ namespace hit {
          */
         CKKSCiphertext add(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
 
+        /* Add two encrypted plaintexts, component-wise.
+         * Input: Two ciphertexts at the same level whose scales match (can be nominal or squared).
+         *        Note that ciphertext degrees do not need to match.
+         * Output (dest): A ciphertext whose level and scale is the same as the inputs, and whose
+         *                degree is the maximum of the two input degrees.
+         */
+        void add(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest);
+
         /* Add two encrypted plaintexts, component-wise.
          * Input: Two ciphertexts at the same level whose scales match (can be nominal or squared).
          *        Note that ciphertext degrees do not need to match.
@@ -152,6 +209,12 @@ namespace hit {
          */
         CKKSCiphertext negate(const CKKSCiphertext &ct);
 
+        /* Negate each plaintext coefficient.
+         * Input: An arbitrary ciphertext (any degree and any scale)
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void negate(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+
         /* Negate each plaintext coefficient.
          * Input: An arbitrary ciphertext (any degree and any scale)
          * Output (Inplace): A ciphertext with the same properties as the input.
@@ -164,6 +227,12 @@ namespace hit {
          */
         CKKSCiphertext sub_plain(const CKKSCiphertext &ct, double scalar);
 
+        /* Subtract a scalar from each plaintext slot.
+         * Input: An arbitrary ciphertext (any degree and any scale) and a public scalar
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void sub_plain(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest);
+
         /* Subtract a scalar from each plaintext slot.
          * Input: An arbitrary ciphertext (any degree and any scale) and a public scalar
          * Output (Inplace): A ciphertext with the same properties as the input.
@@ -176,6 +245,12 @@ namespace hit {
          */
         CKKSCiphertext sub_plain(const CKKSCiphertext &ct, const std::vector<double> &plain);
 
+        /* Subtract a public plaintext component-wise from the encrypted plaintext.
+         * Input: An arbitrary ciphertext (any degree and any scale) and a public plaintext
+         * Output (dest): A ciphertext with the same properties as the input.
+         */
+        void sub_plain(const CKKSCiphertext &ct, const std::vector<double> &plain, CKKSCiphertext &dest);
+
         /* Subtract a public plaintext component-wise from the encrypted plaintext.
          * Input: An arbitrary ciphertext (any degree and any scale) and a public plaintext
          * Output (Inplace): A ciphertext with the same properties as the input.
@@ -195,6 +270,19 @@ namespace hit {
          */
         CKKSCiphertext sub(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
 
+        /* Subtract one encrypted plaintext from another, component-wise.
+         * Input: Two ciphertexts at the same level whose scales match (can be nominal or squared).
+         *        Note that ciphertext degrees do not need to match.
+         * Output (dest): A ciphertext whose level and scale is the same as the inputs, and whose
+         *                degree is the maximum of the two input degrees (see NOTE).
+         * NOTE: This operation throws an exception if the result is a constant
+         *       ciphertext, since this results in a "transparent ciphertext" which does not
+         *       require the secret key to decrypt. One way this can happen is if one ciphertext
+         *       is a scalar shift of the other. In this case, the ciphertexts only differ in
+         *       their constant coefficient, so any higher-order terms are cancelled out.
+         */
+        void sub(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest);
+
         /* Subtract one encrypted plaintext from another, component-wise.
          * Input: Two ciphertexts at the same level whose scales match (can be nominal or squared).
          *        Note that ciphertext degrees do not need to match.
@@ -217,6 +305,15 @@ namespace hit {
          */
         CKKSCiphertext multiply_plain(const CKKSCiphertext &ct, double scalar);
 
+        /* Multiply each plaintext slot by a scalar.
+         * Input: A linear or quadratic ciphertext with nominal scale.
+         * Output (dest): A ciphertext with the same ciphertext degree as the input, but with squared scale.
+         * NOTE: The scalar zero produces a transparent ciphertext since all ciphertext polynomial coefficients
+         *       are zero. Rather than throw an exception, this implementation returns a fresh encryption of a
+         *       all-zero plaintext.
+         */
+        void multiply_plain(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest);
+
         /* Multiply each plaintext slot by a scalar.
          * Input: A linear or quadratic ciphertext with nominal scale.
          * Output (Inplace): A ciphertext with the same ciphertext degree as the input, but with squared scale.
@@ -233,6 +330,13 @@ namespace hit {
          */
         CKKSCiphertext multiply_plain(const CKKSCiphertext &ct, const std::vector<double> &plain);
 
+        /* Multiply the encrypted plaintext and the public plaintext component-wise.
+         * Input: A linear or quadratic ciphertext with nominal scale.
+         * Output (dest): A ciphertext with the same ciphertext degree as the input,
+         *                but with squared scale.
+         */
+        void multiply_plain(const CKKSCiphertext &ct, const std::vector<double> &plain, CKKSCiphertext &dest);
+
         /* Multiply the encrypted plaintext and the public plaintext component-wise.
          * Input: A linear or quadratic ciphertext with nominal scale.
          * Output (Inplace): A ciphertext with the same ciphertext degree as the input,
@@ -247,6 +351,13 @@ namespace hit {
          */
         CKKSCiphertext multiply(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2);
 
+        /* Multiply two encrypted plaintexts, component-wise.
+         * Input: Two linear ciphertexts at the same level, with nominal scales.
+         * Output (dest): A quadratic ciphertext whose level is the same as the inputs,
+         *                and whose scale is squared.
+         */
+        void multiply(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest);
+
         /* Multiply two encrypted plaintexts, component-wise.
          * Input: Two linear ciphertexts at the same level, with nominal scales.
          * Output (Inplace): A quadratic ciphertext whose level is the same as the inputs,
@@ -261,6 +372,13 @@ namespace hit {
          */
         CKKSCiphertext square(const CKKSCiphertext &ct);
 
+        /* Square each plaintext coefficient.
+         * Input: A linear ciphertext with nominal scale.
+         * Output (dest): A quadratic ciphertext whose level is the same as the input,
+         *                and whose scale is squared.
+         */
+        void square(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+
         /* Square each plaintext coefficient.
          * Input: A linear ciphertext with nominal scale.
          * Output (Inplace): A quadratic ciphertext whose level is the same as the input,
@@ -305,6 +423,14 @@ namespace hit {
          */
         CKKSCiphertext reduce_level_to(const CKKSCiphertext &ct, int level);
 
+        /* Reduce the HE level of `ct` to a lower level
+         * Input: A linear ciphertext with nominal scale and level i, and a target level
+         *        0 <= j <= i.
+         * Output (dest): A linear ciphertext with nominal scale and level j, encrypting
+         *                the same plaintext as `ct`.
+         */
+        void reduce_level_to(const CKKSCiphertext &ct, int level, CKKSCiphertext &dest);
+
         /* Reduce the HE level of `ct` to a lower level
          * Input: A linear ciphertext with nominal scale and level i, and a target level
          *        0 <= j <= i.
@@ -321,6 +447,14 @@ namespace hit {
          */
         CKKSCiphertext rescale_to_next(const CKKSCiphertext &ct);
 
+        /* Remove a prime from the modulus (i.e. go down one level) and scale
+         * down the plaintext by that prime.
+         * Input: A linear or quadratic ciphertext with squared scale and level i>0.
+         * Output (dest): A ciphertext with the same degree as the input
+         *                with nominal scale and level i-1.
+         */
+        void rescale_to_next(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+
         /* Remove a prime from the modulus (i.e. go down one level) and scale
          * down the plaintext by that prime.
          * Input: A linear or quadratic ciphertext with squared scale and level i>0.
@@ -347,6 +481,12 @@ namespace hit {
          */
         void relinearize_inplace(CKKSCiphertext &ct);
 
+        /* Relinearize the ciphertext.
+         * Input: A quadratic ciphertext with nominal or squared scale.
+         * Output (dest): A linear ciphertext with the same scale and level as the input.
+         */
+        void relinearize(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+
        protected:
         virtual void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps);
         virtual void rotate_left_inplace_internal(CKKSCiphertext &ct, int steps);
@@ -364,10 +504,38 @@ namespace hit {
         virtual void reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level);
         virtual void rescale_to_next_inplace_internal(CKKSCiphertext &ct);
         virtual void relinearize_inplace_internal(CKKSCiphertext &ct);
+
+        /* Out-of-place variants of the functions above, which write to `dest`. `dest` is never one of the
+         * inputs; the public API calls the inplace variant instead when it is. By default,
+         * these copy the first input to `dest` and call the inplace variant; evaluators which can compute
+         * the result directly into `dest` should override them.
+         */
+        virtual void rotate_right_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest);
+        virtual void rotate_left_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest);
+        virtual void negate_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+        virtual void add_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest);
+        virtual void add_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest);
+        virtual void add_plain_internal(const CKKSCiphertext &ct, const std::vector<double> &plain,
+                                        CKKSCiphertext &dest);
+        virtual void sub_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest);
+        virtual void sub_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest);
+        virtual void sub_plain_internal(const CKKSCiphertext &ct, const std::vector<double> &plain,
+                                        CKKSCiphertext &dest);
+        virtual void multiply_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest);
+        virtual void multiply_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest);
+        virtual void multiply_plain_internal(const CKKSCiphertext &ct, const std::vector<double> &plain,
+                                             CKKSCiphertext &dest);
+        virtual void square_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+        virtual void reduce_level_to_internal(const CKKSCiphertext &ct, int level, CKKSCiphertext &dest);
+        virtual void rescale_to_next_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+        virtual void relinearize_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest);
+
         virtual void print_stats(const CKKSCiphertext &ct) const;
         virtual uint64_t get_last_prime_internal(const CKKSCiphertext &ct) const;
 
         void reduce_metadata_to_level(CKKSCiphertext &ct, int level);
+        // Copy everything except the SEAL ciphertext from `src` to `dest`
+        static void copy_metadata(const CKKSCiphertext &src, CKKSCiphertext &dest);
         void rescale_metata_to_next(CKKSCiphertext &ct);
 
         CKKSEvaluator() = default;
@@ -0,0 +1,279 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "boundsestimator.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <iomanip>
+
+#include "../../common.h"
+#include "../../sealutils.h"
+
+using namespace std;
+using namespace seal;
+
+namespace hit {
+
+    // the nominal scale, as in the ScaleEstimator; only the ratio of a ciphertext's scale to it matters
+    const int bounds_estimator_log_scale = 30;
+
+    BoundsEstimator::BoundsEstimator(int num_slots, int multiplicative_depth, double input_bound,
+                                     const vector<int> &galois_steps)
+        : log_scale_(bounds_estimator_log_scale),
+          num_slots_(num_slots),
+          galois_steps_(galois_steps),
+          input_bound_(input_bound) {
+        if (input_bound < 0) {
+            LOG_AND_THROW_STREAM("Invalid parameters when creating BoundsEstimator instance: "
+                                 << "input_bound must be non-negative. Got " << input_bound);
+        }
+
+        context = make_estimator_context(num_slots, multiplicative_depth, log_scale_, "BoundsEstimator");
+        estimated_max_log_scale_ = initial_max_log_scale(context);
+    }
+
+    CKKSCiphertext BoundsEstimator::encrypt(const vector<double> &coeffs) {
+        return encrypt(coeffs, -1);
+    }
+
+    CKKSCiphertext BoundsEstimator::encrypt(const vector<double> &coeffs, int level) {
+        if (coeffs.size() != num_slots_) {
+            // bad things can happen if you don't plan for your input to be smaller than the ciphertext
+            // This forces the caller to ensure that the input has the correct size or is at least appropriately padded
+            LOG_AND_THROW_STREAM("You can only encrypt vectors which have exactly as many "
+                                 << " coefficients as the number of plaintext slots: Expected " << num_slots_
+                                 << " coefficients, but " << coeffs.size() << " were provided");
+        }
+        auto minmax = minmax_element(coeffs.begin(), coeffs.end());
+        return encrypt_interval(*minmax.first, *minmax.second, level);
+    }
+
+    CKKSCiphertext BoundsEstimator::encrypt_placeholder() {
+        return encrypt_placeholder(-1);
+    }
+
+    CKKSCiphertext BoundsEstimator::encrypt_placeholder(int level) {
+        return encrypt_interval(-input_bound_, input_bound_, level);
+    }
+
+    CKKSCiphertext BoundsEstimator::encrypt_interval(double lower_bound, double upper_bound, int level) {
+        if (lower_bound > upper_bound) {
+            LOG_AND_THROW_STREAM("Invalid interval for encryption: lower bound " << lower_bound
+                                                                                 << " exceeds upper bound "
+                                                                                 << upper_bound);
+        }
+
+        int top_he_level = context->first_context_data()->chain_index();
+        if (level == -1) {
+            level = top_he_level;
+        }
+
+        auto context_data = context->first_context_data();
+        double scale = pow(2, log_scale_);
+        while (context_data->chain_index() > level) {
+            // order of operations is very important: floating point arithmetic is not associative
+            scale = (scale * scale) / static_cast<double>(context_data->parms().coeff_modulus().back().value());
+            context_data = context_data->next_context_data();
+        }
+
+        CKKSCiphertext destination;
+        destination.he_level_ = level;
+        destination.scale_ = scale;
+        destination.lower_bound_ = lower_bound;
+        destination.upper_bound_ = upper_bound;
+        destination.num_slots_ = num_slots_;
+        destination.initialized = true;
+
+        // account for a freshly-encrypted ciphertext; see ScaleEstimator::update_plaintext_max_val
+        if (top_he_level == 0) {
+            double max_val = max(abs(lower_bound), abs(upper_bound));
+            scoped_lock lock(mutex_);
+            estimated_max_log_scale_ = min(estimated_max_log_scale_, PLAINTEXT_LOG_MAX - log2(max_val));
+        }
+
+        return destination;
+    }
+
+    pair<double, double> BoundsEstimator::bounds(const CKKSCiphertext &ct) {
+        return {ct.lower_bound_, ct.upper_bound_};
+    }
+
+    uint64_t BoundsEstimator::get_last_prime_internal(const CKKSCiphertext &ct) const {
+        return get_last_prime(context, ct.he_level());
+    }
+
+    int BoundsEstimator::num_slots() const {
+        return num_slots_;
+    }
+
+    bool BoundsEstimator::has_rotation_key(int steps) const {
+        return has_galois_key(galois_steps_, steps, num_slots_);
+    }
+
+    // print some debug info
+    void BoundsEstimator::print_stats(const CKKSCiphertext &ct) const {
+        double max_val = max(abs(ct.lower_bound_), abs(ct.upper_bound_));
+        VLOG(VLOG_EVAL) << "    + Level: " << ct.he_level();
+        VLOG(VLOG_EVAL) << "    + Plaintext interval: [" << ct.lower_bound_ << ", " << ct.upper_bound_ << "]";
+        VLOG(VLOG_EVAL) << "    + Plaintext logmax: " << log2(max_val)
+                        << " bits (scaled: " << log2(ct.scale()) + log2(max_val) << " bits)";
+        VLOG(VLOG_EVAL) << "    + Theoretical max log scale: " << setprecision(4) << get_estimated_max_log_scale()
+                        << " bits";
+    }
+
+    // This is the constraint of ScaleEstimator::update_max_log_scale, with the largest magnitude
+    // in the interval in place of the largest magnitude in the plaintext.
+    void BoundsEstimator::update_max_log_scale(const CKKSCiphertext &ct) {
+        double log_max_val = log2(max(abs(ct.lower_bound_), abs(ct.upper_bound_)));
+        double estimated_scale = max_log_scale_bound(scale_exponent(ct, log_scale_), ct.he_level(), log_max_val);
+        scoped_lock lock(mutex_);
+        estimated_max_log_scale_ = min(estimated_max_log_scale_, estimated_scale);
+    }
+
+    void BoundsEstimator::multiply_bounds(CKKSCiphertext &ct, double lower_bound, double upper_bound) {
+        double products[] = {ct.lower_bound_ * lower_bound, ct.lower_bound_ * upper_bound,
+                             ct.upper_bound_ * lower_bound, ct.upper_bound_ * upper_bound};
+        ct.lower_bound_ = *min_element(begin(products), end(products));
+        ct.upper_bound_ = *max_element(begin(products), end(products));
+    }
+
+    void BoundsEstimator::rotate_right_inplace_internal(CKKSCiphertext &, int) {
+        // rotations permute the slots, so the interval is unchanged
+    }
+
+    void BoundsEstimator::rotate_left_inplace_internal(CKKSCiphertext &, int) {
+    }
+
+    void BoundsEstimator::negate_inplace_internal(CKKSCiphertext &ct) {
+        double lower_bound = ct.lower_bound_;
+        ct.lower_bound_ = -ct.upper_bound_;
+        ct.upper_bound_ = -lower_bound;
+    }
+
+    void BoundsEstimator::add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        // ct1 and ct2 may be the same object
+        double lower_bound = ct1.lower_bound_ + ct2.lower_bound_;
+        double upper_bound = ct1.upper_bound_ + ct2.upper_bound_;
+        ct1.lower_bound_ = lower_bound;
+        ct1.upper_bound_ = upper_bound;
+        update_max_log_scale(ct1);
+    }
+
+    void BoundsEstimator::add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        ct.lower_bound_ += scalar;
+        ct.upper_bound_ += scalar;
+        update_max_log_scale(ct);
+    }
+
+    void BoundsEstimator::add_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        auto minmax = minmax_element(plain.begin(), plain.end());
+        ct.lower_bound_ += *minmax.first;
+        ct.upper_bound_ += *minmax.second;
+        update_max_log_scale(ct);
+    }
+
+    void BoundsEstimator::sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        // ct1 and ct2 may be the same object
+        double lower_bound = ct1.lower_bound_ - ct2.upper_bound_;
+        double upper_bound = ct1.upper_bound_ - ct2.lower_bound_;
+        ct1.lower_bound_ = lower_bound;
+        ct1.upper_bound_ = upper_bound;
+        update_max_log_scale(ct1);
+    }
+
+    void BoundsEstimator::sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        ct.lower_bound_ -= scalar;
+        ct.upper_bound_ -= scalar;
+        update_max_log_scale(ct);
+    }
+
+    void BoundsEstimator::sub_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        auto minmax = minmax_element(plain.begin(), plain.end());
+        ct.lower_bound_ -= *minmax.second;
+        ct.upper_bound_ -= *minmax.first;
+        update_max_log_scale(ct);
+    }
+
+    void BoundsEstimator::temp_square_scale(CKKSCiphertext &ct) {
+        double input_scale = ct.scale();
+        ct.scale_ *= ct.scale();
+        update_max_log_scale(ct);
+        ct.scale_ = input_scale;
+    }
+
+    void BoundsEstimator::multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
+        // if ct1 and ct2 are the same object, this is a square
+        if (&ct1 == &ct2) {
+            square_inplace_internal(ct1);
+            return;
+        }
+        multiply_bounds(ct1, ct2.lower_bound_, ct2.upper_bound_);
+        temp_square_scale(ct1);
+    }
+
+    void BoundsEstimator::multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
+        multiply_bounds(ct, scalar, scalar);
+        temp_square_scale(ct);
+    }
+
+    void BoundsEstimator::multiply_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
+        auto minmax = minmax_element(plain.begin(), plain.end());
+        multiply_bounds(ct, *minmax.first, *minmax.second);
+        temp_square_scale(ct);
+    }
+
+    void BoundsEstimator::square_inplace_internal(CKKSCiphertext &ct) {
+        double lower_square = ct.lower_bound_ * ct.lower_bound_;
+        double upper_square = ct.upper_bound_ * ct.upper_bound_;
+        if (ct.lower_bound_ >= 0) {
+            ct.lower_bound_ = lower_square;
+            ct.upper_bound_ = upper_square;
+        } else if (ct.upper_bound_ <= 0) {
+            ct.lower_bound_ = upper_square;
+            ct.upper_bound_ = lower_square;
+        } else {
+            // the interval contains 0
+            ct.lower_bound_ = 0;
+            ct.upper_bound_ = max(lower_square, upper_square);
+        }
+        temp_square_scale(ct);
+    }
+
+    void BoundsEstimator::reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) {
+        if (level < 0) {
+            LOG_AND_THROW_STREAM("Target level for level reduction must be non-negative, got " << level);
+        }
+
+        int input_level = ct.he_level();
+        double input_scale = ct.scale();
+
+        // update the metadata so that we can update the max_log_scale
+        reduce_metadata_to_level(ct, level);
+        update_max_log_scale(ct);
+
+        // internal functions should not update the ciphertext metadata
+        ct.he_level_ = input_level;
+        ct.scale_ = input_scale;
+    }
+
+    void BoundsEstimator::rescale_to_next_inplace_internal(CKKSCiphertext &ct) {
+        int input_level = ct.he_level();
+        double input_scale = ct.scale();
+
+        // update the metadata so that we can update the max_log_scale
+        rescale_metata_to_next(ct);
+        update_max_log_scale(ct);
+
+        // internal functions should not update the ciphertext metadata
+        ct.he_level_ = input_level;
+        ct.scale_ = input_scale;
+    }
+
+    double BoundsEstimator::get_estimated_max_log_scale() const {
+        // see ScaleEstimator::get_estimated_max_log_scale
+        shared_lock lock(mutex_);
+        return min(estimated_max_log_scale_, modulus_max_log_scale(context, num_slots_));
+    }
+}  // namespace hit
@@ -0,0 +1,116 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <utility>
+
+#include "../ciphertext.h"
+#include "../evaluator.h"
+#include "seal/context.h"
+#include "seal/seal.h"
+
+namespace hit {
+
+    /* This evaluator estimates the maximum CKKS scale to use for a computation, like the ScaleEstimator,
+     * but without evaluating the computation on sample inputs. Instead, each ciphertext carries an
+     * interval which contains the value in every slot, and each operation computes the interval of its
+     * output from the intervals of its inputs with interval arithmetic. This takes constant time per
+     * operation (plus a pass over the plaintext argument of vector-plaintext operations), and the result
+     * is a worst-case bound which holds for *every* input in the declared ranges, rather than only for the
+     * inputs which were seen. Since interval arithmetic ignores correlations between ciphertexts (e.g.,
+     * x-x is bounded by [lo-hi, hi-lo], not [0, 0]), the estimate may be smaller than the ScaleEstimator's.
+     */
+    class BoundsEstimator : public CKKSEvaluator {
+       public:
+        /* `num_slots` and `multiplicative_depth` are as for the ScaleEstimator.
+         * Inputs encrypted with `encrypt_placeholder` hold values in [-input_bound, input_bound];
+         * use `encrypt_interval` to declare a different range for a specific input.
+         * `galois_steps` are the rotations which the homomorphic computation has keys for, as for HomomorphicEval.
+         */
+        BoundsEstimator(int num_slots, int multiplicative_depth, double input_bound = 1,
+                        const std::vector<int> &galois_steps = std::vector<int>());
+
+        /* For documentation on the API, see ../evaluator.h */
+        ~BoundsEstimator() override = default;
+
+        BoundsEstimator(const BoundsEstimator &) = delete;
+        BoundsEstimator &operator=(const BoundsEstimator &) = delete;
+        BoundsEstimator(BoundsEstimator &&) = delete;
+        BoundsEstimator &operator=(BoundsEstimator &&) = delete;
+
+        // return the base-2 log of the maximum scale that can be used for this computation on any inputs in
+        // the declared ranges; see ScaleEstimator::get_estimated_max_log_scale.
+        double get_estimated_max_log_scale() const;
+
+        // The range of a ciphertext encrypted with `encrypt` is the smallest interval containing `coeffs`.
+        CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
+        CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
+
+        CKKSCiphertext encrypt_placeholder() override;
+        CKKSCiphertext encrypt_placeholder(int level) override;
+
+        // Encrypt a placeholder for an input whose values are in [lower_bound, upper_bound].
+        CKKSCiphertext encrypt_interval(double lower_bound, double upper_bound, int level = -1);
+
+        // The interval which contains the value in every slot of `ct`
+        static std::pair<double, double> bounds(const CKKSCiphertext &ct);
+
+        std::shared_ptr<seal::SEALContext> context;
+
+        int num_slots() const override;
+
+        bool has_rotation_key(int steps) const override;
+
+       protected:
+        void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
+
+        void rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) override;
+
+        void negate_inplace_internal(CKKSCiphertext &ct) override;
+
+        void add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void add_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void sub_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) override;
+
+        void multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) override;
+
+        void multiply_plain_inplace_internal(CKKSCiphertext &ct, const std::vector<double> &plain) override;
+
+        void square_inplace_internal(CKKSCiphertext &ct) override;
+
+        void reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) override;
+
+        void rescale_to_next_inplace_internal(CKKSCiphertext &ct) override;
+
+       private:
+        const int log_scale_ = 0;
+        const int num_slots_ = 0;
+        // see `has_rotation_key`
+        const std::vector<int> galois_steps_;
+        const double input_bound_ = 0;
+
+        double estimated_max_log_scale_;
+
+        // Set the interval of `ct` to the product of its interval and [lower_bound, upper_bound]
+        static void multiply_bounds(CKKSCiphertext &ct, double lower_bound, double upper_bound);
+
+        // This helper function squares the scale of the input and then updates
+        // the max_log_scale.
+        void temp_square_scale(CKKSCiphertext &ct);
+        void print_stats(const CKKSCiphertext &ct) const override;
+        void update_max_log_scale(const CKKSCiphertext &ct);
+
+        uint64_t get_last_prime_internal(const CKKSCiphertext &ct) const override;
+    };
+}  // namespace hit
@@ -97,7 +97,7 @@ namespace hit {
     CKKSCiphertext DebugEval::encrypt(const vector<double> &coeffs, int level) {
         scale_estimator->update_plaintext_max_val(coeffs);
         CKKSCiphertext destination = homomorphic_eval->encrypt(coeffs, level);
-        destination.raw_pt = coeffs;
+        destination.raw_pt.overwrite() = coeffs;
         return destination;
     }
 
@@ -113,6 +113,10 @@ namespace hit {
         return homomorphic_eval->num_slots();
     }
 
+    bool DebugEval::has_rotation_key(int steps) const {
+        return homomorphic_eval->has_rotation_key(steps);
+    }
+
     uint64_t DebugEval::get_last_prime_internal(const CKKSCiphertext &ct) const {
         return homomorphic_eval->get_last_prime_internal(ct);
     }
@@ -126,12 +130,12 @@ namespace hit {
 
         // decrypt to compute the approximate plaintext
         vector<double> homom_plaintext = decrypt(ct, true);
-        vector<double> exact_plaintext = ct.raw_pt;
+        vector<double> exact_plaintext = ct.plaintext();
 
         norm = relative_error(exact_plaintext, homom_plaintext);
-        if (abs(log2(ct.scale()) - log2(ct.seal_ct.scale())) > 0.1) {
+        if (abs(log2(ct.scale()) - log2(ct.seal_ct.get().scale())) > 0.1) {
             LOG_AND_THROW_STREAM("Internal error: HIT scale does not match SEAL scale: " << log2(ct.scale()) << " != "
-                                                                                         << ct.seal_ct.scale());
+                                                                                         << ct.seal_ct.get().scale());
         }
 
         VLOG(VLOG_EVAL) << setprecision(8) << "    + Approximation norm: " << norm;
@@ -179,7 +183,7 @@ namespace hit {
             LOG(ERROR) << actual_debug_result.str();
 
             Plaintext encoded_plain;
-            homomorphic_eval->encoder->encode(ct.raw_pt, pow(2, log_scale_), encoded_plain);
+            homomorphic_eval->encoder->encode(exact_plaintext, pow(2, log_scale_), encoded_plain);
 
             vector<double> decoded_plain;
             homomorphic_eval->encoder->decode(encoded_plain, decoded_plain);
@@ -54,6 +54,8 @@ namespace hit {
 
         int num_slots() const override;
 
+        bool has_rotation_key(int steps) const override;
+
        protected:
         void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
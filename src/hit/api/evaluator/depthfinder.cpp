@@ -12,11 +12,26 @@ using namespace seal;
 
 namespace hit {
 
+    DepthFinder::DepthFinder(int num_slots, const vector<int> &galois_steps)
+        : num_slots_(num_slots), galois_steps_(galois_steps) {
+        if (!is_pow2(num_slots)) {
+            LOG_AND_THROW_STREAM("Number of plaintext slots must be a power of two; got " << num_slots);
+        }
+    }
+
     CKKSCiphertext DepthFinder::encrypt(const vector<double> &coeffs) {
         return encrypt(coeffs, -1);
     }
 
     CKKSCiphertext DepthFinder::encrypt(const vector<double> &, int level) {
+        return encrypt_placeholder(level);
+    }
+
+    CKKSCiphertext DepthFinder::encrypt_placeholder() {
+        return encrypt_placeholder(-1);
+    }
+
+    CKKSCiphertext DepthFinder::encrypt_placeholder(int level) {
         if (encryption_mode_ == FIRST_ENCRYPT) {
             if (level == -1) {
                 encryption_mode_ = IMPLICIT_LEVEL;
@@ -65,6 +80,10 @@ namespace hit {
         return num_slots_;
     }
 
+    bool DepthFinder::has_rotation_key(int steps) const {
+        return has_galois_key(galois_steps_, steps, num_slots_);
+    }
+
     void DepthFinder::rescale_to_next_inplace_internal(CKKSCiphertext &ct) {
         /* The DepthFinder is always created as a "depth 0" evaluator, meaning that with
          * the current implementation, top_he_level_ is *always* 0.
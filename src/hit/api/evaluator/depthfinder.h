@@ -24,6 +24,11 @@ namespace hit {
        public:
         DepthFinder() = default;
 
+        /* `galois_steps` are the rotations which the homomorphic computation has keys for, as for HomomorphicEval.
+         * These do not affect the depth, but determine the rotations performed by LinearAlgebra.
+         */
+        DepthFinder(int num_slots, const std::vector<int> &galois_steps);
+
         /* For documentation on the API, see ../evaluator.h */
         ~DepthFinder() override = default;
 
@@ -34,6 +39,8 @@ namespace hit {
 
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
+        CKKSCiphertext encrypt_placeholder() override;
+        CKKSCiphertext encrypt_placeholder(int level) override;
 
         /* Return the multiplicative depth of this computation.
          * Must be called after performing the target computation.
@@ -43,6 +50,8 @@ namespace hit {
 
         int num_slots() const override;
 
+        bool has_rotation_key(int steps) const override;
+
        protected:
         void rescale_to_next_inplace_internal(CKKSCiphertext &ct) override;
 
@@ -53,6 +62,8 @@ namespace hit {
         enum EncryptionMode { FIRST_ENCRYPT, IMPLICIT_LEVEL, EXPLICIT_LEVEL };
         EncryptionMode encryption_mode_ = FIRST_ENCRYPT;
         const int num_slots_ = 4096;
+        // see `has_rotation_key`
+        const std::vector<int> galois_steps_;
         int multiplicative_depth_ = 0;
         // We can't make this value `const` even though DepthFinder
         // doesn't update it. The reason is that DepthFinder works when
@@ -10,6 +10,8 @@
 #include <glog/logging.h>
 
 #include <future>
+#include <mutex>
+#include <thread>
 
 #include "../../common.h"
 #include "../../sealutils.h"
@@ -279,9 +281,9 @@ namespace hit {
         destination.he_level_ = level;
         destination.scale_ = scale;
 
-        Plaintext temp;
-        encoder->encode(coeffs, context_data->parms_id(), scale, temp);
-        seal_encryptor->encrypt(temp, destination.seal_ct);
+        Plaintext temp(pool());
+        encoder->encode(coeffs, context_data->parms_id(), scale, temp, pool());
+        seal_encryptor->encrypt(temp, destination.seal_ct.overwrite(), pool());
 
         destination.num_slots_ = num_slots_;
         destination.initialized = true;
@@ -299,16 +301,16 @@ namespace hit {
                 "Decryption is only possible from a deserialized instance when the secret key is provided.");
         }
 
-        Plaintext temp;
+        Plaintext temp(pool());
 
         if (!suppress_warnings) {
             decryption_warning(encrypted.he_level());
         }
 
-        seal_decryptor->decrypt(encrypted.seal_ct, temp);
+        seal_decryptor->decrypt(encrypted.seal_ct.get(), temp);
 
         vector<double> decoded_output;
-        encoder->decode(temp, decoded_output);
+        encoder->decode(temp, decoded_output, pool());
 
         return decoded_output;
     }
@@ -317,83 +319,285 @@ namespace hit {
         return encoder->slot_count();
     }
 
+    bool HomomorphicEval::has_rotation_key(int steps) const {
+        int slots = num_slots();
+        steps = ((steps % slots) + slots) % slots;
+        if (steps == 0) {
+            return true;
+        }
+        return galois_keys.has_key(context->key_context_data()->galois_tool()->get_elt_from_step(steps));
+    }
+
+    // see `MemoryArena::current`
+    static thread_local MemoryArena *current_arena = nullptr;
+
+    // Each thread holds the only owning reference to its sentinel, so the references held by an evaluator's
+    // `thread_pools_` expire when the thread exits.
+    static thread_local const shared_ptr<const void> thread_alive = make_shared<char>();
+
+    MemoryArena::MemoryArena(const HomomorphicEval &eval) : eval_(eval), enclosing_(current_arena) {
+        unique_lock lock(eval_.pools_mutex_);
+        eval_.arenas_.insert(this);
+        current_arena = this;
+    }
+
+    MemoryArena::~MemoryArena() {
+        if (current_arena != this) {
+            LOG(ERROR) << "A MemoryArena must be destroyed on the thread which created it, "
+                       << "after any arenas created within it";
+        }
+        current_arena = enclosing_;
+        unique_lock lock(eval_.pools_mutex_);
+        eval_.arenas_.erase(this);
+        VLOG(VLOG_VERBOSE) << "Releasing " << pools_.size() << " arena memory pools holding "
+                           << bytes_to_str(alloc_byte_count());
+        // SEAL frees the memory of each pool once the last handle to it is destroyed
+    }
+
+    size_t MemoryArena::alloc_byte_count() const {
+        shared_lock lock(pools_mutex_);
+        size_t bytes = 0;
+        for (const auto &pool : pools_) {
+            bytes += pool.second.alloc_byte_count();
+        }
+        return bytes;
+    }
+
+    MemoryArena *MemoryArena::current() {
+        return current_arena;
+    }
+
+    MemoryArena *MemoryArena::set_current(MemoryArena *arena) {
+        MemoryArena *previous = current_arena;
+        current_arena = arena;
+        return previous;
+    }
+
+    MemoryPoolHandle MemoryArena::pool() {
+        thread::id id = this_thread::get_id();
+        {
+            shared_lock lock(pools_mutex_);
+            auto it = pools_.find(id);
+            if (it != pools_.end()) {
+                return it->second;
+            }
+        }
+        unique_lock lock(pools_mutex_);
+        // a thread-safe pool, since ciphertexts computed on one thread may be freed on another
+        return pools_.try_emplace(id, MemoryPoolHandle::New()).first->second;
+    }
+
+    MemoryPoolHandle HomomorphicEval::pool() const {
+        for (MemoryArena *arena = current_arena; arena != nullptr; arena = arena->enclosing_) {
+            if (&arena->eval_ == this) {
+                return arena->pool();
+            }
+        }
+
+        thread::id id = this_thread::get_id();
+        {
+            shared_lock lock(pools_mutex_);
+            auto it = thread_pools_.find(id);
+            // a thread may reuse the id of a thread which has exited, but not of a live thread
+            if (it != thread_pools_.end() && !it->second.thread_alive.expired()) {
+                return it->second.pool;
+            }
+        }
+        unique_lock lock(pools_mutex_);
+        release_idle_pools();
+        // a thread-safe pool, since ciphertexts computed on one thread may be freed on another
+        return thread_pools_.try_emplace(id, ThreadPool{MemoryPoolHandle::New(), thread_alive}).first->second.pool;
+    }
+
+    void HomomorphicEval::release_idle_pools() const {
+        for (auto it = thread_pools_.begin(); it != thread_pools_.end();) {
+            if (it->second.thread_alive.expired()) {
+                it = thread_pools_.erase(it);
+            } else {
+                it++;
+            }
+        }
+    }
+
+    MemoryPoolStats HomomorphicEval::pool_stats() const {
+        unique_lock lock(pools_mutex_);
+        release_idle_pools();
+        MemoryPoolStats stats;
+        for (const auto &pool : thread_pools_) {
+            stats.num_pools++;
+            stats.alloc_byte_count += pool.second.pool.alloc_byte_count();
+        }
+        for (const auto *arena : arenas_) {
+            shared_lock arena_lock(arena->pools_mutex_);
+            for (const auto &pool : arena->pools_) {
+                stats.num_pools++;
+                stats.alloc_byte_count += pool.second.alloc_byte_count();
+                stats.arena_byte_count += pool.second.alloc_byte_count();
+            }
+        }
+        return stats;
+    }
+
+    size_t HomomorphicEval::advise_huge_pages() {
+        vector<pair<const void *, size_t>> ranges;
+        auto add_key_ranges = [&ranges](const vector<vector<PublicKey>> &keys) {
+            for (const auto &key_vector : keys) {
+                for (const auto &key : key_vector) {
+                    const Ciphertext &key_ct = key.data();
+                    size_t key_bytes =
+                        key_ct.size() * key_ct.poly_modulus_degree() * key_ct.coeff_modulus_size() * sizeof(uint64_t);
+                    ranges.emplace_back(key_ct.data(), key_bytes);
+                }
+            }
+        };
+        add_key_ranges(galois_keys.data());
+        add_key_ranges(relin_keys.data());
+        for (const auto &keys : node_keys_) {
+            add_key_ranges(keys->galois_keys.data());
+            add_key_ranges(keys->relin_keys.data());
+        }
+
+        size_t advised_bytes = hit::advise_huge_pages(move(ranges));
+        VLOG(VLOG_VERBOSE) << "Advised " << bytes_to_str(advised_bytes) << " of evaluation keys to use huge pages";
+        return advised_bytes;
+    }
+
+    void HomomorphicEval::replicate_keys(const NumaTopology &topology) {
+        timepoint start = chrono::steady_clock::now();
+        vector<unique_ptr<NodeKeys>> node_keys(topology.num_nodes());
+        vector<thread> copiers;
+        for (int node = 0; node < topology.num_nodes(); node++) {
+            // Memory is placed on the node of the thread which first writes it, so each copy is made by a
+            // thread on the target node, into a fresh pool which does not reuse memory from other nodes.
+            copiers.emplace_back([&, node]() {
+                pin_thread_to_node(topology, node);
+                MemoryPoolHandle pool = MemoryPoolHandle::New();
+                MMProfGuard guard(make_unique<MMProfFixed>(pool));
+                node_keys[node] = make_unique<NodeKeys>();
+                node_keys[node]->pool = pool;
+                node_keys[node]->galois_keys = galois_keys;
+                node_keys[node]->relin_keys = relin_keys;
+            });
+        }
+        for (auto &copier : copiers) {
+            copier.join();
+        }
+        numa_topology_ = topology;
+        node_keys_ = move(node_keys);
+        print_elapsed_time(start, "Replicating keys on " + to_string(topology.num_nodes()) + " NUMA node(s)...");
+    }
+
+    vector<size_t> HomomorphicEval::key_switches_per_node() const {
+        vector<size_t> key_switches;
+        for (const auto &keys : node_keys_) {
+            key_switches.push_back(keys->num_key_switches);
+        }
+        return key_switches;
+    }
+
+    const GaloisKeys &HomomorphicEval::local_galois_keys() {
+        if (node_keys_.empty()) {
+            return galois_keys;
+        }
+        NodeKeys &keys = *node_keys_[numa_topology_.current_node()];
+        keys.num_key_switches++;
+        return keys.galois_keys;
+    }
+
+    const RelinKeys &HomomorphicEval::local_relin_keys() {
+        if (node_keys_.empty()) {
+            return relin_keys;
+        }
+        NodeKeys &keys = *node_keys_[numa_topology_.current_node()];
+        keys.num_key_switches++;
+        return keys.relin_keys;
+    }
+
     uint64_t HomomorphicEval::get_last_prime_internal(const CKKSCiphertext &ct) const {
         return get_last_prime(context, ct.he_level());
     }
 
     void HomomorphicEval::rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) {
-        CKKSCiphertext dest = ct;
-        seal_evaluator->rotate_vector_inplace(ct.seal_ct, -steps, galois_keys);
+        seal_evaluator->rotate_vector_inplace(ct.seal_ct.mutate(), -steps, local_galois_keys(), pool());
     }
 
     void HomomorphicEval::rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) {
-        seal_evaluator->rotate_vector_inplace(ct.seal_ct, steps, galois_keys);
+        seal_evaluator->rotate_vector_inplace(ct.seal_ct.mutate(), steps, local_galois_keys(), pool());
     }
 
     void HomomorphicEval::negate_inplace_internal(CKKSCiphertext &ct) {
-        seal_evaluator->negate_inplace(ct.seal_ct);
+        seal_evaluator->negate_inplace(ct.seal_ct.mutate());
     }
 
     void HomomorphicEval::add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        seal_evaluator->add_inplace(ct1.seal_ct, ct2.seal_ct);
+        // `ct1` is made unique before `ct2` is read, since they may be the same object
+        Ciphertext &result = ct1.seal_ct.mutate();
+        seal_evaluator->add_inplace(result, ct2.seal_ct.get());
     }
 
     void HomomorphicEval::add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        Plaintext encoded_plain;
-        encoder->encode(scalar, ct.seal_ct.parms_id(), ct.seal_ct.scale(), encoded_plain);
-        seal_evaluator->add_plain_inplace(ct.seal_ct, encoded_plain);
+        Plaintext encoded_plain(pool());
+        encoder->encode(scalar, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), encoded_plain, pool());
+        seal_evaluator->add_plain_inplace(ct.seal_ct.mutate(), encoded_plain);
     }
 
     void HomomorphicEval::add_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        Plaintext temp;
-        encoder->encode(plain, ct.seal_ct.parms_id(), ct.seal_ct.scale(), temp);
-        seal_evaluator->add_plain_inplace(ct.seal_ct, temp);
+        Plaintext temp(pool());
+        encoder->encode(plain, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), temp, pool());
+        seal_evaluator->add_plain_inplace(ct.seal_ct.mutate(), temp);
     }
 
     void HomomorphicEval::sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        seal_evaluator->sub_inplace(ct1.seal_ct, ct2.seal_ct);
+        // `ct1` is made unique before `ct2` is read, since they may be the same object
+        Ciphertext &result = ct1.seal_ct.mutate();
+        seal_evaluator->sub_inplace(result, ct2.seal_ct.get());
     }
 
     void HomomorphicEval::sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        Plaintext encoded_plain;
-        encoder->encode(scalar, ct.seal_ct.parms_id(), ct.seal_ct.scale(), encoded_plain);
-        seal_evaluator->sub_plain_inplace(ct.seal_ct, encoded_plain);
+        Plaintext encoded_plain(pool());
+        encoder->encode(scalar, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), encoded_plain, pool());
+        seal_evaluator->sub_plain_inplace(ct.seal_ct.mutate(), encoded_plain);
     }
 
     void HomomorphicEval::sub_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        Plaintext temp;
-        encoder->encode(plain, ct.seal_ct.parms_id(), ct.seal_ct.scale(), temp);
-        seal_evaluator->sub_plain_inplace(ct.seal_ct, temp);
+        Plaintext temp(pool());
+        encoder->encode(plain, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), temp, pool());
+        seal_evaluator->sub_plain_inplace(ct.seal_ct.mutate(), temp);
     }
 
     void HomomorphicEval::multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        seal_evaluator->multiply_inplace(ct1.seal_ct, ct2.seal_ct);
+        // `ct1` is made unique before `ct2` is read, since they may be the same object
+        Ciphertext &result = ct1.seal_ct.mutate();
+        seal_evaluator->multiply_inplace(result, ct2.seal_ct.get(), pool());
     }
 
     /* WARNING: Multiplying by 0 results in non-constant time behavior! Only multiply by 0 if the scalar is truly
      * public. */
     void HomomorphicEval::multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
         if (scalar != double{0}) {
-            Plaintext encoded_plain;
-            encoder->encode(scalar, ct.seal_ct.parms_id(), ct.seal_ct.scale(), encoded_plain);
-            seal_evaluator->multiply_plain_inplace(ct.seal_ct, encoded_plain);
+            Plaintext encoded_plain(pool());
+            encoder->encode(scalar, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), encoded_plain, pool());
+            seal_evaluator->multiply_plain_inplace(ct.seal_ct.mutate(), encoded_plain, pool());
         } else {
-            double previous_scale = ct.seal_ct.scale();
-            seal_encryptor->encrypt_zero(ct.seal_ct.parms_id(), ct.seal_ct);
+            double previous_scale = ct.seal_ct.get().scale();
+            parms_id_type parms_id = ct.seal_ct.get().parms_id();
+            // the previous value is discarded, so there is no need to clone it if it is shared
+            Ciphertext &result = ct.seal_ct.overwrite();
+            seal_encryptor->encrypt_zero(parms_id, result, pool());
             // seal sets the scale to be 1, but our the debug evaluator always ensures that the SEAL scale is consistent
             // with our mirror calculation
-            ct.seal_ct.scale() = previous_scale * previous_scale;
+            result.scale() = previous_scale * previous_scale;
         }
     }
 
     void HomomorphicEval::multiply_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        Plaintext temp;
-        encoder->encode(plain, ct.seal_ct.parms_id(), ct.seal_ct.scale(), temp);
-        seal_evaluator->multiply_plain_inplace(ct.seal_ct, temp);
+        Plaintext temp(pool());
+        encoder->encode(plain, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), temp, pool());
+        seal_evaluator->multiply_plain_inplace(ct.seal_ct.mutate(), temp, pool());
     }
 
     void HomomorphicEval::square_inplace_internal(CKKSCiphertext &ct) {
-        seal_evaluator->square_inplace(ct.seal_ct);
+        seal_evaluator->square_inplace(ct.seal_ct.mutate(), pool());
     }
 
     void HomomorphicEval::reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) {
@@ -404,10 +608,124 @@ namespace hit {
     }
 
     void HomomorphicEval::rescale_to_next_inplace_internal(CKKSCiphertext &ct) {
-        seal_evaluator->rescale_to_next_inplace(ct.seal_ct);
+        seal_evaluator->rescale_to_next_inplace(ct.seal_ct.mutate(), pool());
     }
 
     void HomomorphicEval::relinearize_inplace_internal(CKKSCiphertext &ct) {
-        seal_evaluator->relinearize_inplace(ct.seal_ct, relin_keys);
+        seal_evaluator->relinearize_inplace(ct.seal_ct.mutate(), local_relin_keys(), pool());
+    }
+
+    /* Out-of-place operations write SEAL's output directly to `dest.seal_ct`, and only copy
+     * the (small) metadata of the input, rather than copying the input ciphertext to `dest`
+     * and then operating in place. `dest` is never one of the inputs, so its previous value
+     * can be discarded without cloning it, even if it is shared with an input.
+     */
+    void HomomorphicEval::rotate_right_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) {
+        seal_evaluator->rotate_vector(ct.seal_ct.get(), -steps, local_galois_keys(), dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::rotate_left_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) {
+        seal_evaluator->rotate_vector(ct.seal_ct.get(), steps, local_galois_keys(), dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::negate_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        seal_evaluator->negate(ct.seal_ct.get(), dest.seal_ct.overwrite());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::add_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
+        seal_evaluator->add(ct1.seal_ct.get(), ct2.seal_ct.get(), dest.seal_ct.overwrite());
+        copy_metadata(ct1, dest);
+    }
+
+    void HomomorphicEval::add_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
+        Plaintext encoded_plain(pool());
+        encoder->encode(scalar, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), encoded_plain, pool());
+        seal_evaluator->add_plain(ct.seal_ct.get(), encoded_plain, dest.seal_ct.overwrite());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::add_plain_internal(const CKKSCiphertext &ct, const vector<double> &plain,
+                                             CKKSCiphertext &dest) {
+        Plaintext temp(pool());
+        encoder->encode(plain, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), temp, pool());
+        seal_evaluator->add_plain(ct.seal_ct.get(), temp, dest.seal_ct.overwrite());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::sub_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) {
+        seal_evaluator->sub(ct1.seal_ct.get(), ct2.seal_ct.get(), dest.seal_ct.overwrite());
+        copy_metadata(ct1, dest);
+    }
+
+    void HomomorphicEval::sub_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
+        Plaintext encoded_plain(pool());
+        encoder->encode(scalar, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), encoded_plain, pool());
+        seal_evaluator->sub_plain(ct.seal_ct.get(), encoded_plain, dest.seal_ct.overwrite());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::sub_plain_internal(const CKKSCiphertext &ct, const vector<double> &plain,
+                                             CKKSCiphertext &dest) {
+        Plaintext temp(pool());
+        encoder->encode(plain, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), temp, pool());
+        seal_evaluator->sub_plain(ct.seal_ct.get(), temp, dest.seal_ct.overwrite());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::multiply_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2,
+                                            CKKSCiphertext &dest) {
+        seal_evaluator->multiply(ct1.seal_ct.get(), ct2.seal_ct.get(), dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct1, dest);
+    }
+
+    void HomomorphicEval::multiply_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) {
+        if (scalar != double{0}) {
+            Plaintext encoded_plain(pool());
+            encoder->encode(scalar, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), encoded_plain, pool());
+            seal_evaluator->multiply_plain(ct.seal_ct.get(), encoded_plain, dest.seal_ct.overwrite(), pool());
+        } else {
+            Ciphertext &result = dest.seal_ct.overwrite();
+            seal_encryptor->encrypt_zero(ct.seal_ct.get().parms_id(), result, pool());
+            // as above, keep the SEAL scale consistent with our mirror calculation
+            result.scale() = ct.seal_ct.get().scale() * ct.seal_ct.get().scale();
+        }
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::multiply_plain_internal(const CKKSCiphertext &ct, const vector<double> &plain,
+                                                  CKKSCiphertext &dest) {
+        Plaintext temp(pool());
+        encoder->encode(plain, ct.seal_ct.get().parms_id(), ct.seal_ct.get().scale(), temp, pool());
+        seal_evaluator->multiply_plain(ct.seal_ct.get(), temp, dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::square_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        seal_evaluator->square(ct.seal_ct.get(), dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::reduce_level_to_internal(const CKKSCiphertext &ct, int level, CKKSCiphertext &dest) {
+        if (ct.he_level() == level) {
+            dest = ct;
+            return;
+        }
+        // the first step writes to `dest`, so the input is never copied
+        multiply_plain(ct, 1, dest);
+        rescale_to_next_inplace(dest);
+        reduce_level_to_inplace_internal(dest, level);
+    }
+
+    void HomomorphicEval::rescale_to_next_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        seal_evaluator->rescale_to_next(ct.seal_ct.get(), dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct, dest);
+    }
+
+    void HomomorphicEval::relinearize_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) {
+        seal_evaluator->relinearize(ct.seal_ct.get(), local_relin_keys(), dest.seal_ct.overwrite(), pool());
+        copy_metadata(ct, dest);
     }
 }  // namespace hit
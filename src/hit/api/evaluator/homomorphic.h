@@ -3,6 +3,14 @@
 
 #pragma once
 
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "../../numa.h"
 #include "../ciphertext.h"
 #include "../evaluator.h"
 #include "seal/context.h"
@@ -10,6 +18,58 @@
 
 namespace hit {
 
+    // Memory usage of the SEAL memory pools owned by a HomomorphicEval
+    struct MemoryPoolStats {
+        // number of pools: one per live thread which has evaluated an operation, plus one per thread in each arena
+        size_t num_pools = 0;
+        // bytes currently held by these pools; pools keep memory for reuse until they are released
+        size_t alloc_byte_count = 0;
+        // bytes held by the pools of the live arenas, which are released when each arena is destroyed
+        size_t arena_byte_count = 0;
+    };
+
+    class HomomorphicEval;
+
+    /* An arena scopes the SEAL temporaries of a computation (e.g., a LinearAlgebra call) on a HomomorphicEval.
+     * While an arena is alive, the operations which the thread that created it evaluates with `eval` allocate
+     * their temporaries from fresh pools owned by the arena, which are all released when it is destroyed.
+     * This bounds the memory retained after the computation, at the cost of re-allocating temporaries for
+     * each arena. The arena also applies to the iterations of LinearAlgebra's parallel loops started by that
+     * thread, but not to other threads using the evaluator. Arenas nest: a thread uses its innermost arena
+     * for `eval`. An arena must be destroyed on the thread which created it, and before `eval`.
+     */
+    class MemoryArena {
+       public:
+        explicit MemoryArena(const HomomorphicEval &eval);
+        ~MemoryArena();
+
+        MemoryArena(const MemoryArena &) = delete;
+        MemoryArena &operator=(const MemoryArena &) = delete;
+        MemoryArena(MemoryArena &&) = delete;
+        MemoryArena &operator=(MemoryArena &&) = delete;
+
+        // bytes currently held by the pools of this arena
+        size_t alloc_byte_count() const;
+
+        // The innermost arena of the calling thread, or null. `set_current` replaces it and returns the
+        // previous value, so that code which evaluates work on behalf of another thread (e.g., a parallel loop)
+        // can use that thread's arena, and restore its own afterwards.
+        static MemoryArena *current();
+        static MemoryArena *set_current(MemoryArena *arena);
+
+       private:
+        const HomomorphicEval &eval_;
+        MemoryArena *enclosing_;
+        // guards the map below, which is only modified the first time a thread uses this arena
+        mutable std::shared_mutex pools_mutex_;
+        std::unordered_map<std::thread::id, seal::MemoryPoolHandle> pools_;
+
+        // the calling thread's pool in this arena
+        seal::MemoryPoolHandle pool();
+
+        friend class HomomorphicEval;
+    };
+
     /* This evaluator is a thin wrapper around
      * SEAL's evaluator API. It actually does
      * computation on SEAL ciphertexts.
@@ -69,6 +129,40 @@ namespace hit {
 
         int num_slots() const override;
 
+        bool has_rotation_key(int steps) const override;
+
+        /* SEAL allocates the temporaries of each operation (e.g., key-switching buffers) from a memory pool.
+         * Rather than SEAL's global pool, which is shared by (and locked for) every thread, this evaluator
+         * gives each thread which uses it a pool of its own, so that threads in `parallel_for` do not contend
+         * on a single pool. A pool keeps its memory for reuse until its thread exits (the pools of threads
+         * which have exited are released the next time a thread first uses this evaluator, or by `pool_stats`)
+         * or the evaluator is destroyed. Long-lived threads, such as the workers which evaluate parallel loops,
+         * therefore keep their pools; use a MemoryArena to release the temporaries of a computation.
+         */
+        MemoryPoolStats pool_stats() const;
+
+        /* Key switching (rotation and relinearization) streams through the evaluation keys, which for
+         * realistic parameters are hundreds of megabytes spread over many 4 KB pages, so it incurs frequent
+         * TLB misses. This asks the kernel to back the keys with 2 MB transparent huge pages instead.
+         * It is a hint: on kernels without transparent huge pages (or where they are disabled), nothing
+         * changes. Outputs the number of bytes which were advised. Keys generated or loaded later are
+         * not affected, so call this again after adding keys.
+         */
+        size_t advise_huge_pages();
+
+        /* On a machine with several NUMA nodes, every key switch on a thread which runs on a different node
+         * than the evaluation keys reads the keys across the interconnect. This makes a copy of the Galois and
+         * relinearization keys on each node of `topology`; afterward, each key switch uses the copy on the
+         * node of the calling thread. This is most effective when threads are pinned to nodes (see
+         * `LinearAlgebra::enable_numa`). The copies are not updated if keys are added later, and this must
+         * not be called while another thread is using this evaluator.
+         */
+        void replicate_keys(const NumaTopology &topology);
+
+        // The number of key switches (rotations and relinearizations) which used each node's copy of the keys,
+        // indexed by node. This is empty unless the keys are replicated.
+        std::vector<size_t> key_switches_per_node() const;
+
        protected:
         void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
@@ -104,6 +198,43 @@ namespace hit {
 
         void relinearize_inplace_internal(CKKSCiphertext &ct) override;
 
+        void rotate_right_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) override;
+
+        void rotate_left_internal(const CKKSCiphertext &ct, int steps, CKKSCiphertext &dest) override;
+
+        void negate_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) override;
+
+        void add_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) override;
+
+        void add_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) override;
+
+        void add_plain_internal(const CKKSCiphertext &ct, const std::vector<double> &plain,
+                                CKKSCiphertext &dest) override;
+
+        void sub_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) override;
+
+        void sub_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) override;
+
+        void sub_plain_internal(const CKKSCiphertext &ct, const std::vector<double> &plain,
+                                CKKSCiphertext &dest) override;
+
+        void multiply_internal(const CKKSCiphertext &ct1, const CKKSCiphertext &ct2, CKKSCiphertext &dest) override;
+
+        /* WARNING: Multiplying by 0 results in non-constant time behavior! Only multiply by 0 if the scalar is truly
+         * public. */
+        void multiply_plain_internal(const CKKSCiphertext &ct, double scalar, CKKSCiphertext &dest) override;
+
+        void multiply_plain_internal(const CKKSCiphertext &ct, const std::vector<double> &plain,
+                                     CKKSCiphertext &dest) override;
+
+        void square_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) override;
+
+        void reduce_level_to_internal(const CKKSCiphertext &ct, int level, CKKSCiphertext &dest) override;
+
+        void rescale_to_next_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) override;
+
+        void relinearize_internal(const CKKSCiphertext &ct, CKKSCiphertext &dest) override;
+
        private:
         seal::CKKSEncoder *encoder = nullptr;       // no default constructor
         seal::Evaluator *seal_evaluator = nullptr;  // no default constructor
@@ -117,11 +248,42 @@ namespace hit {
 
         int log_scale_;
 
+        // the memory pool for SEAL temporaries on the calling thread: the pool of its innermost arena for this
+        // evaluator, if any, and its own pool otherwise
+        seal::MemoryPoolHandle pool() const;
+        // A thread's own pool, along with a reference which expires when the thread exits.
+        struct ThreadPool {
+            seal::MemoryPoolHandle pool;
+            std::weak_ptr<const void> thread_alive;
+        };
+        // release the pools of threads which have exited; requires a unique lock on `pools_mutex_`
+        void release_idle_pools() const;
+        // guards the containers below; `thread_pools_` is only modified the first time a thread uses this
+        // evaluator, and `arenas_` when an arena is created or destroyed
+        mutable std::shared_mutex pools_mutex_;
+        mutable std::unordered_map<std::thread::id, ThreadPool> thread_pools_;
+        mutable std::unordered_set<const MemoryArena *> arenas_;
+
+        // a copy of the evaluation keys which is local to one NUMA node
+        struct NodeKeys {
+            // the pool which holds the keys, so it must be destroyed after them
+            seal::MemoryPoolHandle pool;
+            seal::GaloisKeys galois_keys;
+            seal::RelinKeys relin_keys;
+            std::atomic<size_t> num_key_switches{0};
+        };
+        NumaTopology numa_topology_;
+        std::vector<std::unique_ptr<NodeKeys>> node_keys_;
+        // the keys on the calling thread's node, if they are replicated, and the original keys otherwise
+        const seal::GaloisKeys &local_galois_keys();
+        const seal::RelinKeys &local_relin_keys();
+
         uint64_t get_last_prime_internal(const CKKSCiphertext &ct) const override;
 
         void deserialize_common(std::istream &params_stream);
 
         friend class DebugEval;
+        friend class MemoryArena;
         friend class ScaleEstimator;
     };
 }  // namespace hit
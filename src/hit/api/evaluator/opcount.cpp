@@ -13,7 +13,8 @@ using namespace std;
 using namespace seal;
 namespace hit {
 
-    OpCount::OpCount(int num_slots) : num_slots_(num_slots) {
+    OpCount::OpCount(int num_slots, const vector<int> &galois_steps)
+        : num_slots_(num_slots), galois_steps_(galois_steps) {
     }
 
     CKKSCiphertext OpCount::encrypt(const vector<double> &coeffs) {
@@ -21,6 +22,14 @@ namespace hit {
     }
 
     CKKSCiphertext OpCount::encrypt(const vector<double> &, int level) {
+        return encrypt_placeholder(level);
+    }
+
+    CKKSCiphertext OpCount::encrypt_placeholder() {
+        return encrypt_placeholder(-1);
+    }
+
+    CKKSCiphertext OpCount::encrypt_placeholder(int level) {
         {
             scoped_lock lock(mutex_);
             encryptions_++;
@@ -48,10 +57,44 @@ namespace hit {
         VLOG(VLOG_EVAL) << "Relinearizations: " << relins_;
     }
 
+    int OpCount::num_multiplications() const {
+        shared_lock lock(mutex_);
+        return multiplies_;
+    }
+
+    int OpCount::num_additions() const {
+        shared_lock lock(mutex_);
+        return additions_;
+    }
+
+    int OpCount::num_rotations() const {
+        shared_lock lock(mutex_);
+        return rotations_;
+    }
+
+    int OpCount::num_rescales() const {
+        shared_lock lock(mutex_);
+        return rescales_;
+    }
+
+    int OpCount::num_relinearizations() const {
+        shared_lock lock(mutex_);
+        return relins_;
+    }
+
+    int OpCount::num_encryptions() const {
+        shared_lock lock(mutex_);
+        return encryptions_;
+    }
+
     int OpCount::num_slots() const {
         return num_slots_;
     }
 
+    bool OpCount::has_rotation_key(int steps) const {
+        return has_galois_key(galois_steps_, steps, num_slots_);
+    }
+
     void OpCount::rotate_right_inplace_internal(CKKSCiphertext &, int) {
         count_rotation_ops();
     }
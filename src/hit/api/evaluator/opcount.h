@@ -14,7 +14,10 @@ namespace hit {
     /* This evaluator tracks the plaintext computation */
     class OpCount : public CKKSEvaluator {
        public:
-        explicit OpCount(int num_slots);
+        /* `galois_steps` are the rotations which the homomorphic computation has keys for, as for HomomorphicEval.
+         * These determine the rotations performed by LinearAlgebra, and thus the number of rotations counted.
+         */
+        explicit OpCount(int num_slots, const std::vector<int> &galois_steps = std::vector<int>());
 
         /* For documentation on the API, see ../evaluator.h */
         ~OpCount() override = default;
@@ -27,8 +30,20 @@ namespace hit {
         /* Print the total number of operations performed in this computation. */
         void print_op_count() const;
 
+        /* Number of operations of each type performed so far in this computation. */
+        int num_multiplications() const;
+        int num_additions() const;
+        int num_rotations() const;
+        int num_rescales() const;
+        int num_relinearizations() const;
+        int num_encryptions() const;
+
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
+        CKKSCiphertext encrypt_placeholder() override;
+        CKKSCiphertext encrypt_placeholder(int level) override;
+
+        bool has_rotation_key(int steps) const override;
 
        protected:
         void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
@@ -77,6 +92,8 @@ namespace hit {
         int rescales_ = 0;
         int relins_ = 0;
         int num_slots_ = 0;
+        // see `has_rotation_key`
+        const std::vector<int> galois_steps_;
 
         inline void count_multiple_ops() {
             std::scoped_lock lock(mutex_);
@@ -5,8 +5,12 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <execution>
 #include <functional>
 #include <iomanip>
+#include <numeric>
+#include <utility>
 
 #include "../../common.h"
 
@@ -14,10 +18,14 @@ using namespace std;
 
 namespace hit {
 
-    PlaintextEval::PlaintextEval(int num_slots) : num_slots_(num_slots) {
+    PlaintextEval::PlaintextEval(int num_slots, int num_samples, const vector<int> &galois_steps)
+        : num_slots_(num_slots), galois_steps_(galois_steps), num_samples_(num_samples) {
         if (!is_pow2(num_slots)) {
             LOG_AND_THROW_STREAM("Number of plaintext slots must be a power of two; got " << num_slots);
         }
+        if (num_samples < 1) {
+            LOG_AND_THROW_STREAM("Number of samples must be positive; got " << num_samples);
+        }
     }
 
     CKKSCiphertext PlaintextEval::encrypt(const vector<double> &coeffs) {
@@ -25,13 +33,7 @@ namespace hit {
     }
 
     CKKSCiphertext PlaintextEval::encrypt(const vector<double> &coeffs, int) {
-        if (coeffs.size() != num_slots_) {
-            // bad things can happen if you don't plan for your input to be smaller than the ciphertext
-            // This forces the caller to ensure that the input has the correct size or is at least appropriately padded
-            LOG_AND_THROW_STREAM("You can only encrypt vectors which have exactly as many "
-                                 << " coefficients as the number of plaintext slots: Expected " << num_slots_
-                                 << " coefficients, but " << coeffs.size() << " were provided");
-        }
+        vector<double> batch = batch_coeffs(coeffs);
 
         {
             scoped_lock lock(mutex_);
@@ -40,39 +42,227 @@ namespace hit {
         }
 
         CKKSCiphertext destination;
-        destination.raw_pt = coeffs;
+        destination.raw_pt.overwrite() = move(batch);
+        destination.num_slots_ = num_slots_;
+        destination.initialized = true;
+
+        return destination;
+    }
+
+    CKKSCiphertext PlaintextEval::encrypt_batch(const vector<vector<double>> &samples) {
+        CKKSCiphertext destination;
+        destination.raw_pt.overwrite() = batch_coeffs(samples);
         destination.num_slots_ = num_slots_;
         destination.initialized = true;
 
+        update_max_log_plain_val(sample_l_inf_norms(destination.raw_pt.get()));
         return destination;
     }
 
+    vector<double> PlaintextEval::batch_coeffs(const vector<double> &coeffs) const {
+        if (coeffs.size() != num_slots_) {
+            // bad things can happen if you don't plan for your input to be smaller than the ciphertext
+            // This forces the caller to ensure that the input has the correct size or is at least appropriately padded
+            LOG_AND_THROW_STREAM("You can only encrypt vectors which have exactly as many "
+                                 << " coefficients as the number of plaintext slots: Expected " << num_slots_
+                                 << " coefficients, but " << coeffs.size() << " were provided");
+        }
+        if (num_samples_ == 1) {
+            return coeffs;
+        }
+        vector<double> batch;
+        batch.reserve(static_cast<size_t>(num_samples_) * num_slots_);
+        for (int i = 0; i < num_samples_; i++) {
+            batch.insert(batch.end(), coeffs.begin(), coeffs.end());
+        }
+        return batch;
+    }
+
+    vector<double> PlaintextEval::batch_coeffs(const vector<vector<double>> &samples) const {
+        if (samples.size() != num_samples_) {
+            LOG_AND_THROW_STREAM("Expected " << num_samples_ << " samples, but " << samples.size()
+                                             << " were provided");
+        }
+        vector<double> batch;
+        batch.reserve(static_cast<size_t>(num_samples_) * num_slots_);
+        for (const auto &coeffs : samples) {
+            if (coeffs.size() != num_slots_) {
+                LOG_AND_THROW_STREAM("You can only encrypt vectors which have exactly as many "
+                                     << " coefficients as the number of plaintext slots: Expected " << num_slots_
+                                     << " coefficients, but " << coeffs.size() << " were provided");
+            }
+            batch.insert(batch.end(), coeffs.begin(), coeffs.end());
+        }
+        return batch;
+    }
+
+    void PlaintextEval::for_each_sample(const function<void(int)> &body) const {
+        if (num_samples_ == 1) {
+            body(0);
+            return;
+        }
+        vector<int> sample_idxs(num_samples_);
+        iota(sample_idxs.begin(), sample_idxs.end(), 0);
+        for_each(__pstl::execution::par, sample_idxs.begin(), sample_idxs.end(), body);
+    }
+
+    // Each slot kernel is compiled for AVX-512 and AVX2 as well as for the baseline ISA, and the version
+    // for the running CPU is selected when the library is loaded. `omp simd` (enabled by -fopenmp-simd,
+    // which does not link against OpenMP) lets the compiler vectorize the max-magnitude reductions.
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__)
+#define HIT_SLOT_KERNEL __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define HIT_SLOT_KERNEL
+#endif
+
+    /* Slot kernels operate on `n` contiguous slots and output the largest magnitude of their result,
+     * so that an operation and the norm of its result take a single pass over memory.
+     * `dst` and `src` may be equal, but must not otherwise overlap.
+     */
+    HIT_SLOT_KERNEL static double max_abs_slots(const double *src, size_t n) {
+        double max_abs = 0;
+#pragma omp simd reduction(max : max_abs)
+        for (size_t j = 0; j < n; j++) {
+            max_abs = max(max_abs, abs(src[j]));
+        }
+        return max_abs;
+    }
+
+    HIT_SLOT_KERNEL static double add_slots(double *dst, const double *src, size_t n) {
+        double max_abs = 0;
+#pragma omp simd reduction(max : max_abs)
+        for (size_t j = 0; j < n; j++) {
+            dst[j] += src[j];
+            max_abs = max(max_abs, abs(dst[j]));
+        }
+        return max_abs;
+    }
+
+    HIT_SLOT_KERNEL static double sub_slots(double *dst, const double *src, size_t n) {
+        double max_abs = 0;
+#pragma omp simd reduction(max : max_abs)
+        for (size_t j = 0; j < n; j++) {
+            dst[j] -= src[j];
+            max_abs = max(max_abs, abs(dst[j]));
+        }
+        return max_abs;
+    }
+
+    HIT_SLOT_KERNEL static double mul_slots(double *dst, const double *src, size_t n) {
+        double max_abs = 0;
+#pragma omp simd reduction(max : max_abs)
+        for (size_t j = 0; j < n; j++) {
+            dst[j] *= src[j];
+            max_abs = max(max_abs, abs(dst[j]));
+        }
+        return max_abs;
+    }
+
+    HIT_SLOT_KERNEL static double add_scalar_slots(double *dst, double scalar, size_t n) {
+        double max_abs = 0;
+#pragma omp simd reduction(max : max_abs)
+        for (size_t j = 0; j < n; j++) {
+            dst[j] += scalar;
+            max_abs = max(max_abs, abs(dst[j]));
+        }
+        return max_abs;
+    }
+
+    HIT_SLOT_KERNEL static double mul_scalar_slots(double *dst, double scalar, size_t n) {
+        double max_abs = 0;
+#pragma omp simd reduction(max : max_abs)
+        for (size_t j = 0; j < n; j++) {
+            dst[j] *= scalar;
+            max_abs = max(max_abs, abs(dst[j]));
+        }
+        return max_abs;
+    }
+
+    vector<double> PlaintextEval::sample_l_inf_norms(const vector<double> &pt) const {
+        vector<double> norms(num_samples_);
+        for_each_sample(
+            [&](int i) { norms[i] = max_abs_slots(pt.data() + static_cast<size_t>(i) * num_slots_, num_slots_); });
+        return norms;
+    }
+
+    vector<double> PlaintextEval::zip_with_inplace(vector<double> &dst, int dst_rotation, const vector<double> &src,
+                                                   int src_rotation, SlotOp op) const {
+        auto kernel = op == SLOT_ADD ? add_slots : (op == SLOT_SUB ? sub_slots : mul_slots);
+        // a single-sample `src` (e.g., a plaintext argument) is combined with every sample of `dst`
+        size_t src_stride = src.size() == num_slots_ ? 0 : num_slots_;
+        // slot `j` of `dst` holds the same plaintext slot as slot `j + shift` (mod num_slots) of `src`
+        size_t shift = (src_rotation - dst_rotation + num_slots_) % num_slots_;
+
+        vector<double> norms(num_samples_);
+        for_each_sample([&](int i) {
+            double *dst_sample = dst.data() + static_cast<size_t>(i) * num_slots_;
+            const double *src_sample = src.data() + i * src_stride;
+            norms[i] = max(kernel(dst_sample, src_sample + shift, num_slots_ - shift),
+                           kernel(dst_sample + num_slots_ - shift, src_sample, shift));
+        });
+        return norms;
+    }
+
+    vector<double> PlaintextEval::zip_with_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2, SlotOp op) const {
+        // `ct1` is made unique before `ct2` is read, since they may be the same object
+        vector<double> &result = ct1.raw_pt.mutate();
+        return zip_with_inplace(result, ct1.pt_rotation_, ct2.raw_pt.get(), ct2.pt_rotation_, op);
+    }
+
+    vector<double> PlaintextEval::zip_with_inplace(CKKSCiphertext &ct, const vector<double> &plain, SlotOp op) const {
+        return zip_with_inplace(ct.raw_pt.mutate(), ct.pt_rotation_, plain, 0, op);
+    }
+
+    vector<double> PlaintextEval::map_inplace(CKKSCiphertext &ct, double scalar, SlotOp op) const {
+        // x - scalar and x + (-scalar) are equal in floating point arithmetic
+        auto kernel = op == SLOT_MUL ? mul_scalar_slots : add_scalar_slots;
+        if (op == SLOT_SUB) {
+            scalar = -scalar;
+        }
+        // rotations do not affect slot-wise operations with a scalar
+        vector<double> &result = ct.raw_pt.mutate();
+        vector<double> norms(num_samples_);
+        for_each_sample([&](int i) {
+            norms[i] = kernel(result.data() + static_cast<size_t>(i) * num_slots_, scalar, num_slots_);
+        });
+        return norms;
+    }
+
     int PlaintextEval::num_slots() const {
         return num_slots_;
     }
 
+    bool PlaintextEval::has_rotation_key(int steps) const {
+        return has_galois_key(galois_steps_, steps, num_slots_);
+    }
+
+    int PlaintextEval::num_samples() const {
+        return num_samples_;
+    }
+
     // print some debug info
     void PlaintextEval::print_stats(       // NOLINTNEXTLINE(readability-convert-member-functions-to-static)
         const CKKSCiphertext &ct) const {  // NOLINT(readability-convert-member-functions-to-static)
 
-        // extract just the elements we care about from the real plaintext
-        vector<double> exact_plaintext = ct.plaintext();
+        // extract just the elements we care about from the real plaintext, without applying the
+        // pending rotation to the whole plaintext
+        const vector<double> &raw_pt = ct.raw_pt.get();
 
         int max_print_size = 8;
         stringstream exact_plaintext_info;
         exact_plaintext_info << "    + Exact plaintext: < ";
-        for (int j = 0; j < min(max_print_size, static_cast<int>(exact_plaintext.size())); j++) {
-            exact_plaintext_info << setprecision(8) << exact_plaintext[j] << ", ";
+        for (int j = 0; j < min(max_print_size, num_slots_); j++) {
+            exact_plaintext_info << setprecision(8) << raw_pt[(j + ct.pt_rotation_) % num_slots_] << ", ";
         }
-        if (exact_plaintext.size() > max_print_size) {
+        if (raw_pt.size() > max_print_size) {
             exact_plaintext_info << "... ";
         }
         exact_plaintext_info << ">";
         VLOG(VLOG_EVAL) << exact_plaintext_info.str();
     }
 
-    void PlaintextEval::update_max_log_plain_val(const CKKSCiphertext &ct) {
-        double exact_plaintext_max_val = l_inf_norm(ct.plaintext());
+    void PlaintextEval::update_max_log_plain_val(const vector<double> &norms) {
+        double exact_plaintext_max_val = *max_element(norms.begin(), norms.end());
         {
             scoped_lock lock(mutex_);
             plaintext_max_log_ = max(plaintext_max_log_, log2(exact_plaintext_max_val));
@@ -80,111 +270,61 @@ namespace hit {
     }
 
     void PlaintextEval::rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) {
-        vector<double> rot_temp;
-        // reserve a full-size vector
-        rot_temp.reserve(num_slots_);
-
-        // the `for` loop adds elements to the back of the vector
-        // we start by adding elements from the end of `ct.raw_pt`
-        for (int i = num_slots_ - steps; i < num_slots_; i++) {
-            rot_temp.push_back(ct.raw_pt[i]);
-        }
-        // next start at the front of `ct.raw_pt` and add until full
-        for (int i = 0; i < num_slots_ - steps; i++) {
-            rot_temp.push_back(ct.raw_pt[i]);
-        }
-
-        ct.raw_pt = rot_temp;
+        // the plaintext is not moved; see CKKSCiphertext::pt_rotation_
+        ct.pt_rotation_ = (ct.pt_rotation_ + num_slots_ - steps % num_slots_) % num_slots_;
         // does not change plaintext_max_log_
         print_stats(ct);
     }
 
     void PlaintextEval::rotate_left_inplace_internal(CKKSCiphertext &ct, int steps) {
-        vector<double> rot_temp;
-        // reserve a full-size vector
-        rot_temp.reserve(num_slots_);
-        // start filling from the offset
-        for (int i = steps; i < num_slots_; i++) {
-            rot_temp.push_back(ct.raw_pt[i]);
-        }
-        // next, add the remaining elements from the front of `ct.raw_pt`
-        for (int i = 0; i < steps; i++) {
-            rot_temp.push_back(ct.raw_pt[i]);
-        }
-
-        ct.raw_pt = rot_temp;
+        // the plaintext is not moved; see CKKSCiphertext::pt_rotation_
+        ct.pt_rotation_ = (ct.pt_rotation_ + steps) % num_slots_;
         // does not change plaintext_max_log_
         print_stats(ct);
     }
 
-    template <class UnaryOperation>
-    void map_inplace(vector<double> &arg1, UnaryOperation unary_op) {
-        transform(arg1.begin(), arg1.end(), arg1.begin(), unary_op);
-    }
-
-    template <class BinaryOperation>
-    void zip_with_inplace(vector<double> &arg1, const vector<double> &arg2, BinaryOperation binary_op) {
-        transform(arg1.begin(), arg1.end(), arg2.begin(), arg1.begin(), binary_op);
-    }
-
     void PlaintextEval::negate_inplace_internal(CKKSCiphertext &ct) {
-        map_inplace(ct.raw_pt, std::negate<>());
+        map_inplace(ct, -1, SLOT_MUL);
     }
 
     void PlaintextEval::add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        zip_with_inplace(ct1.raw_pt, ct2.plaintext(), plus<>());
-        update_max_log_plain_val(ct1);
+        update_max_log_plain_val(zip_with_inplace(ct1, ct2, SLOT_ADD));
     }
 
     void PlaintextEval::add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        for (auto &coeff : ct.raw_pt) {
-            coeff += scalar;
-        }
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(map_inplace(ct, scalar, SLOT_ADD));
     }
 
     void PlaintextEval::add_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        zip_with_inplace(ct.raw_pt, plain, plus<>());
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(zip_with_inplace(ct, plain, SLOT_ADD));
     }
 
     void PlaintextEval::sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        zip_with_inplace(ct1.raw_pt, ct2.raw_pt, minus<>());
-        update_max_log_plain_val(ct1);
+        update_max_log_plain_val(zip_with_inplace(ct1, ct2, SLOT_SUB));
     }
 
     void PlaintextEval::sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        for (auto &coeff : ct.raw_pt) {
-            coeff -= scalar;
-        }
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(map_inplace(ct, scalar, SLOT_SUB));
     }
 
     void PlaintextEval::sub_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        zip_with_inplace(ct.raw_pt, plain, minus<>());
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(zip_with_inplace(ct, plain, SLOT_SUB));
     }
 
     void PlaintextEval::multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        zip_with_inplace(ct1.raw_pt, ct2.raw_pt, multiplies<>());
-        update_max_log_plain_val(ct1);
+        update_max_log_plain_val(zip_with_inplace(ct1, ct2, SLOT_MUL));
     }
 
     void PlaintextEval::multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        for (auto &coeff : ct.raw_pt) {
-            coeff *= scalar;
-        }
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(map_inplace(ct, scalar, SLOT_MUL));
     }
 
     void PlaintextEval::multiply_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        zip_with_inplace(ct.raw_pt, plain, multiplies<>());
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(zip_with_inplace(ct, plain, SLOT_MUL));
     }
 
     void PlaintextEval::square_inplace_internal(CKKSCiphertext &ct) {
-        zip_with_inplace(ct.raw_pt, ct.raw_pt, multiplies<>());
-        update_max_log_plain_val(ct);
+        update_max_log_plain_val(zip_with_inplace(ct, ct, SLOT_MUL));
     }
 
     double PlaintextEval::get_exact_max_log_plain_val() const {
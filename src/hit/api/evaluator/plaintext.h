@@ -3,13 +3,20 @@
 
 #pragma once
 
+#include <functional>
+
 #include "../ciphertext.h"
 #include "../evaluator.h"
 #include "seal/context.h"
 #include "seal/seal.h"
 
 namespace hit {
-    /* This evaluator tracks the plaintext computation */
+    /* This evaluator tracks the plaintext computation.
+     * In batched mode, each ciphertext holds `num_samples` independent plaintexts, so that one
+     * pass over a circuit evaluates it on many inputs at once. The samples are stored one after
+     * another in a single array of num_samples*num_slots values, and every operation is applied
+     * to the slots of each sample, in parallel across samples.
+     */
     class PlaintextEval : public CKKSEvaluator {
        public:
         /* The number of slots is a proxy for the dimension of the underlying cyclotomic ring.
@@ -18,8 +25,11 @@ namespace hit {
          * corresponding limit on the scale, and thus the precision, of the computation.
          * There's no good way to know what value to use here without generating some parameters
          * first. Reasonable values include 4096, 8192, or 16384.
+         * `num_samples` is the number of plaintexts held by each ciphertext.
+         * `galois_steps` are the rotations which the homomorphic computation has keys for, as for HomomorphicEval.
          */
-        explicit PlaintextEval(int num_slots);
+        explicit PlaintextEval(int num_slots, int num_samples = 1,
+                               const std::vector<int> &galois_steps = std::vector<int>());
 
         /* For documentation on the API, see ../evaluator.h */
         ~PlaintextEval() override = default;
@@ -33,9 +43,18 @@ namespace hit {
         // This is useful for putting an upper bound on the scale parameter.
         double get_exact_max_log_plain_val() const;
 
+        // In batched mode, `coeffs` is used for every sample.
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
 
+        // Encrypt a different plaintext for each sample. `samples` must contain `num_samples` vectors.
+        // The plaintext of the output is the concatenation of the samples.
+        CKKSCiphertext encrypt_batch(const std::vector<std::vector<double>> &samples);
+
+        int num_samples() const;
+
+        bool has_rotation_key(int steps) const override;
+
        protected:
         void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
@@ -67,8 +86,40 @@ namespace hit {
 
        private:
         const int num_slots_ = 0;
+        // see `has_rotation_key`
+        const std::vector<int> galois_steps_;
+        const int num_samples_ = 1;
+
+        // The plaintext of a ciphertext encrypting `coeffs` in every sample
+        std::vector<double> batch_coeffs(const std::vector<double> &coeffs) const;
+        // The plaintext of a ciphertext encrypting `samples`
+        std::vector<double> batch_coeffs(const std::vector<std::vector<double>> &samples) const;
+
+        // Evaluate `body(i)` for each sample i, in parallel if there is more than one sample
+        void for_each_sample(const std::function<void(int)> &body) const;
+
+        // The l_inf norm of each sample in `pt`
+        std::vector<double> sample_l_inf_norms(const std::vector<double> &pt) const;
+
+        // An elementwise operation on slots
+        enum SlotOp { SLOT_ADD, SLOT_SUB, SLOT_MUL };
+
+        /* These apply `op` to each slot of `ct` (or `ct1`) and the corresponding slot of the other
+         * argument, in place, and output the l_inf norm of each sample of the result. The operation
+         * and the norm are computed in a single pass over the slots. Operands may have different
+         * pending rotations (see CKKSCiphertext::pt_rotation_); the result keeps the rotation of
+         * `ct` (or `ct1`), so no operand is ever rotated in memory.
+         */
+        std::vector<double> zip_with_inplace(CKKSCiphertext &ct1, const CKKSCiphertext &ct2, SlotOp op) const;
+        std::vector<double> zip_with_inplace(CKKSCiphertext &ct, const std::vector<double> &plain, SlotOp op) const;
+        std::vector<double> map_inplace(CKKSCiphertext &ct, double scalar, SlotOp op) const;
+
+        // apply `op` to the slots of `dst`, which has rotation `dst_rotation`, and `src`, which has
+        // rotation `src_rotation` and holds either one sample per sample of `dst` or a single sample
+        std::vector<double> zip_with_inplace(std::vector<double> &dst, int dst_rotation, const std::vector<double> &src,
+                                             int src_rotation, SlotOp op) const;
 
-        void update_max_log_plain_val(const CKKSCiphertext &ct);
+        void update_max_log_plain_val(const std::vector<double> &norms);
 
         void print_stats(const CKKSCiphertext &ct) const override;
 
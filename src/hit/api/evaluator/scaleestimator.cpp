@@ -5,6 +5,7 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
 #include <iomanip>
 
 #include "../../common.h"
@@ -20,43 +21,13 @@ namespace hit {
     // encoding/decoding, this should be set to as high as possible.
     int defaultScaleBits = 30;
 
-    ScaleEstimator::ScaleEstimator(int num_slots, int multiplicative_depth)
-        : log_scale_(defaultScaleBits), num_slots_(num_slots) {
-        plaintext_eval = new PlaintextEval(num_slots);
-
-        if (!is_pow2(num_slots) || num_slots < 4096) {
-            LOG_AND_THROW_STREAM("Invalid parameters when creating HomomorphicEval instance: "
-                                 << "num_slots must be a power of 2, and at least 4096. Got " << num_slots);
-        }
+    ScaleEstimator::ScaleEstimator(int num_slots, int multiplicative_depth, int num_samples,
+                                   const vector<int> &galois_steps)
+        : log_scale_(defaultScaleBits), num_slots_(num_slots), galois_steps_(galois_steps), num_samples_(num_samples) {
+        plaintext_eval = new PlaintextEval(num_slots, num_samples);
 
-        int num_primes = multiplicative_depth + 2;
-        vector<int> modulusVector = gen_modulus_vec(num_primes, log_scale_);
-
-        int modBits = 0;
-        for (const auto &bits : modulusVector) {
-            modBits += bits;
-        }
-        int min_poly_degree = modulus_to_poly_degree(modBits);
-        int poly_modulus_degree = num_slots * 2;
-        if (poly_modulus_degree < min_poly_degree) {
-            LOG_AND_THROW_STREAM("Invalid parameters when creating ScaleEstimator instance: "
-                                 << "Parameters for depth " << multiplicative_depth << " circuits and scale "
-                                 << log_scale_ << " bits require more than " << num_slots << " plaintext slots.");
-        }
-
-        EncryptionParameters params = EncryptionParameters(scheme_type::ckks);
-        params.set_poly_modulus_degree(poly_modulus_degree);
-        params.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, modulusVector));
-
-        // for large parameter sets, see https://github.com/microsoft/SEAL/issues/84
-        context = make_unique<SEALContext>(params, true, sec_level_type::none);
-
-        // if scale is too close to 60, SEAL throws the error "encoded values are too large" during encoding.
-        estimated_max_log_scale_ = PLAINTEXT_LOG_MAX - 60;
-        auto context_data = context->first_context_data();
-        for (const auto &prime : context_data->parms().coeff_modulus()) {
-            estimated_max_log_scale_ += log2(prime.value());
-        }
+        context = make_estimator_context(num_slots, multiplicative_depth, log_scale_, "ScaleEstimator");
+        estimated_max_log_scales_ = vector<double>(num_samples_, initial_max_log_scale(context));
     }
 
     ScaleEstimator::ScaleEstimator(int num_slots, const HomomorphicEval &homom_eval)
@@ -65,13 +36,7 @@ namespace hit {
 
         // instead of creating a new instance, use the instance provided
         context = homom_eval.context;
-
-        // if scale is too close to 60, SEAL throws the error "encoded values are too large" during encoding.
-        estimated_max_log_scale_ = PLAINTEXT_LOG_MAX - 60;
-        auto context_data = context->first_context_data();
-        for (const auto &prime : context_data->parms().coeff_modulus()) {
-            estimated_max_log_scale_ += log2(prime.value());
-        }
+        estimated_max_log_scales_ = vector<double>(num_samples_, initial_max_log_scale(context));
     }
 
     ScaleEstimator::~ScaleEstimator() {
@@ -83,15 +48,19 @@ namespace hit {
     }
 
     CKKSCiphertext ScaleEstimator::encrypt(const vector<double> &coeffs, int level) {
-        update_plaintext_max_val(coeffs);
-
-        if (coeffs.size() != num_slots_) {
-            // bad things can happen if you don't plan for your input to be smaller than the ciphertext
-            // This forces the caller to ensure that the input has the correct size or is at least appropriately padded
-            LOG_AND_THROW_STREAM("You can only encrypt vectors which have exactly as many "
-                                 << " coefficients as the number of plaintext slots: Expected " << num_slots_
-                                 << " coefficients, but " << coeffs.size() << " were provided");
-        }
+        return encrypt_internal(plaintext_eval->batch_coeffs(coeffs), level);
+    }
+
+    CKKSCiphertext ScaleEstimator::encrypt_batch(const vector<vector<double>> &samples) {
+        return encrypt_batch(samples, -1);
+    }
+
+    CKKSCiphertext ScaleEstimator::encrypt_batch(const vector<vector<double>> &samples, int level) {
+        return encrypt_internal(plaintext_eval->batch_coeffs(samples), level);
+    }
+
+    CKKSCiphertext ScaleEstimator::encrypt_internal(vector<double> &&batch, int level) {
+        update_plaintext_max_val(batch);
 
         if (level == -1) {
             level = context->first_context_data()->chain_index();
@@ -108,7 +77,7 @@ namespace hit {
         CKKSCiphertext destination;
         destination.he_level_ = level;
         destination.scale_ = scale;
-        destination.raw_pt = coeffs;
+        destination.raw_pt.overwrite() = move(batch);
         destination.num_slots_ = num_slots_;
         destination.initialized = true;
 
@@ -123,9 +92,18 @@ namespace hit {
         return num_slots_;
     }
 
+    bool ScaleEstimator::has_rotation_key(int steps) const {
+        return has_galois_key(galois_steps_, steps, num_slots_);
+    }
+
+    int ScaleEstimator::num_samples() const {
+        return num_samples_;
+    }
+
     // print some debug info
     void ScaleEstimator::print_stats(const CKKSCiphertext &ct) const {
-        double exact_plaintext_max_val = l_inf_norm(ct.raw_pt);
+        vector<double> norms = plaintext_eval->sample_l_inf_norms(ct.raw_pt.get());
+        double exact_plaintext_max_val = *max_element(norms.begin(), norms.end());
         double log_modulus = 0;
         auto context_data = get_context_data(context, ct.he_level());
         for (const auto &prime : context_data->parms().coeff_modulus()) {
@@ -148,25 +126,21 @@ namespace hit {
     // Else [i < ct.he_level]:
     //      In this case, the constraint becomes estimated_max_log_scale_ > (something less than 0).
     //      this is bogus, so nothing to do.
+    // In batched mode, the constraint is applied to each sample separately.
     void ScaleEstimator::update_max_log_scale(const CKKSCiphertext &ct) {
-        // update the estimated_max_log_scale_
-        auto scale_exp = static_cast<int>(round(log2(ct.scale()) / log2(pow(2, log_scale_))));
-        if (scale_exp != 1 && scale_exp != 2) {
-            LOG_AND_THROW_STREAM("Internal error: scale_exp is not 1 or 2: got "
-                                 << scale_exp << ". "
-                                 << "HIT ciphertext scale is " << log2(ct.scale()) << " bits, and nominal scale is "
-                                 << log_scale_ << " bits");
+        update_max_log_scale(ct, plaintext_eval->sample_l_inf_norms(ct.raw_pt.get()));
+    }
+
+    void ScaleEstimator::update_max_log_scale(const CKKSCiphertext &ct, const vector<double> &norms) {
+        // update the estimated_max_log_scales_
+        int scale_exp = scale_exponent(ct, log_scale_);
+        vector<double> bounds(num_samples_);
+        for (int i = 0; i < num_samples_; i++) {
+            bounds[i] = max_log_scale_bound(scale_exp, ct.he_level(), log2(norms[i]));
         }
-        if (scale_exp > ct.he_level()) {
-            auto estimated_scale = (PLAINTEXT_LOG_MAX - log2(l_inf_norm(ct.raw_pt))) / (scale_exp - ct.he_level());
-            {
-                scoped_lock lock(mutex_);
-                estimated_max_log_scale_ = min(estimated_max_log_scale_, estimated_scale);
-            }
-        } else if (scale_exp == ct.he_level() && log2(l_inf_norm(ct.raw_pt)) > PLAINTEXT_LOG_MAX) {
-            LOG_AND_THROW_STREAM("The maximum value in the plaintext is "
-                                 << log2(l_inf_norm(ct.raw_pt)) << " bits which exceeds SEAL's capacity of "
-                                 << PLAINTEXT_LOG_MAX << " bits. Overflow is imminent.");
+        scoped_lock lock(mutex_);
+        for (int i = 0; i < num_samples_; i++) {
+            estimated_max_log_scales_[i] = min(estimated_max_log_scales_[i], bounds[i]);
         }
     }
 
@@ -183,60 +157,50 @@ namespace hit {
     }
 
     void ScaleEstimator::add_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        plaintext_eval->add_inplace_internal(ct1, ct2);
-        update_max_log_scale(ct1);
+        update_max_log_scale(ct1, plaintext_eval->zip_with_inplace(ct1, ct2, PlaintextEval::SLOT_ADD));
     }
 
     void ScaleEstimator::add_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        plaintext_eval->add_plain_inplace_internal(ct, scalar);
-        update_max_log_scale(ct);
+        update_max_log_scale(ct, plaintext_eval->map_inplace(ct, scalar, PlaintextEval::SLOT_ADD));
     }
 
     void ScaleEstimator::add_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        plaintext_eval->add_plain_inplace_internal(ct, plain);
-        update_max_log_scale(ct);
+        update_max_log_scale(ct, plaintext_eval->zip_with_inplace(ct, plain, PlaintextEval::SLOT_ADD));
     }
 
     void ScaleEstimator::sub_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        plaintext_eval->sub_inplace_internal(ct1, ct2);
-        update_max_log_scale(ct1);
+        update_max_log_scale(ct1, plaintext_eval->zip_with_inplace(ct1, ct2, PlaintextEval::SLOT_SUB));
     }
 
     void ScaleEstimator::sub_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        plaintext_eval->sub_plain_inplace_internal(ct, scalar);
-        update_max_log_scale(ct);
+        update_max_log_scale(ct, plaintext_eval->map_inplace(ct, scalar, PlaintextEval::SLOT_SUB));
     }
 
     void ScaleEstimator::sub_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        plaintext_eval->sub_plain_inplace_internal(ct, plain);
-        update_max_log_scale(ct);
+        update_max_log_scale(ct, plaintext_eval->zip_with_inplace(ct, plain, PlaintextEval::SLOT_SUB));
     }
 
-    void ScaleEstimator::temp_square_scale(CKKSCiphertext &ct) {
+    void ScaleEstimator::temp_square_scale(CKKSCiphertext &ct, const vector<double> &norms) {
         double input_scale = ct.scale();
         ct.scale_ *= ct.scale();
-        update_max_log_scale(ct);
+        update_max_log_scale(ct, norms);
         ct.scale_ = input_scale;
     }
 
     void ScaleEstimator::multiply_inplace_internal(CKKSCiphertext &ct1, const CKKSCiphertext &ct2) {
-        plaintext_eval->multiply_inplace_internal(ct1, ct2);
-        temp_square_scale(ct1);
+        temp_square_scale(ct1, plaintext_eval->zip_with_inplace(ct1, ct2, PlaintextEval::SLOT_MUL));
     }
 
     void ScaleEstimator::multiply_plain_inplace_internal(CKKSCiphertext &ct, double scalar) {
-        plaintext_eval->multiply_plain_inplace_internal(ct, scalar);
-        temp_square_scale(ct);
+        temp_square_scale(ct, plaintext_eval->map_inplace(ct, scalar, PlaintextEval::SLOT_MUL));
     }
 
     void ScaleEstimator::multiply_plain_inplace_internal(CKKSCiphertext &ct, const vector<double> &plain) {
-        plaintext_eval->multiply_plain_inplace_internal(ct, plain);
-        temp_square_scale(ct);
+        temp_square_scale(ct, plaintext_eval->zip_with_inplace(ct, plain, PlaintextEval::SLOT_MUL));
     }
 
     void ScaleEstimator::square_inplace_internal(CKKSCiphertext &ct) {
-        plaintext_eval->square_inplace_internal(ct);
-        temp_square_scale(ct);
+        temp_square_scale(ct, plaintext_eval->zip_with_inplace(ct, ct, PlaintextEval::SLOT_MUL));
     }
 
     void ScaleEstimator::reduce_level_to_inplace_internal(CKKSCiphertext &ct, int level) {
@@ -273,40 +237,53 @@ namespace hit {
         ct.scale_ = input_scale;
     }
 
-    void ScaleEstimator::update_plaintext_max_val(const vector<double> &coeffs) {
-        double x = l_inf_norm(coeffs);
+    void ScaleEstimator::update_plaintext_max_val(const vector<double> &batch) {
         // account for a freshly-encrypted ciphertext
         // if this is a depth-0 computation *AND* the parameters are such that it is a no-op,
         // this is the only way we can account for the values in the input. We have to encrypt them,
         // and if the scale is ~2^60, encoding will (rightly) fail
         int top_he_level = context->first_context_data()->chain_index();
         if (top_he_level == 0) {
+            vector<double> norms = plaintext_eval->sample_l_inf_norms(batch);
             scoped_lock lock(mutex_);
-            estimated_max_log_scale_ = min(estimated_max_log_scale_, PLAINTEXT_LOG_MAX - log2(x));
+            for (int i = 0; i < num_samples_; i++) {
+                estimated_max_log_scales_[i] = min(estimated_max_log_scales_[i], PLAINTEXT_LOG_MAX - log2(norms[i]));
+            }
         }
     }
 
     double ScaleEstimator::get_estimated_max_log_scale() const {
+        vector<double> estimates = get_estimated_max_log_scales();
+        return *min_element(estimates.begin(), estimates.end());
+    }
+
+    vector<double> ScaleEstimator::get_estimated_max_log_scales() const {
         /* During the evaluation, update_max_log_scale computed the maximum scale
          * implied by the "correctness" constraint (to prevent the computation
          * from overflowing). But there is another constraint: SEAL limits the
-         * maximum size of the modulus (in bits) based on the poly_modulus_degree.
-         * We take that constraint into account when reporting the maximum log(scale).
-         *
-         * Specifically, a SEAL modulus is the product of k primes p_i, where
-         * log2(p_1)=log2(p_k)=60 and log2(p_i)=s=log(scale). Thus s must be less
-         * than (maxModBits-120)/(k-2)
+         * maximum size of the modulus; see `modulus_max_log_scale`.
          */
-        int max_mod_bits = poly_degree_to_max_mod_bits(2 * num_slots_);
-        auto estimated_log_scale = static_cast<double>(PLAINTEXT_LOG_MAX);
+        double max_log_scale = modulus_max_log_scale(context, num_slots_);
+
+        vector<double> estimates;
         {
             shared_lock lock(mutex_);
-            estimated_log_scale = min(estimated_log_scale, estimated_max_log_scale_);
+            estimates = estimated_max_log_scales_;
         }
-        int top_he_level = context->first_context_data()->chain_index();
-        if (top_he_level > 0) {
-            return min(estimated_log_scale, (max_mod_bits - 120) / static_cast<double>(top_he_level));
+        for (auto &estimate : estimates) {
+            estimate = min(estimate, max_log_scale);
+        }
+        return estimates;
+    }
+
+    double ScaleEstimator::get_estimated_max_log_scale_percentile(double percentile) const {
+        if (percentile < 0 || percentile > 100) {
+            LOG_AND_THROW_STREAM("Percentile must be between 0 and 100; got " << percentile);
         }
-        return estimated_log_scale;
+        vector<double> estimates = get_estimated_max_log_scales();
+        sort(estimates.begin(), estimates.end());
+        // nearest-rank percentile
+        auto rank = static_cast<size_t>(ceil(percentile / 100 * estimates.size()));
+        return estimates[max(rank, static_cast<size_t>(1)) - 1];
     }
 }  // namespace hit
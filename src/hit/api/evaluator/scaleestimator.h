@@ -16,6 +16,9 @@ namespace hit {
     /* This evaluator estimates the optimal CKKS scale to use for a computation.
      * Along the way, it tracks the scale of ciphertexts as well as their
      * theoretical maximum value.
+     * In batched mode, each ciphertext holds `num_samples` plaintexts (see PlaintextEval), so a
+     * single evaluation of the circuit estimates the scale for many representative inputs, and
+     * the estimate is available for each sample as well as for the batch as a whole.
      */
     class ScaleEstimator : public CKKSEvaluator {
        public:
@@ -27,8 +30,11 @@ namespace hit {
          * first. Reasonable values include 4096, 8192, or 16384.
          * `multiplicative_depth` is the multiplicative depth of the circuit you wish to evaluate.
          * You can use the DepthFinder evaluator to compute this.
+         * `num_samples` is the number of inputs evaluated at once in batched mode.
+         * `galois_steps` are the rotations which the homomorphic computation has keys for, as for HomomorphicEval.
          */
-        ScaleEstimator(int num_slots, int multiplicative_depth);
+        ScaleEstimator(int num_slots, int multiplicative_depth, int num_samples = 1,
+                       const std::vector<int> &galois_steps = std::vector<int>());
 
         /* For documentation on the API, see ../evaluator.h */
         ~ScaleEstimator() override;
@@ -42,15 +48,33 @@ namespace hit {
         // computation. Using a scale larger than this will result in the plaintext
         // exceeding SEAL's maximum size, and using a scale smaller than this value
         // will unnecessarily reduce precision of the computation.
+        // In batched mode, this is the largest scale which can be used for every sample.
         double get_estimated_max_log_scale() const;
 
+        // The maximum log scale for each sample, i.e., what `get_estimated_max_log_scale`
+        // would report if the circuit were evaluated on that sample alone.
+        std::vector<double> get_estimated_max_log_scales() const;
+
+        // The given percentile (between 0 and 100) of the per-sample maximum log scales.
+        // The 0th percentile is the output of `get_estimated_max_log_scale`.
+        double get_estimated_max_log_scale_percentile(double percentile) const;
+
+        // In batched mode, `coeffs` is used for every sample.
         CKKSCiphertext encrypt(const std::vector<double> &coeffs) override;
         CKKSCiphertext encrypt(const std::vector<double> &coeffs, int level) override;
 
+        // Encrypt a different plaintext for each sample. `samples` must contain `num_samples` vectors.
+        CKKSCiphertext encrypt_batch(const std::vector<std::vector<double>> &samples);
+        CKKSCiphertext encrypt_batch(const std::vector<std::vector<double>> &samples, int level);
+
+        int num_samples() const;
+
         std::shared_ptr<seal::SEALContext> context;
 
         int num_slots() const override;
 
+        bool has_rotation_key(int steps) const override;
+
        protected:
         void rotate_right_inplace_internal(CKKSCiphertext &ct, int steps) override;
 
@@ -85,25 +109,35 @@ namespace hit {
        private:
         const int log_scale_ = 0;
         const int num_slots_ = 0;
+        // see `has_rotation_key`
+        const std::vector<int> galois_steps_;
+        const int num_samples_ = 1;
         ScaleEstimator(int num_slots, const HomomorphicEval &homom_eval);
         bool has_shared_params_ = false;
 
         PlaintextEval *plaintext_eval;
 
-        double estimated_max_log_scale_;
+        // the estimated maximum log scale for each sample
+        std::vector<double> estimated_max_log_scales_;
+
+        // Encrypt the plaintext `batch`, which holds every sample
+        CKKSCiphertext encrypt_internal(std::vector<double> &&batch, int level);
 
         // This helper function squares the scale of the input and then updates
-        // the max_log_scale.
-        void temp_square_scale(CKKSCiphertext &ct);
+        // the max_log_scale. `norms` is the l_inf norm of each sample of `ct`.
+        void temp_square_scale(CKKSCiphertext &ct, const std::vector<double> &norms);
         void print_stats(const CKKSCiphertext &ct) const override;
         void update_max_log_scale(const CKKSCiphertext &ct);
+        // as above, where `norms` is the l_inf norm of each sample of `ct`
+        void update_max_log_scale(const CKKSCiphertext &ct, const std::vector<double> &norms);
 
         uint64_t get_last_prime_internal(const CKKSCiphertext &ct) const override;
 
         // primarily used to indicate the maximum value for each *input* to the function.
         // For circuits which are a no-op, this function is the only way the evaluator
         // can learn the maximum plaintext values, and thereby appropriately restrict the scale.
-        void update_plaintext_max_val(const std::vector<double> &coeffs);
+        // `batch` holds a plaintext for each sample.
+        void update_plaintext_max_val(const std::vector<double> &batch);
 
         friend class DebugEval;
     };
@@ -12,8 +12,8 @@ using namespace std;
 using namespace seal;
 
 namespace hit {
-    EncryptedColVector::EncryptedColVector(int height, const EncodingUnit &unit, vector<CKKSCiphertext> &cts)
-        : height_(height), unit(unit), cts(cts) {
+    EncryptedColVector::EncryptedColVector(int height, const EncodingUnit &unit, vector<CKKSCiphertext> cts)
+        : height_(height), unit(unit), cts(move(cts)) {
         validate();
     }
 
@@ -79,7 +79,7 @@ namespace hit {
         void read_from_proto(const std::shared_ptr<seal::SEALContext> &context,
                              const protobuf::EncryptedColVector &encrypted_col_vector);
 
-        EncryptedColVector(int height, const EncodingUnit &unit, std::vector<CKKSCiphertext> &cts);
+        EncryptedColVector(int height, const EncodingUnit &unit, std::vector<CKKSCiphertext> cts);
 
         void validate() const;
 
@@ -7,14 +7,36 @@
 
 #include <algorithm>
 #include <execution>
+#include <iterator>
 
 using namespace std;
 using namespace seal;
 
 namespace hit {
     EncryptedMatrix::EncryptedMatrix(int height, int width, const EncodingUnit &unit,
-                                     const vector<vector<CKKSCiphertext>> &cts)
-        : height_(height), width_(width), unit(unit), cts(move(cts)) {
+                                     vector<vector<CKKSCiphertext>> grid, MatrixLayout layout)
+        : height_(height), width_(width), unit(unit), layout_(layout) {
+        num_horizontal_units_ = grid.empty() ? 0 : grid[0].size();
+        cts.reserve(grid.size() * num_horizontal_units_);
+        for (auto &grid_row : grid) {
+            if (grid_row.size() != num_horizontal_units_) {
+                LOG_AND_THROW_STREAM("Invalid ciphertexts in EncryptedMatrix: "
+                                     << "Each horizontal row should have " << num_horizontal_units_
+                                     << " units, but a row has " << grid_row.size() << " horizontal units. ");
+            }
+            move(grid_row.begin(), grid_row.end(), back_inserter(cts));
+        }
+        validate();
+    }
+
+    EncryptedMatrix::EncryptedMatrix(int height, int width, const EncodingUnit &unit, int num_horizontal_units,
+                                     vector<CKKSCiphertext> cts, MatrixLayout layout)
+        : height_(height),
+          width_(width),
+          unit(unit),
+          layout_(layout),
+          cts(move(cts)),
+          num_horizontal_units_(num_horizontal_units) {
         validate();
     }
 
@@ -24,14 +46,26 @@ namespace hit {
         width_ = encrypted_matrix.width();
         unit = EncodingUnit(encrypted_matrix.unit());
 
-        cts.reserve(encrypted_matrix.cts_size());
+        // rows of the grid are serialized separately, but are stored contiguously
+        num_horizontal_units_ = encrypted_matrix.cts_size() == 0 ? 0 : encrypted_matrix.cts(0).cts_size();
+        cts.reserve(encrypted_matrix.cts_size() * num_horizontal_units_);
         for (int i = 0; i < encrypted_matrix.cts_size(); i++) {
             const protobuf::CiphertextVector &proto_ciphertext_vector = encrypted_matrix.cts(i);
-            vector<CKKSCiphertext> ciphertext_vector;
-            ciphertext_vector.reserve(proto_ciphertext_vector.cts_size());
-            deserialize_vector(context, proto_ciphertext_vector, ciphertext_vector);
-            cts.push_back(ciphertext_vector);
+            if (proto_ciphertext_vector.cts_size() != num_horizontal_units_) {
+                LOG_AND_THROW_STREAM("Invalid ciphertexts in EncryptedMatrix: "
+                                     << "Each horizontal row should have " << num_horizontal_units_
+                                     << " units, but a row has " << proto_ciphertext_vector.cts_size()
+                                     << " horizontal units. ");
+            }
+            deserialize_vector(context, proto_ciphertext_vector, cts);
         }
+
+        // older serializations do not include zero-unit metadata
+        if (encrypted_matrix.zero_units_size() > 0) {
+            zero_units = vector<bool>(encrypted_matrix.zero_units().begin(), encrypted_matrix.zero_units().end());
+        }
+        zero_padded = encrypted_matrix.zero_padded();
+        layout_ = encrypted_matrix.layout() == protobuf::EncryptedMatrix::DIAGONAL ? LAYOUT_DIAGONAL : LAYOUT_ROW_MAJOR;
         validate();
     }
 
@@ -51,9 +85,18 @@ namespace hit {
         encrypted_matrix->set_height(height_);
         encrypted_matrix->set_width(width_);
         encrypted_matrix->set_allocated_unit(unit.serialize());
-        for (const auto &ciphertext_vector : cts) {
+        for (int i = 0; i < num_vertical_units(); i++) {
+            // copying the row is cheap, since ciphertexts share storage with their copies
+            vector<CKKSCiphertext> ciphertext_vector(cts.begin() + unit_index(i, 0),
+                                                     cts.begin() + unit_index(i + 1, 0));
             encrypted_matrix->mutable_cts()->AddAllocated(serialize_vector(ciphertext_vector));
         }
+        for (bool is_zero : zero_units) {
+            encrypted_matrix->add_zero_units(is_zero);
+        }
+        encrypted_matrix->set_zero_padded(zero_padded);
+        encrypted_matrix->set_layout(layout_ == LAYOUT_DIAGONAL ? protobuf::EncryptedMatrix::DIAGONAL
+                                                                : protobuf::EncryptedMatrix::ROW_MAJOR);
         return encrypted_matrix;
     }
 
@@ -76,47 +119,65 @@ namespace hit {
     }
 
     int EncryptedMatrix::num_vertical_units() const {
-        return cts.size();
+        return num_horizontal_units_ == 0 ? 0 : cts.size() / num_horizontal_units_;
     }
 
     int EncryptedMatrix::num_horizontal_units() const {
-        return cts[0].size();
+        return num_horizontal_units_;
+    }
+
+    MatrixLayout EncryptedMatrix::layout() const {
+        return layout_;
     }
 
     int EncryptedMatrix::num_slots() const {
-        return cts[0][0].num_slots();
+        return cts[0].num_slots();
     }
 
     int EncryptedMatrix::he_level() const {
         // assumes that cts is non-empty and that we enforce all cts must have the same level
-        return cts[0][0].he_level();
+        return cts[0].he_level();
     }
 
     double EncryptedMatrix::scale() const {
         // assumes that cts is non-empty and that we enforce all cts must have the same scale
-        return cts[0][0].scale();
+        return cts[0].scale();
     }
 
     bool EncryptedMatrix::needs_rescale() const {
-        return cts[0][0].needs_rescale();
+        return cts[0].needs_rescale();
     }
 
     bool EncryptedMatrix::needs_relin() const {
-        return cts[0][0].needs_relin();
+        // known-zero units are always linear, so find a unit which is not known to be zero
+        for (size_t i = 0; i < num_cts(); i++) {
+            if (!is_zero_ct(i)) {
+                return (*this)[i].needs_relin();
+            }
+        }
+        return cts[0].needs_relin();
+    }
+
+    bool EncryptedMatrix::is_zero_unit(int i, int j) const {
+        return is_zero_ct(unit_index(i, j));
+    }
+
+    bool EncryptedMatrix::is_zero_padded() const {
+        return zero_padded;
     }
 
     Matrix EncryptedMatrix::plaintext() const {
-        vector<vector<Matrix>> plaintext_pieces(cts.size());
+        vector<vector<Matrix>> plaintext_pieces(num_vertical_units());
 
-        for (int i = 0; i < cts.size(); i++) {
-            vector<Matrix> plaintext_row(cts[0].size());
-            for (int j = 0; j < cts[0].size(); j++) {
+        for (int i = 0; i < num_vertical_units(); i++) {
+            vector<Matrix> plaintext_row(num_horizontal_units());
+            for (int j = 0; j < num_horizontal_units(); j++) {
                 // The CKKSCiphertext plaintext is just a list of coefficients.
                 // We know that it has additional meaning here: it's really a matrix
                 // with the dimensions of the encoding unit.
                 // To decode and recover the underlying plaintext matrix, we must first
                 // add this additional context.
-                Vector raw_plaintext = cts[i][j].plaintext();
+                Vector raw_plaintext = unit_ct(i, j).plaintext();
                 if (raw_plaintext.size() != unit.encoding_height() * unit.encoding_width()) {
                     LOG_AND_THROW_STREAM("Internal error: plaintext has "
                                          << raw_plaintext.size() << " coefficients, expected "
@@ -130,6 +191,9 @@ namespace hit {
             plaintext_pieces[i] = plaintext_row;
         }
 
+        if (layout_ == LAYOUT_DIAGONAL) {
+            return decode_diagonals(plaintext_pieces, height_, width_);
+        }
         return decode_matrix(plaintext_pieces, height_, width_);
     }
 
@@ -146,58 +210,82 @@ namespace hit {
                                  << "width must be non-negative, got " << width_);
         }
 
-        if (cts.size() != ceil(height_ / static_cast<double>(unit.encoding_height()))) {
+        // in the diagonal layout, the matrix is tiled with n-by-n blocks, each of which has n diagonals
+        int block_height = layout_ == LAYOUT_DIAGONAL ? unit.encoding_width() : unit.encoding_height();
+        int cts_per_block = layout_ == LAYOUT_DIAGONAL ? unit.encoding_width() : 1;
+        int expected_vertical_units = ceil(height_ / static_cast<double>(block_height));
+        int expected_horizontal_units = ceil(width_ / static_cast<double>(unit.encoding_width())) * cts_per_block;
+
+        if (num_horizontal_units_ != expected_horizontal_units) {
             LOG_AND_THROW_STREAM("Invalid ciphertexts in EncryptedMatrix: "
-                                 << "Expected " << ceil(height_ / static_cast<double>(unit.encoding_height()))
-                                 << " vertical units, found a " << cts.size() << ". ");
+                                 << "Expected " << expected_horizontal_units << " horizontal units, found a "
+                                 << num_horizontal_units_ << ". ");
         }
 
-        if (cts[0].size() != ceil(width_ / static_cast<double>(unit.encoding_width()))) {
+        if (cts.size() != expected_vertical_units * num_horizontal_units_) {
             LOG_AND_THROW_STREAM("Invalid ciphertexts in EncryptedMatrix: "
-                                 << "Expected " << ceil(width_ / static_cast<double>(unit.encoding_width()))
-                                 << " horizontal units, found a " << cts[0].size() << ". ");
+                                 << "Expected " << expected_vertical_units << " vertical units, found a "
+                                 << cts.size() / num_horizontal_units_ << ". ");
         }
 
-        int row_size = cts[0].size();
-        for (const auto &cts_i : cts) {
-            if (cts_i.size() != row_size) {
-                LOG_AND_THROW_STREAM("Invalid ciphertexts in EncryptedMatrix: "
-                                     << "Each horizontal row should have " << row_size << " units, but a row has "
-                                     << cts_i.size() << " horizontal units. ");
+        if (!zero_units.empty() && zero_units.size() != cts.size()) {
+            LOG_AND_THROW_STREAM("Invalid EncryptedMatrix: "
+                                 << "Zero-unit metadata does not match the number of units.");
+        }
+
+        for (const auto &ct : cts) {
+            if (ct.scale() != cts[0].scale()) {
+                LOG_AND_THROW_STREAM("Invalid EncryptedMatrix: "
+                                     << "Each ciphertext must have the same scale.");
             }
-            for (const auto &ct : cts_i) {
-                if (ct.scale() != cts[0][0].scale()) {
-                    LOG_AND_THROW_STREAM("Invalid EncryptedMatrix: "
-                                         << "Each ciphertext must have the same scale.");
-                }
-                if (ct.he_level() != cts[0][0].he_level()) {
-                    LOG_AND_THROW_STREAM("Invalid EncryptedMatrix: "
-                                         << "Each ciphertext must have the same level.");
-                }
+            if (ct.he_level() != cts[0].he_level()) {
+                LOG_AND_THROW_STREAM("Invalid EncryptedMatrix: "
+                                     << "Each ciphertext must have the same level.");
             }
         }
     }
 
+    size_t EncryptedMatrix::unit_index(int i, int j) const {
+        return static_cast<size_t>(i) * num_horizontal_units_ + j;
+    }
+
+    CKKSCiphertext &EncryptedMatrix::unit_ct(int i, int j) {
+        return cts[unit_index(i, j)];
+    }
+
+    const CKKSCiphertext &EncryptedMatrix::unit_ct(int i, int j) const {
+        return cts[unit_index(i, j)];
+    }
+
     size_t EncryptedMatrix::num_cts() const {
-        return cts.size() * cts[0].size();
+        return cts.size();
     }
 
     CKKSCiphertext &EncryptedMatrix::operator[](size_t idx) {
-        size_t num_cols = cts[0].size();
-        size_t row = idx / num_cols;
-        size_t col = idx % num_cols;
-        return cts[row][col];
+        return cts[idx];
     }
 
     const CKKSCiphertext &EncryptedMatrix::operator[](size_t idx) const {
-        size_t num_cols = cts[0].size();
-        size_t row = idx / num_cols;
-        size_t col = idx % num_cols;
-        return cts[row][col];
+        return cts[idx];
+    }
+
+    bool EncryptedMatrix::is_zero_ct(size_t idx) const {
+        return !zero_units.empty() && zero_units[idx];
+    }
+
+    void EncryptedMatrix::set_zero_ct(size_t idx, bool is_zero) {
+        if (zero_units.empty()) {
+            if (!is_zero) {
+                return;
+            }
+            zero_units = vector<bool>(cts.size(), false);
+        }
+        zero_units[idx] = is_zero;
     }
 
     bool EncryptedMatrix::same_size(const EncryptedMatrix &enc_mat) const {
-        return height_ == enc_mat.height() && width_ == enc_mat.width() && unit == enc_mat.encoding_unit();
+        return height_ == enc_mat.height() && width_ == enc_mat.width() && unit == enc_mat.encoding_unit() &&
+               layout_ == enc_mat.layout();
     }
 
     /*********   CKKS Basics   *********
@@ -221,6 +309,10 @@ namespace hit {
      * work to build "matrix row rotation" out of "array rotation".
      */
 
+    bool is_zero_matrix(const Matrix &mat) {
+        return all_of(mat.data().begin(), mat.data().end(), [](double x) { return x == 0; });
+    }
+
     vector<vector<Matrix>> encode_matrix(const Matrix &mat, const EncodingUnit &unit) {
         int height = mat.size1();
         int width = mat.size2();
@@ -291,4 +383,75 @@ namespace hit {
         }
         return Matrix(trim_height, trim_width, linear_matrix);
     }
+
+    int diagonal_baby_steps(int n) {
+        // the smallest power of two which is at least sqrt(n)
+        int baby_steps = 1;
+        while (baby_steps * baby_steps < n) {
+            baby_steps <<= 1;
+        }
+        return baby_steps;
+    }
+
+    /* For an n-by-n block B, the baby-step/giant-step product B*v with g baby steps is
+     *   sum_{s,b} d_{g*s+b} (.) rot(v, g*s+b) = sum_s rot(sum_b rot(d_{g*s+b}, -g*s) (.) rot(v, b), g*s)
+     * where (.) is the Hadamard product and rot is a left rotation. We store rot(d_{g*s+b}, -g*s)
+     * so that the inner sums only require rotations of v.
+     */
+    vector<vector<Matrix>> encode_diagonals(const Matrix &mat, const EncodingUnit &unit) {
+        int height = mat.size1();
+        int width = mat.size2();
+        int n = unit.encoding_width();
+        int baby_steps = diagonal_baby_steps(n);
+
+        int num_vertical_blocks = ceil(height / static_cast<double>(n));
+        int num_horizontal_blocks = ceil(width / static_cast<double>(n));
+
+        vector<vector<Matrix>> cts(num_vertical_blocks, vector<Matrix>(num_horizontal_blocks * n));
+        for (int i = 0; i < num_vertical_blocks; i++) {
+            for (int j = 0; j < num_horizontal_blocks; j++) {
+                for (int k = 0; k < n; k++) {
+                    int giant_step = (k / baby_steps) * baby_steps;
+                    vector<double> diag_k;
+                    diag_k.reserve(unit.encoding_height() * n);
+                    for (int r = 0; r < unit.encoding_height(); r++) {
+                        for (int c = 0; c < n; c++) {
+                            // slot c of the pre-rotated diagonal holds entry c-g*s of the k^th diagonal
+                            int diag_idx = (c - giant_step + n) % n;
+                            int row = i * n + diag_idx;
+                            int col = j * n + (diag_idx + k) % n;
+                            if (row < height && col < width) {
+                                diag_k.emplace_back(mat.data()[row * width + col]);
+                            } else {
+                                diag_k.emplace_back(0);
+                            }
+                        }
+                    }
+                    cts[i][j * n + k] = Matrix(unit.encoding_height(), n, diag_k);
+                }
+            }
+        }
+        return cts;
+    }
+
+    Matrix decode_diagonals(const vector<vector<Matrix>> &mats, int trim_height, int trim_width) {
+        if (mats.empty() || mats[0].empty()) {
+            LOG_AND_THROW_STREAM("Internal error: input to decode_diagonals cannot be empty");
+        }
+
+        int n = mats[0][0].size2();
+        int baby_steps = diagonal_baby_steps(n);
+
+        Matrix mat(trim_height, trim_width);
+        for (int row = 0; row < trim_height; row++) {
+            for (int col = 0; col < trim_width; col++) {
+                int c = row % n;
+                int k = (col % n - c + n) % n;
+                int giant_step = (k / baby_steps) * baby_steps;
+                // invert the pre-rotation; the diagonal is replicated in every row of the unit, so use the first
+                mat(row, col) = mats[row / n][(col / n) * n + k].data()[(c + giant_step) % n];
+            }
+        }
+        return mat;
+    }
 }  // namespace hit
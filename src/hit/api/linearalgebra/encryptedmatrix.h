@@ -10,6 +10,9 @@
 
 namespace hit {
 
+    // How the entries of a matrix are arranged in the encoding units; see EncryptedMatrix.
+    enum MatrixLayout { LAYOUT_ROW_MAJOR, LAYOUT_DIAGONAL };
+
     /* One or more ciphertexts which encrypts a plaintext matrix.
      * Matrices are divided into plaintexts by tiling the matrix with the encoding unit.
      * If the matrix dimensions do not exactly divide into encoding units, extra space is
@@ -42,6 +45,31 @@ namespace hit {
      *
      * The encoding unit can affect the efficiency of homomorphic operations,
      * but does not affect their multiplicative depth.
+     *
+     * An encrypted matrix can keep track of units which are known to encrypt an all-zero plaintext,
+     * so that LinearAlgebra can skip expensive operations on them. Since these flags are serialized
+     * and change which operations are performed, they reveal which units are zero. They are only
+     * set when the sparsity pattern of the matrix is public: either when the caller says so at
+     * encryption time, or when the zeros follow from the shape of an operation (e.g., the band
+     * outside of a Gram matrix).
+     * A known-zero unit is always a *linear* encryption of zero at the same level and scale as the
+     * other units. Similarly, we track whether the padding around the matrix is known to be zero.
+     * Both are conservative: a unit (or padding) which is not known to be zero may still be zero.
+     *
+     * The tiling above is the default LAYOUT_ROW_MAJOR layout, which is used by almost every
+     * operation in LinearAlgebra. A matrix can instead be encrypted in LAYOUT_DIAGONAL, which
+     * is intended for matrices that are repeatedly multiplied by encrypted vectors. For an
+     * m-by-n encoding unit, the matrix is tiled with n-by-n blocks, and each block is stored
+     * as its n generalized diagonals, i.e., diagonal k of block B is
+     *
+     *   d_k = < B[0][k], B[1][(1+k) % n], ..., B[n-1][(n-1+k) % n] >
+     *
+     * Each diagonal is replicated m times to fill a ciphertext (so that it lines up with an
+     * encrypted column vector), and is pre-rotated to support the baby-step/giant-step
+     * product in LinearAlgebra::multiply_diagonal. In this layout, unit (i, j*n+k) of the grid
+     * holds the k^th diagonal of block (i,j). Only elementwise operations (e.g., add, hadamard_multiply),
+     * multiply_diagonal, and reencode (which converts to the row-major layout) accept matrices in the
+     * diagonal layout.
      */
     struct EncryptedMatrix : CiphertextMetadata<Matrix> {
        public:
@@ -68,7 +96,10 @@ namespace hit {
         // number of encoding units tiled vertically to encode this matrix
         int num_vertical_units() const;
         // number of encoding units tiled horizontally to encode this matrix
+        // (for the diagonal layout, the number of diagonals in each row of blocks)
         int num_horizontal_units() const;
+        // arrangement of the matrix entries in the encoding units
+        MatrixLayout layout() const;
         // encoding unit used to encode this matrix
         EncodingUnit encoding_unit() const;
         // number of plaintext slots in the CKKS parameters
@@ -85,13 +116,21 @@ namespace hit {
         bool needs_relin() const override;
         // Underlying plaintext matrix. This is only available with the Plaintext, Debug, and ScaleEstimator evaluators
         Matrix plaintext() const override;
+        // Output true if the unit in the i^th row and j^th column of the grid of encoding units is
+        // known to encrypt an all-zero plaintext, false otherwise.
+        bool is_zero_unit(int i, int j) const;
+        // Output true if all slots in the encoding units which lie outside of the matrix are known to be zero.
+        bool is_zero_padded() const;
 
        private:
         void read_from_proto(const std::shared_ptr<seal::SEALContext> &context,
                              const protobuf::EncryptedMatrix &encrypted_matrix);
 
         EncryptedMatrix(int height, int width, const EncodingUnit &unit,
-                        const std::vector<std::vector<CKKSCiphertext>> &cts);
+                        std::vector<std::vector<CKKSCiphertext>> grid, MatrixLayout layout = LAYOUT_ROW_MAJOR);
+        // Same as above, but the units are given in the flat, row-major order used by `cts`.
+        EncryptedMatrix(int height, int width, const EncodingUnit &unit, int num_horizontal_units,
+                        std::vector<CKKSCiphertext> cts, MatrixLayout layout = LAYOUT_ROW_MAJOR);
 
         void validate() const;
 
@@ -101,16 +140,34 @@ namespace hit {
         int width_ = 0;
         // encoding unit
         EncodingUnit unit;
-        // two-dimensional grid of encoding units composing this encrypted matrix
-        // First index is the row, second index is the column
-        std::vector<std::vector<CKKSCiphertext>> cts;
+        // arrangement of the matrix entries in the encoding units
+        MatrixLayout layout_ = LAYOUT_ROW_MAJOR;
+        // two-dimensional grid of encoding units composing this encrypted matrix, stored contiguously
+        // in row-major order: the unit in the i^th row and j^th column of the grid is at `unit_index(i, j)`
+        std::vector<CKKSCiphertext> cts;
+        // number of units in each row of the grid, i.e., the stride of `cts`
+        int num_horizontal_units_ = 0;
+        // units which are known to encrypt zero, indexed like `cts`, or empty if no units are known to be zero
+        std::vector<bool> zero_units;
+        // true if the padding outside of the matrix is known to be zero
+        bool zero_padded = false;
 
-        // simple iterator
+        // position in `cts` of the unit in the i^th row and j^th column of the grid
+        size_t unit_index(int i, int j) const;
+        // the unit in the i^th row and j^th column of the grid
+        CKKSCiphertext &unit_ct(int i, int j);
+        const CKKSCiphertext &unit_ct(int i, int j) const;
+
+        // simple iterator, in the same order as `cts`
         size_t num_cts() const;
         CKKSCiphertext &operator[](size_t idx);
         const CKKSCiphertext &operator[](size_t idx) const;
+        // known-zero status of a ciphertext, using the same indexing as operator[]
+        bool is_zero_ct(size_t idx) const;
+        void set_zero_ct(size_t idx, bool is_zero);
 
-        // compare this matrix to another matrix to determine if they have the same size (dimensions and encoding unit)
+        // compare this matrix to another matrix to determine if they have the same size
+        // (dimensions, encoding unit, and layout)
         bool same_size(const EncryptedMatrix &enc_mat) const;
 
         friend class LinearAlgebra;
@@ -119,7 +176,19 @@ namespace hit {
     // Encode a matrix as a sequence of plaintext matrices which encode the matrix
     std::vector<std::vector<Matrix>> encode_matrix(const Matrix &mat, const EncodingUnit &unit);
 
+    // Output true if every entry of the matrix is zero
+    bool is_zero_matrix(const Matrix &mat);
+
     // Decode a matrix given its encoding as a sequence of encoding units
     Matrix decode_matrix(const std::vector<std::vector<Matrix>> &mats, int trim_height = -1, int trim_width = -1);
 
+    // Number of baby steps used by the diagonal layout for an n-by-n block
+    int diagonal_baby_steps(int n);
+
+    // Encode a matrix as the (pre-rotated) generalized diagonals of its blocks
+    std::vector<std::vector<Matrix>> encode_diagonals(const Matrix &mat, const EncodingUnit &unit);
+
+    // Decode a matrix given its encoding as generalized diagonals
+    Matrix decode_diagonals(const std::vector<std::vector<Matrix>> &mats, int trim_height, int trim_width);
+
 }  // namespace hit
@@ -14,8 +14,8 @@ using namespace std;
 using namespace seal;
 
 namespace hit {
-    EncryptedRowVector::EncryptedRowVector(int width, const EncodingUnit &unit, vector<CKKSCiphertext> &cts)
-        : width_(width), unit(unit), cts(cts) {
+    EncryptedRowVector::EncryptedRowVector(int width, const EncodingUnit &unit, vector<CKKSCiphertext> cts)
+        : width_(width), unit(unit), cts(move(cts)) {
         validate();
     }
 
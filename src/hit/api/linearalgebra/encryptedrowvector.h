@@ -95,7 +95,7 @@ namespace hit {
         void read_from_proto(const std::shared_ptr<seal::SEALContext> &context,
                              const protobuf::EncryptedRowVector &encrypted_row_vector);
 
-        EncryptedRowVector(int width, const EncodingUnit &unit, std::vector<CKKSCiphertext> &cts);
+        EncryptedRowVector(int width, const EncodingUnit &unit, std::vector<CKKSCiphertext> cts);
 
         void validate() const;
 
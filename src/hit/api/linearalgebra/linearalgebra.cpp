@@ -5,6 +5,14 @@
 
 #include <glog/logging.h>
 
+#include <execution>
+#include <numeric>
+#include <set>
+#include <thread>
+#include <tuple>
+
+#include "../evaluator/homomorphic.h"
+
 using namespace std;
 
 namespace hit {
@@ -18,17 +26,59 @@ namespace hit {
         return encrypt_col_vector(vec, unit, level);
     }
 
-    EncryptedMatrix LinearAlgebra::encrypt_matrix(const Matrix &mat, const EncodingUnit &unit, int level) {
-        vector<vector<Matrix>> mat_pieces = encode_matrix(mat, unit);
-        vector<vector<CKKSCiphertext>> mat_cts(mat_pieces.size());
-        for (int i = 0; i < mat_pieces.size(); i++) {
-            vector<CKKSCiphertext> row_cts(mat_pieces[0].size());
-            for (int j = 0; j < mat_pieces[0].size(); j++) {
-                row_cts[j] = eval.encrypt(mat_pieces[i][j].data(), level);
+    EncryptedMatrix LinearAlgebra::encrypt_matrix(const Matrix &mat, const EncodingUnit &unit, int level,
+                                                  MatrixLayout layout, bool public_sparsity) {
+        vector<vector<Matrix>> mat_pieces =
+            layout == LAYOUT_DIAGONAL ? encode_diagonals(mat, unit) : encode_matrix(mat, unit);
+        int num_horizontal_units = mat_pieces[0].size();
+        vector<CKKSCiphertext> mat_cts;
+        mat_cts.reserve(mat_pieces.size() * num_horizontal_units);
+        for (const auto &row_pieces : mat_pieces) {
+            for (const auto &piece : row_pieces) {
+                mat_cts.push_back(eval.encrypt(piece.data(), level));
+            }
+        }
+        EncryptedMatrix enc_mat(mat.size1(), mat.size2(), unit, num_horizontal_units, move(mat_cts), layout);
+
+        // Only record which units are zero if the caller declared the sparsity pattern public.
+        // These units are still encrypted so that they are valid inputs to any operation.
+        if (public_sparsity) {
+            for (int i = 0; i < mat_pieces.size(); i++) {
+                for (int j = 0; j < mat_pieces[0].size(); j++) {
+                    if (is_zero_matrix(mat_pieces[i][j])) {
+                        enc_mat.set_zero_ct(enc_mat.unit_index(i, j), true);
+                    }
+                }
             }
-            mat_cts[i] = row_cts;
         }
-        return EncryptedMatrix(mat.size1(), mat.size2(), unit, mat_cts);
+        enc_mat.zero_padded = true;
+        return enc_mat;
+    }
+
+    EncryptedMatrix LinearAlgebra::encrypt_matrix_shape(int height, int width, const EncodingUnit &unit, int level,
+                                                        MatrixLayout layout) {
+        if (height <= 0 || width <= 0) {
+            LOG_AND_THROW_STREAM("Matrix dimensions must be positive, got " << height << "x" << width);
+        }
+        // the same grid of units as `encode_matrix` and `encode_diagonals`
+        int num_vertical_units;
+        int num_horizontal_units;
+        if (layout == LAYOUT_DIAGONAL) {
+            int n = unit.encoding_width();
+            num_vertical_units = ceil(height / static_cast<double>(n));
+            num_horizontal_units = ceil(width / static_cast<double>(n)) * n;
+        } else {
+            num_vertical_units = ceil(height / static_cast<double>(unit.encoding_height()));
+            num_horizontal_units = ceil(width / static_cast<double>(unit.encoding_width()));
+        }
+        vector<CKKSCiphertext> mat_cts;
+        mat_cts.reserve(num_vertical_units * num_horizontal_units);
+        for (int i = 0; i < num_vertical_units * num_horizontal_units; i++) {
+            mat_cts.push_back(eval.encrypt_placeholder(level));
+        }
+        EncryptedMatrix enc_mat(height, width, unit, num_horizontal_units, move(mat_cts), layout);
+        enc_mat.zero_padded = true;
+        return enc_mat;
     }
 
     Matrix LinearAlgebra::decrypt(const EncryptedMatrix &enc_mat, bool suppress_warnings) const {
@@ -39,15 +89,19 @@ namespace hit {
             decryption_warning(enc_mat.he_level());
         }
 
-        vector<vector<Matrix>> mat_pieces(enc_mat.cts.size());
-        for (int i = 0; i < enc_mat.cts.size(); i++) {
-            vector<Matrix> row_pieces(enc_mat.cts[0].size());
-            for (int j = 0; j < enc_mat.cts[0].size(); j++) {
+        vector<vector<Matrix>> mat_pieces(enc_mat.num_vertical_units());
+        for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
+            vector<Matrix> row_pieces(enc_mat.num_horizontal_units());
+            for (int j = 0; j < enc_mat.num_horizontal_units(); j++) {
                 row_pieces[j] = Matrix(enc_mat.encoding_unit().encoding_height(),
-                                       enc_mat.encoding_unit().encoding_width(), eval.decrypt(enc_mat.cts[i][j], true));
+                                       enc_mat.encoding_unit().encoding_width(),
+                                       eval.decrypt(enc_mat.unit_ct(i, j), true));
             }
             mat_pieces[i] = row_pieces;
         }
+        if (enc_mat.layout() == LAYOUT_DIAGONAL) {
+            return decode_diagonals(mat_pieces, enc_mat.height(), enc_mat.width());
+        }
         return decode_matrix(mat_pieces, enc_mat.height(), enc_mat.width());
     }
 
@@ -72,7 +126,20 @@ namespace hit {
         for (int i = 0; i < vec_pieces.size(); i++) {
             vec_cts[i] = eval.encrypt(vec_pieces[i].data(), level);
         }
-        return EncryptedRowVector(vec.size(), unit, vec_cts);
+        return EncryptedRowVector(vec.size(), unit, move(vec_cts));
+    }
+
+    EncryptedRowVector LinearAlgebra::encrypt_row_vector_shape(int width, const EncodingUnit &unit, int level) {
+        if (width <= 0) {
+            LOG_AND_THROW_STREAM("Vector width must be positive, got " << width);
+        }
+        // the same units as `encode_row_vector`
+        int num_units = ceil(width / static_cast<double>(unit.encoding_height()));
+        vector<CKKSCiphertext> vec_cts(num_units);
+        for (int i = 0; i < num_units; i++) {
+            vec_cts[i] = eval.encrypt_placeholder(level);
+        }
+        return EncryptedRowVector(width, unit, move(vec_cts));
     }
 
     Vector LinearAlgebra::decrypt(const EncryptedRowVector &enc_vec, bool suppress_warnings) const {
@@ -102,13 +169,173 @@ namespace hit {
         for (int i = 0; i < vec_pieces.size(); i++) {
             vec_cts[i] = eval.encrypt(vec_pieces[i].data(), level);
         }
-        return EncryptedColVector(vec.size(), unit, vec_cts);
+        return EncryptedColVector(vec.size(), unit, move(vec_cts));
+    }
+
+    EncryptedColVector LinearAlgebra::encrypt_col_vector_shape(int height, const EncodingUnit &unit, int level) {
+        if (height <= 0) {
+            LOG_AND_THROW_STREAM("Vector height must be positive, got " << height);
+        }
+        // the same units as `encode_col_vector`
+        int num_units = ceil(height / static_cast<double>(unit.encoding_width()));
+        vector<CKKSCiphertext> vec_cts(num_units);
+        for (int i = 0; i < num_units; i++) {
+            vec_cts[i] = eval.encrypt_placeholder(level);
+        }
+        return EncryptedColVector(height, unit, move(vec_cts));
     }
 
     EncodingUnit LinearAlgebra::make_unit(int encoding_height) const {
         return EncodingUnit(encoding_height, eval.num_slots() / encoding_height);
     }
 
+    LinearAlgebraCost LinearAlgebra::estimate_cost(const vector<LinearAlgebraOp> &ops,
+                                                   const EncodingUnit &unit) const {
+        LinearAlgebraCost cost;
+        for (const auto &op : ops) {
+            // the level only affects the weighted cost, which is not needed here
+            double weighted_key_switches = 0;
+            LinearAlgebraCost op_cost = estimate_op_cost(op, unit, 0, weighted_key_switches);
+            cost.ciphertexts += op.count * op_cost.ciphertexts;
+            cost.rotations += op.count * op_cost.rotations;
+            cost.multiplications += op.count * op_cost.multiplications;
+            cost.relinearizations += op.count * op_cost.relinearizations;
+            cost.rescales += op.count * op_cost.rescales;
+        }
+        return cost;
+    }
+
+    LinearAlgebraCost LinearAlgebra::estimate_op_cost(const LinearAlgebraOp &op, const EncodingUnit &unit, int level,
+                                                      double &weighted_key_switches) const {
+        if (op.height <= 0 || op.width <= 0 || op.count < 0 ||
+            ((op.type == OP_MATMUL_ROW_MAJOR || op.type == OP_MATMUL_COL_MAJOR) && op.right_width <= 0)) {
+            LOG_AND_THROW_STREAM("Invalid operation for estimate_cost: " << op.height << "x" << op.width << "x"
+                                                                         << op.right_width << ", count " << op.count);
+        }
+        int m = unit.encoding_height();
+        int n = unit.encoding_width();
+        auto vertical_units = [&](int dim) { return static_cast<int>(ceil(dim / static_cast<double>(m))); };
+        auto horizontal_units = [&](int dim) { return static_cast<int>(ceil(dim / static_cast<double>(n))); };
+        // The radix of each ladder depends on the number of ciphertexts in flight, i.e., the product of the sizes
+        // of the loops enclosing it (see `rotation_radix` and `parallel_for`).
+        auto in_flight = [](int64_t loop_size, int64_t inner_loop_size) {
+            return static_cast<int>(
+                min(iterations_in_flight() * loop_size * inner_loop_size, static_cast<int64_t>(1) << 20));
+        };
+        // number of rotations needed to sum the rows of a unit
+        auto sum_rows_rotations = [&](int ciphertexts) { return rot_count(m, n, true, ciphertexts); };
+        // number of rotations needed to sum the columns of a zero-padded matrix with `width` columns
+        // (see sum_cols_width)
+        auto sum_cols_rotations = [&](int width, int ciphertexts) {
+            return rot_count(sum_cols_width(width, n, true), 1, true, ciphertexts);
+        };
+        // number of rotations needed to replicate the first column of a unit
+        auto replicate_col_rotations = [&](int ciphertexts) { return rot_count(n, 1, false, ciphertexts); };
+        // The cost of a key switch is proportional to the number of primes in the ciphertext modulus,
+        // so a key switch at `level` - k is weighted by `level` - k + 1.
+        auto weight = [level](int k) { return static_cast<double>(level - k + 1); };
+
+        int v = vertical_units(op.height);
+        int h = horizontal_units(op.width);
+        LinearAlgebraCost op_cost;
+        switch (op.type) {
+            case OP_ROW_VECTOR_MATRIX:
+                // hadamard_multiply and relinearize each unit, then sum_rows
+                op_cost.ciphertexts = v * h + v;
+                op_cost.multiplications = v * h;
+                op_cost.relinearizations = v * h;
+                op_cost.rotations = h * sum_rows_rotations(in_flight(h, 1));
+                weighted_key_switches += (op_cost.relinearizations + op_cost.rotations) * weight(0);
+                break;
+            case OP_MATRIX_COL_VECTOR:
+                // hadamard_multiply, relinearize, and rescale each unit, then sum_cols
+                op_cost.ciphertexts = v * h + h;
+                op_cost.multiplications = v * h + v;
+                op_cost.relinearizations = v * h;
+                op_cost.rescales = v * h;
+                op_cost.rotations =
+                    v * (sum_cols_rotations(op.width, in_flight(v, 1)) + replicate_col_rotations(in_flight(v, 1)));
+                weighted_key_switches += op_cost.relinearizations * weight(0) + op_cost.rotations * weight(1);
+                break;
+            case OP_SUM_ROWS:
+                op_cost.ciphertexts = v * h;
+                op_cost.rotations = h * sum_rows_rotations(in_flight(h, 1));
+                weighted_key_switches += op_cost.rotations * weight(0);
+                break;
+            case OP_SUM_COLS:
+                op_cost.ciphertexts = v * h;
+                op_cost.multiplications = v;
+                op_cost.rotations =
+                    v * (sum_cols_rotations(op.width, in_flight(v, 1)) + replicate_col_rotations(in_flight(v, 1)));
+                weighted_key_switches += op_cost.rotations * weight(0);
+                break;
+            case OP_MATMUL_ROW_MAJOR: {
+                // inputs are A^T (width-by-height) at `level` and B (width-by-right_width) one level below. For each
+                // row of A, extract_row masks, rescales, shifts (except for the first row of each unit), and
+                // replicates each unit of A^T. The row is multiplied by B, and the rows of the product are summed
+                // before it is rescaled and masked (see matrix_matrix_mul_loop_row_major), so every key switch
+                // is performed one level below the input.
+                int inner_v = vertical_units(op.width);
+                int left_h = horizontal_units(op.height);
+                int right_h = horizontal_units(op.right_width);
+                op_cost.ciphertexts = inner_v * left_h + inner_v * right_h;
+                op_cost.multiplications = op.height * (inner_v + inner_v * right_h + right_h);
+                op_cost.relinearizations = op.height * inner_v * right_h;
+                op_cost.rescales = op.height * (inner_v + right_h);
+                op_cost.rotations = op.height * (inner_v * replicate_col_rotations(in_flight(op.height, inner_v)) +
+                                                 right_h * sum_rows_rotations(in_flight(op.height, right_h))) +
+                                    inner_v * (op.height - left_h);
+                weighted_key_switches += (op_cost.relinearizations + op_cost.rotations) * weight(1);
+                break;
+            }
+            case OP_MATMUL_COL_MAJOR: {
+                // inputs are A (height-by-width) one level below B^T (right_width-by-width), which is at `level`.
+                // For each column of B, extract_col masks, rescales, and replicates each unit of B^T. A is
+                // multiplied by the column, rescaled, and summed and masked by mask_col, which shifts all but the
+                // first column of each unit into place.
+                int inner_h = horizontal_units(op.width);
+                int right_v = vertical_units(op.right_width);
+                int right_h = horizontal_units(op.right_width);
+                op_cost.ciphertexts = v * inner_h + right_v * inner_h;
+                op_cost.multiplications = op.right_width * (inner_h + v * inner_h + v);
+                op_cost.relinearizations = op.right_width * v * inner_h;
+                op_cost.rescales = op.right_width * (inner_h + v * inner_h);
+                int extract_rotations =
+                    op.right_width * inner_h * sum_rows_rotations(in_flight(op.right_width, inner_h));
+                int sum_rotations = op.right_width * v * sum_cols_rotations(op.width, in_flight(op.right_width, v)) +
+                                    v * (op.right_width - right_h);
+                op_cost.rotations = extract_rotations + sum_rotations;
+                weighted_key_switches +=
+                    (extract_rotations + op_cost.relinearizations) * weight(1) + sum_rotations * weight(2);
+                break;
+            }
+            default:
+                LOG_AND_THROW_STREAM("Unknown operation type for estimate_cost: " << op.type);
+        }
+        return op_cost;
+    }
+
+    EncodingUnit LinearAlgebra::plan_unit(const vector<LinearAlgebraOp> &ops) const {
+        if (ops.empty()) {
+            LOG_AND_THROW_STREAM("plan_unit requires at least one operation");
+        }
+        auto key = [](const LinearAlgebraCost &cost) {
+            return make_tuple(cost.rotations + cost.relinearizations, cost.multiplications, cost.ciphertexts);
+        };
+
+        EncodingUnit best = make_unit(1);
+        LinearAlgebraCost best_cost = estimate_cost(ops, best);
+        for (int height = 2; height <= eval.num_slots(); height <<= 1) {
+            EncodingUnit unit = make_unit(height);
+            LinearAlgebraCost cost = estimate_cost(ops, unit);
+            if (key(cost) < key(best_cost)) {
+                best = unit;
+                best_cost = cost;
+            }
+        }
+        return best;
+    }
+
     Vector LinearAlgebra::decrypt(const EncryptedColVector &enc_vec, bool suppress_warnings) const {
         TRY_AND_THROW_STREAM(enc_vec.validate(),
                              "The EncryptedColVector argument to decrypt is invalid; has it been initialized?");
@@ -125,7 +352,72 @@ namespace hit {
         return decode_col_vector(vec_pieces, enc_vec.height());
     }
 
-    LinearAlgebra::LinearAlgebra(CKKSEvaluator &eval) : eval(eval) {
+    LinearAlgebra::LinearAlgebra(CKKSEvaluator &eval)
+        : eval(eval),
+          num_threads(static_cast<int>(max(thread::hardware_concurrency(), 1U))),
+          max_rotation_radix(num_threads + 1) {
+    }
+
+    void LinearAlgebra::set_max_rotation_radix(int radix) {
+        if (radix < 2) {
+            LOG_AND_THROW_STREAM("Maximum rotation radix must be at least 2, got " << radix);
+        }
+        max_rotation_radix = radix;
+    }
+
+    void LinearAlgebra::enable_numa(const NumaTopology &topology) {
+        numa_workers = make_shared<NumaWorkerPool>(topology);
+        num_threads = 0;
+        for (const auto &cpus : topology.node_cpus) {
+            num_threads += static_cast<int>(cpus.size());
+        }
+    }
+
+    vector<NumaNodeStats> LinearAlgebra::numa_stats() const {
+        if (!numa_workers) {
+            return vector<NumaNodeStats>();
+        }
+        return numa_workers->node_stats();
+    }
+
+    // see `LinearAlgebra::iterations_in_flight`
+    static thread_local int loop_iterations_in_flight = 1;
+
+    int LinearAlgebra::iterations_in_flight() {
+        return loop_iterations_in_flight;
+    }
+
+    void LinearAlgebra::parallel_for(int max_idx, const function<void(int)> &body) const {
+        // Iterations may run on other threads, so each one records the number of iterations in flight
+        // (including those of enclosing loops) on the thread which evaluates it.
+        // The bound only prevents overflow; any value above the number of threads has the same effect.
+        int in_flight = static_cast<int>(min(static_cast<int64_t>(loop_iterations_in_flight) * max(max_idx, 1),
+                                             static_cast<int64_t>(1) << 20));
+        // Iterations also use the memory arena of the thread which started the loop.
+        MemoryArena *arena = MemoryArena::current();
+        auto loop_body = [&body, in_flight, arena](int i) {
+            int enclosing_in_flight = loop_iterations_in_flight;
+            loop_iterations_in_flight = in_flight;
+            MemoryArena *enclosing_arena = MemoryArena::set_current(arena);
+            try {
+                body(i);
+            } catch (...) {
+                loop_iterations_in_flight = enclosing_in_flight;
+                MemoryArena::set_current(enclosing_arena);
+                throw;
+            }
+            loop_iterations_in_flight = enclosing_in_flight;
+            MemoryArena::set_current(enclosing_arena);
+        };
+
+        if (numa_workers) {
+            numa_workers->run(max_idx, loop_body);
+            return;
+        }
+        // https://stackoverflow.com/a/17694752/925978
+        vector<int> iter_idxs(max(max_idx, 0));
+        iota(iter_idxs.begin(), iter_idxs.end(), 0);
+        for_each(__pstl::execution::par, iter_idxs.begin(), iter_idxs.end(), loop_body);
     }
 
     // explicit template instantiation
@@ -148,6 +440,15 @@ namespace hit {
     template void LinearAlgebra::rescale_to_next_inplace(EncryptedMatrix &);
     template EncryptedMatrix LinearAlgebra::rescale_to_next(const EncryptedMatrix &);
     template void LinearAlgebra::relinearize_inplace(EncryptedMatrix &);
+    template EncryptedMatrix LinearAlgebra::relinearize(const EncryptedMatrix &);
+    template EncryptedMatrix LinearAlgebra::relinearize(EncryptedMatrix &&);
+    template EncryptedMatrix LinearAlgebra::rescale_to_next(EncryptedMatrix &&);
+    template EncryptedMatrix LinearAlgebra::add(EncryptedMatrix &&, const EncryptedMatrix &);
+    template EncryptedMatrix LinearAlgebra::sub(EncryptedMatrix &&, const EncryptedMatrix &);
+    template EncryptedMatrix LinearAlgebra::negate(EncryptedMatrix &&);
+    template EncryptedMatrix LinearAlgebra::multiply_plain(EncryptedMatrix &&, double);
+    template EncryptedMatrix LinearAlgebra::hadamard_square(EncryptedMatrix &&);
+    template EncryptedMatrix LinearAlgebra::hadamard_multiply(EncryptedMatrix &&, const EncryptedMatrix &);
     template void LinearAlgebra::hadamard_square_inplace(EncryptedMatrix &);
     template EncryptedMatrix LinearAlgebra::hadamard_square(const EncryptedMatrix &);
     template EncryptedMatrix LinearAlgebra::hadamard_multiply(const EncryptedMatrix &, const EncryptedMatrix &);
@@ -182,6 +483,15 @@ namespace hit {
     template void LinearAlgebra::rescale_to_next_inplace(EncryptedRowVector &);
     template EncryptedRowVector LinearAlgebra::rescale_to_next(const EncryptedRowVector &);
     template void LinearAlgebra::relinearize_inplace(EncryptedRowVector &);
+    template EncryptedRowVector LinearAlgebra::relinearize(const EncryptedRowVector &);
+    template EncryptedRowVector LinearAlgebra::relinearize(EncryptedRowVector &&);
+    template EncryptedRowVector LinearAlgebra::rescale_to_next(EncryptedRowVector &&);
+    template EncryptedRowVector LinearAlgebra::add(EncryptedRowVector &&, const EncryptedRowVector &);
+    template EncryptedRowVector LinearAlgebra::sub(EncryptedRowVector &&, const EncryptedRowVector &);
+    template EncryptedRowVector LinearAlgebra::negate(EncryptedRowVector &&);
+    template EncryptedRowVector LinearAlgebra::multiply_plain(EncryptedRowVector &&, double);
+    template EncryptedRowVector LinearAlgebra::hadamard_square(EncryptedRowVector &&);
+    template EncryptedRowVector LinearAlgebra::hadamard_multiply(EncryptedRowVector &&, const EncryptedRowVector &);
     template void LinearAlgebra::hadamard_square_inplace(EncryptedRowVector &);
     template EncryptedRowVector LinearAlgebra::hadamard_square(const EncryptedRowVector &);
     template EncryptedRowVector LinearAlgebra::hadamard_multiply(const EncryptedRowVector &,
@@ -217,6 +527,15 @@ namespace hit {
     template void LinearAlgebra::rescale_to_next_inplace(EncryptedColVector &);
     template EncryptedColVector LinearAlgebra::rescale_to_next(const EncryptedColVector &);
     template void LinearAlgebra::relinearize_inplace(EncryptedColVector &);
+    template EncryptedColVector LinearAlgebra::relinearize(const EncryptedColVector &);
+    template EncryptedColVector LinearAlgebra::relinearize(EncryptedColVector &&);
+    template EncryptedColVector LinearAlgebra::rescale_to_next(EncryptedColVector &&);
+    template EncryptedColVector LinearAlgebra::add(EncryptedColVector &&, const EncryptedColVector &);
+    template EncryptedColVector LinearAlgebra::sub(EncryptedColVector &&, const EncryptedColVector &);
+    template EncryptedColVector LinearAlgebra::negate(EncryptedColVector &&);
+    template EncryptedColVector LinearAlgebra::multiply_plain(EncryptedColVector &&, double);
+    template EncryptedColVector LinearAlgebra::hadamard_square(EncryptedColVector &&);
+    template EncryptedColVector LinearAlgebra::hadamard_multiply(EncryptedColVector &&, const EncryptedColVector &);
     template void LinearAlgebra::hadamard_square_inplace(EncryptedColVector &);
     template EncryptedColVector LinearAlgebra::hadamard_square(const EncryptedColVector &);
     template EncryptedColVector LinearAlgebra::hadamard_multiply(const EncryptedColVector &,
@@ -235,6 +554,7 @@ namespace hit {
     void LinearAlgebra::add_plain_inplace(EncryptedMatrix &enc_mat1, const Matrix &mat2) {
         TRY_AND_THROW_STREAM(enc_mat1.validate(),
                              "The EncryptedMatrix argument to add_plain is invalid; has it been initialized?");
+        row_major_validation(enc_mat1, "add_plain");
         if (enc_mat1.height() != mat2.size1() || enc_mat1.width() != mat2.size2()) {
             LOG_AND_THROW_STREAM("Arguments to add_plain must have the same dimensions; "
                                  << "ciphertext encrypts a " << enc_mat1.height() << "x" << enc_mat1.width()
@@ -243,9 +563,12 @@ namespace hit {
         }
         vector<vector<Matrix>> encoded_matrix = encode_matrix(mat2, enc_mat1.encoding_unit());
 
-        for (int i = 0; i < enc_mat1.cts.size(); i++) {
-            for (int j = 0; j < enc_mat1.cts[0].size(); j++) {
-                eval.add_plain_inplace(enc_mat1.cts[i][j], encoded_matrix[i][j].data());
+        for (int i = 0; i < enc_mat1.num_vertical_units(); i++) {
+            for (int j = 0; j < enc_mat1.num_horizontal_units(); j++) {
+                eval.add_plain_inplace(enc_mat1.unit_ct(i, j), encoded_matrix[i][j].data());
+                if (!is_zero_matrix(encoded_matrix[i][j])) {
+                    enc_mat1.set_zero_ct(enc_mat1.unit_index(i, j), false);
+                }
             }
         }
     }
@@ -283,6 +606,7 @@ namespace hit {
     void LinearAlgebra::sub_plain_inplace(EncryptedMatrix &enc_mat1, const Matrix &mat2) {
         TRY_AND_THROW_STREAM(enc_mat1.validate(),
                              "The EncryptedMatrix argument to sub_plain is invalid; has it been initialized?");
+        row_major_validation(enc_mat1, "sub_plain");
         if (enc_mat1.height() != mat2.size1() || enc_mat1.width() != mat2.size2()) {
             LOG_AND_THROW_STREAM("Arguments to sub_plain must have the same dimensions; "
                                  << "ciphertext encrypts a " << enc_mat1.height() << "x" << enc_mat1.width()
@@ -291,9 +615,12 @@ namespace hit {
         }
         vector<vector<Matrix>> encoded_matrix = encode_matrix(mat2, enc_mat1.encoding_unit());
 
-        for (int i = 0; i < enc_mat1.cts.size(); i++) {
-            for (int j = 0; j < enc_mat1.cts[0].size(); j++) {
-                eval.sub_plain_inplace(enc_mat1.cts[i][j], encoded_matrix[i][j].data());
+        for (int i = 0; i < enc_mat1.num_vertical_units(); i++) {
+            for (int j = 0; j < enc_mat1.num_horizontal_units(); j++) {
+                eval.sub_plain_inplace(enc_mat1.unit_ct(i, j), encoded_matrix[i][j].data());
+                if (!is_zero_matrix(encoded_matrix[i][j])) {
+                    enc_mat1.set_zero_ct(enc_mat1.unit_index(i, j), false);
+                }
             }
         }
     }
@@ -348,7 +675,7 @@ namespace hit {
         relinearize_inplace(hadmard_prod);
 
         vector<CKKSCiphertext> cts{sum_rows_core(hadmard_prod, 0, true)};
-        return EncryptedColVector(hadmard_prod.width(), hadmard_prod.encoding_unit().transpose(), cts);
+        return EncryptedColVector(hadmard_prod.width(), hadmard_prod.encoding_unit().transpose(), move(cts));
     }
 
     EncryptedRowVector LinearAlgebra::multiply_mixed_unit(const EncryptedMatrix &enc_mat,
@@ -360,11 +687,18 @@ namespace hit {
 
     EncryptedMatrix LinearAlgebra::hadamard_multiply(const EncryptedRowVector &enc_vec,
                                                      const EncryptedMatrix &enc_mat) {
+        EncryptedMatrix temp = enc_mat;
+        return hadamard_multiply(enc_vec, move(temp));
+    }
+
+    EncryptedMatrix LinearAlgebra::hadamard_multiply(const EncryptedRowVector &enc_vec,
+                                                     EncryptedMatrix &&enc_mat) {
         TRY_AND_THROW_STREAM(
             enc_vec.validate(),
             "The EncryptedRowVector argument to hadamard_multiply is invalid; has it been initialized?");
         TRY_AND_THROW_STREAM(enc_mat.validate(),
                              "The EncryptedMatrix argument to hadamard_multiply is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "hadamard_multiply");
         if (enc_mat.encoding_unit() != enc_vec.encoding_unit()) {
             LOG_AND_THROW_STREAM("Inputs to hadamard_multiply must have the same units: "
                                  << dim_string(enc_vec.encoding_unit()) << "!=" << dim_string(enc_mat.encoding_unit()));
@@ -390,21 +724,31 @@ namespace hit {
                                  << "Vector: " << enc_vec.needs_relin() << ", Matrix: " << enc_mat.needs_relin());
         }
 
-        vector<vector<CKKSCiphertext>> cts = enc_mat.cts;
-
         parallel_for(enc_mat.num_vertical_units() * enc_mat.num_horizontal_units(), [&](int i) {
             int unit_row = i / enc_mat.num_horizontal_units();
             int unit_col = i % enc_mat.num_horizontal_units();
-            eval.multiply_inplace(cts[unit_row][unit_col], enc_vec.cts[unit_row]);
+            if (enc_mat.is_zero_unit(unit_row, unit_col)) {
+                // the product is zero, so we only need to update the scale
+                eval.multiply_plain_inplace(enc_mat.unit_ct(unit_row, unit_col), 1);
+            } else {
+                eval.multiply_inplace(enc_mat.unit_ct(unit_row, unit_col), enc_vec.cts[unit_row]);
+            }
         });
-
-        return EncryptedMatrix(enc_mat.height(), enc_mat.width(), enc_mat.encoding_unit(), cts);
+        // the zero units and padding of the product are the same as those of the matrix
+        return move(enc_mat);
     }
 
     EncryptedMatrix LinearAlgebra::hadamard_multiply(const EncryptedMatrix &enc_mat,
                                                      const EncryptedColVector &enc_vec) {
+        EncryptedMatrix temp = enc_mat;
+        return hadamard_multiply(move(temp), enc_vec);
+    }
+
+    EncryptedMatrix LinearAlgebra::hadamard_multiply(EncryptedMatrix &&enc_mat,
+                                                     const EncryptedColVector &enc_vec) {
         TRY_AND_THROW_STREAM(enc_mat.validate(),
                              "The EncryptedMatrix argument to hadamard_multiply is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "hadamard_multiply");
         TRY_AND_THROW_STREAM(
             enc_vec.validate(),
             "The EncryptedColVector argument to hadamard_multiply is invalid; has it been initialized?");
@@ -433,15 +777,18 @@ namespace hit {
                                  << "Vector: " << enc_mat.needs_relin() << ", Matrix: " << enc_vec.needs_relin());
         }
 
-        vector<vector<CKKSCiphertext>> cts = enc_mat.cts;
-
         parallel_for(enc_mat.num_vertical_units() * enc_mat.num_horizontal_units(), [&](int i) {
             int unit_row = i / enc_mat.num_horizontal_units();
             int unit_col = i % enc_mat.num_horizontal_units();
-            eval.multiply_inplace(cts[unit_row][unit_col], enc_vec.cts[unit_col]);
+            if (enc_mat.is_zero_unit(unit_row, unit_col)) {
+                // the product is zero, so we only need to update the scale
+                eval.multiply_plain_inplace(enc_mat.unit_ct(unit_row, unit_col), 1);
+            } else {
+                eval.multiply_inplace(enc_mat.unit_ct(unit_row, unit_col), enc_vec.cts[unit_col]);
+            }
         });
-
-        return EncryptedMatrix(enc_mat.height(), enc_mat.width(), enc_mat.encoding_unit(), cts);
+        // the zero units and padding of the product are the same as those of the matrix
+        return move(enc_mat);
     }
 
     EncryptedColVector LinearAlgebra::multiply(const EncryptedRowVector &enc_vec, const EncryptedMatrix &enc_mat) {
@@ -461,6 +808,336 @@ namespace hit {
         return sum_cols(hadmard_prod, scalar);
     }
 
+    EncryptedColVector LinearAlgebra::multiply_diagonal(const EncryptedMatrix &enc_mat,
+                                                        const EncryptedColVector &enc_vec) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to multiply_diagonal is invalid; has it been initialized?");
+        TRY_AND_THROW_STREAM(
+            enc_vec.validate(),
+            "The EncryptedColVector argument to multiply_diagonal is invalid; has it been initialized?");
+        if (enc_mat.layout() != LAYOUT_DIAGONAL) {
+            LOG_AND_THROW_STREAM("Input to multiply_diagonal must be a matrix in the diagonal layout");
+        }
+        if (enc_mat.encoding_unit() != enc_vec.encoding_unit()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_diagonal must have the same units: "
+                                 << dim_string(enc_mat.encoding_unit()) << "!=" << dim_string(enc_vec.encoding_unit()));
+        }
+        if (enc_mat.width() != enc_vec.height()) {
+            LOG_AND_THROW_STREAM("Inner dimension mismatch in multiply_diagonal: " + dim_string(enc_mat)
+                                 << " is not compatible with " + dim_string(enc_vec));
+        }
+        if (enc_mat.he_level() != enc_vec.he_level()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_diagonal must be at the same level: "
+                                 << enc_mat.he_level() << "!=" << enc_vec.he_level());
+        }
+        if (enc_mat.needs_rescale() || enc_vec.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_diagonal must have nominal scale: "
+                                 << "Matrix: " << enc_mat.needs_rescale() << ", Vector: " << enc_vec.needs_rescale());
+        }
+        if (enc_mat.needs_relin() || enc_vec.needs_relin()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_diagonal must be linear ciphertexts: "
+                                 << "Matrix: " << enc_mat.needs_relin() << ", Vector: " << enc_vec.needs_relin());
+        }
+
+        // The matrix is tiled with n-by-n blocks. For each block, we compute
+        //   sum_s rot(sum_b d'_{g*s+b} (.) rot(v, b), g*s)
+        // where d' are the pre-rotated diagonals (see encode_diagonals). The baby-step
+        // rotations rot(v, b) only depend on the vector, so they are shared by every row of blocks.
+        int n = enc_mat.encoding_unit().encoding_width();
+        int baby_steps = diagonal_baby_steps(n);
+        int giant_steps = n / baby_steps;
+        int num_block_rows = enc_mat.num_vertical_units();
+        int num_block_cols = enc_vec.num_units();
+
+        // diagonals which are known to be zero don't contribute to the product
+        auto is_zero_diagonal = [&](int i, int j, int k) { return enc_mat.is_zero_unit(i, j * n + k); };
+
+        vector<vector<CKKSCiphertext>> vec_rots(num_block_cols, vector<CKKSCiphertext>(baby_steps));
+        parallel_for(num_block_cols, [&](int j) {
+            vec_rots[j][0] = enc_vec.cts[j];
+            int prev_step = 0;
+            for (int b = 1; b < baby_steps; b++) {
+                bool needed = false;
+                for (int i = 0; i < num_block_rows && !needed; i++) {
+                    for (int s = 0; s < giant_steps && !needed; s++) {
+                        needed = !is_zero_diagonal(i, j, s * baby_steps + b);
+                    }
+                }
+                if (needed) {
+                    vec_rots[j][b] = eval.rotate_left(vec_rots[j][prev_step], b - prev_step);
+                    prev_step = b;
+                }
+            }
+        });
+
+        vector<CKKSCiphertext> row_results(num_block_rows);
+        parallel_for(num_block_rows, [&](int i) {
+            // Combine the giant steps using Horner's rule, starting from the last giant step.
+            // `acc_step` is the giant step which `acc` is currently aligned with.
+            CKKSCiphertext acc;
+            bool has_acc = false;
+            int acc_step = 0;
+            for (int s = giant_steps - 1; s >= 0; s--) {
+                vector<CKKSCiphertext> prods;
+                for (int j = 0; j < num_block_cols; j++) {
+                    for (int b = 0; b < baby_steps; b++) {
+                        if (!is_zero_diagonal(i, j, s * baby_steps + b)) {
+                            prods.push_back(
+                                eval.multiply(enc_mat.unit_ct(i, j * n + s * baby_steps + b), vec_rots[j][b]));
+                        }
+                    }
+                }
+                if (prods.empty()) {
+                    continue;
+                }
+                CKKSCiphertext inner = eval.add_many(prods);
+                eval.relinearize_inplace(inner);
+                eval.rescale_to_next_inplace(inner);
+                if (has_acc) {
+                    eval.rotate_left_inplace(acc, (acc_step - s) * baby_steps);
+                    eval.add_inplace(acc, inner);
+                } else {
+                    acc = inner;
+                    has_acc = true;
+                }
+                acc_step = s;
+            }
+            if (!has_acc) {
+                // every diagonal in this row of blocks is zero
+                acc = eval.multiply_plain(enc_mat.unit_ct(i, 0), 0);
+                eval.rescale_to_next_inplace(acc);
+            } else if (acc_step > 0) {
+                eval.rotate_left_inplace(acc, acc_step * baby_steps);
+            }
+            row_results[i] = acc;
+        });
+
+        return EncryptedColVector(enc_mat.height(), enc_mat.encoding_unit(), move(row_results));
+    }
+
+    int LinearAlgebra::batch_pack_factor(const EncryptedMatrix &enc_mat) {
+        // Products can only be packed into the unused columns of a unit if the matrix fits in a single
+        // horizontal unit, and if those columns are zero.
+        if (enc_mat.num_horizontal_units() != 1 || !enc_mat.is_zero_padded()) {
+            return 1;
+        }
+        int block_width = 1;
+        while (block_width < enc_mat.width()) {
+            block_width <<= 1;
+        }
+        return enc_mat.encoding_unit().encoding_width() / block_width;
+    }
+
+    vector<vector<CKKSCiphertext>> LinearAlgebra::shifted_unit_copies(const EncryptedMatrix &enc_mat, int copies,
+                                                                      int stride) {
+        vector<vector<CKKSCiphertext>> shifted(copies, vector<CKKSCiphertext>(enc_mat.num_vertical_units()));
+        parallel_for(enc_mat.num_vertical_units(), [&](int i) {
+            if (enc_mat.is_zero_unit(i, 0)) {
+                return;
+            }
+            shifted[0][i] = enc_mat.unit_ct(i, 0);
+            for (int k = 1; k < copies; k++) {
+                // stride is a power of two, so each shift is a single rotation
+                shifted[k][i] = eval.rotate_right(shifted[k - 1][i], stride);
+            }
+        });
+        return shifted;
+    }
+
+    vector<EncryptedColVector> LinearAlgebra::multiply_batch(const vector<EncryptedRowVector> &enc_vecs,
+                                                             const EncryptedMatrix &enc_mat) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to multiply_batch is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "multiply_batch");
+        for (const auto &enc_vec : enc_vecs) {
+            TRY_AND_THROW_STREAM(
+                enc_vec.validate(),
+                "An EncryptedRowVector argument to multiply_batch is invalid; has it been initialized?");
+            if (enc_mat.encoding_unit() != enc_vec.encoding_unit()) {
+                LOG_AND_THROW_STREAM("Inputs to multiply_batch must have the same units: "
+                                     << dim_string(enc_vec.encoding_unit())
+                                     << "!=" << dim_string(enc_mat.encoding_unit()));
+            }
+            if (enc_mat.height() != enc_vec.width()) {
+                LOG_AND_THROW_STREAM("Inner dimension mismatch in multiply_batch: " + dim_string(enc_vec)
+                                     << " is not compatible with " + dim_string(enc_mat));
+            }
+            if (enc_mat.he_level() != enc_vec.he_level()) {
+                LOG_AND_THROW_STREAM("Inputs to multiply_batch must have the same level: "
+                                     << enc_vec.he_level() << "!=" << enc_mat.he_level());
+            }
+            if (enc_mat.needs_rescale() || enc_vec.needs_rescale() || enc_mat.needs_relin() ||
+                enc_vec.needs_relin()) {
+                LOG_AND_THROW_STREAM("Inputs to multiply_batch must be linear ciphertexts with nominal scale");
+            }
+        }
+
+        EncodingUnit unit = enc_mat.encoding_unit();
+        // mask for the j^th unit of an output, which keeps only the columns inside the g-dimensional vector
+        auto col_mask = [&](int j) {
+            vector<double> mask(enc_mat.num_slots(), 0);
+            int populated_width = min(unit.encoding_width(), enc_mat.width() - j * unit.encoding_width());
+            for (int r = 0; r < unit.encoding_height(); r++) {
+                for (int c = 0; c < populated_width; c++) {
+                    mask[r * unit.encoding_width() + c] = 1;
+                }
+            }
+            return mask;
+        };
+
+        int num_vecs = enc_vecs.size();
+        int pack_factor = min(batch_pack_factor(enc_mat), num_vecs);
+        vector<EncryptedColVector> results(num_vecs);
+        if (pack_factor < 2) {
+            vector<vector<double>> masks(enc_mat.num_horizontal_units());
+            for (int j = 0; j < enc_mat.num_horizontal_units(); j++) {
+                masks[j] = col_mask(j);
+            }
+            for (int k = 0; k < num_vecs; k++) {
+                // rescale and mask so that every output has the same level and padding as a packed product
+                results[k] = multiply(enc_vecs[k], enc_mat);
+                rescale_to_next_inplace(results[k]);
+                parallel_for(results[k].num_units(), [&](int j) {
+                    results[k].cts[j] = eval.multiply_plain(results[k].cts[j], masks[j]);
+                });
+            }
+            return results;
+        }
+
+        // Copy s of the matrix occupies columns [s*block_width, (s+1)*block_width) of each unit.
+        // Since the vectors are replicated across columns, the Hadamard product of the s^th copy with
+        // the s^th vector in a group lands in the same columns, so we can sum the rows of the whole group at once.
+        vector<double> mask = col_mask(0);
+        int block_width = unit.encoding_width() / batch_pack_factor(enc_mat);
+        vector<vector<CKKSCiphertext>> shifted = shifted_unit_copies(enc_mat, pack_factor, block_width);
+
+        int num_groups = ceil(num_vecs / static_cast<double>(pack_factor));
+        parallel_for(num_groups, [&](int group) {
+            int group_size = min(pack_factor, num_vecs - group * pack_factor);
+            vector<CKKSCiphertext> prods;
+            for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
+                if (enc_mat.is_zero_unit(i, 0)) {
+                    continue;
+                }
+                for (int s = 0; s < group_size; s++) {
+                    prods.push_back(eval.multiply(enc_vecs[group * pack_factor + s].cts[i], shifted[s][i]));
+                }
+            }
+
+            CKKSCiphertext packed;
+            if (prods.empty()) {
+                // the matrix is zero, so only the scale of the output needs to be updated
+                packed = eval.multiply_plain(enc_mat.unit_ct(0, 0), 1);
+            } else {
+                packed = eval.add_many(prods);
+                eval.relinearize_inplace(packed);
+                rot(packed, unit.encoding_height(), unit.encoding_width(), true);
+            }
+            eval.rescale_to_next_inplace(packed);
+
+            // Each product is shifted into the first block and masked, since the other blocks hold the
+            // rest of the group and would otherwise end up in the padding of the output.
+            for (int s = 0; s < group_size; s++) {
+                CKKSCiphertext block = s == 0 ? packed : eval.rotate_left(packed, s * block_width);
+                vector<CKKSCiphertext> cts{eval.multiply_plain(block, mask)};
+                results[group * pack_factor + s] = EncryptedColVector(enc_mat.width(), unit, move(cts));
+            }
+        });
+        return results;
+    }
+
+    vector<EncryptedRowVector> LinearAlgebra::multiply_batch(const EncryptedMatrix &enc_mat,
+                                                             const vector<EncryptedColVector> &enc_vecs,
+                                                             double scalar) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to multiply_batch is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "multiply_batch");
+        for (const auto &enc_vec : enc_vecs) {
+            TRY_AND_THROW_STREAM(
+                enc_vec.validate(),
+                "An EncryptedColVector argument to multiply_batch is invalid; has it been initialized?");
+            if (enc_mat.encoding_unit() != enc_vec.encoding_unit()) {
+                LOG_AND_THROW_STREAM("Inputs to multiply_batch must have the same units: "
+                                     << dim_string(enc_mat.encoding_unit())
+                                     << "!=" << dim_string(enc_vec.encoding_unit()));
+            }
+            if (enc_mat.width() != enc_vec.height()) {
+                LOG_AND_THROW_STREAM("Inner dimension mismatch in multiply_batch: " + dim_string(enc_mat)
+                                     << " is not compatible with " + dim_string(enc_vec));
+            }
+            if (enc_mat.he_level() != enc_vec.he_level()) {
+                LOG_AND_THROW_STREAM("Inputs to multiply_batch must have the same level: "
+                                     << enc_mat.he_level() << "!=" << enc_vec.he_level());
+            }
+            if (enc_mat.needs_rescale() || enc_vec.needs_rescale() || enc_mat.needs_relin() ||
+                enc_vec.needs_relin()) {
+                LOG_AND_THROW_STREAM("Inputs to multiply_batch must be linear ciphertexts with nominal scale");
+            }
+        }
+
+        int num_vecs = enc_vecs.size();
+        int pack_factor = min(batch_pack_factor(enc_mat), num_vecs);
+        vector<EncryptedRowVector> results(num_vecs);
+        if (pack_factor < 2) {
+            for (int k = 0; k < num_vecs; k++) {
+                results[k] = multiply(enc_mat, enc_vecs[k], scalar);
+            }
+            return results;
+        }
+
+        // Copy s of the matrix occupies columns [s*block_width, (s+1)*block_width) of each unit, and is
+        // multiplied by the s^th vector in a group, shifted into the same columns. The copy is zero outside
+        // of these columns, so the products can be summed into a single ciphertext. We then only need to sum
+        // `block_width` columns, and the relinearization, rescale, and rotations are shared by the group.
+        EncodingUnit unit = enc_mat.encoding_unit();
+        int block_width = unit.encoding_width() / batch_pack_factor(enc_mat);
+        vector<vector<CKKSCiphertext>> shifted = shifted_unit_copies(enc_mat, pack_factor, block_width);
+
+        int num_groups = ceil(num_vecs / static_cast<double>(pack_factor));
+        vector<vector<CKKSCiphertext>> result_cts(num_vecs, vector<CKKSCiphertext>(enc_mat.num_vertical_units()));
+        parallel_for(num_groups, [&](int group) {
+            int group_size = min(pack_factor, num_vecs - group * pack_factor);
+            vector<CKKSCiphertext> shifted_vecs(group_size);
+            for (int s = 0; s < group_size; s++) {
+                const CKKSCiphertext &vec_ct = enc_vecs[group * pack_factor + s].cts[0];
+                shifted_vecs[s] = s == 0 ? vec_ct : eval.rotate_right(vec_ct, s * block_width);
+            }
+            for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
+                if (enc_mat.is_zero_unit(i, 0)) {
+                    // the product is zero; only the mask is needed to get the right scale
+                    CKKSCiphertext zero = eval.multiply_plain(enc_mat.unit_ct(i, 0), 1);
+                    eval.rescale_to_next_inplace(zero);
+                    zero = sum_cols_core(zero, unit, scalar, 0, true);
+                    for (int s = 0; s < group_size; s++) {
+                        result_cts[group * pack_factor + s][i] = zero;
+                    }
+                    continue;
+                }
+
+                vector<CKKSCiphertext> prods(group_size);
+                for (int s = 0; s < group_size; s++) {
+                    prods[s] = eval.multiply(shifted[s][i], shifted_vecs[s]);
+                }
+                CKKSCiphertext packed = eval.add_many(prods);
+                eval.relinearize_inplace(packed);
+                eval.rescale_to_next_inplace(packed);
+                // sum each block of columns, placing the result in the left-most column of the block
+                rot(packed, block_width, 1, true);
+
+                for (int s = 0; s < group_size; s++) {
+                    // move the s^th block to the left-most column, then mask and replicate it
+                    CKKSCiphertext block = s == 0 ? packed : eval.rotate_left(packed, s * block_width);
+                    result_cts[group * pack_factor + s][i] = sum_cols_core(block, unit, scalar, 1, false);
+                }
+            }
+        });
+
+        for (int k = 0; k < num_vecs; k++) {
+            results[k] = EncryptedRowVector(enc_mat.height(), unit, move(result_cts[k]));
+        }
+        return results;
+    }
+
     /* Computes (the encoding of) the k^th column of B, given B^T */
     EncryptedColVector LinearAlgebra::extract_col(const EncryptedMatrix &enc_mat_b_trans, int col) {
         EncodingUnit unit = enc_mat_b_trans.encoding_unit();
@@ -486,8 +1163,12 @@ namespace hit {
 
         vector<CKKSCiphertext> isolated_row_cts(enc_mat_b_trans.num_horizontal_units());
         parallel_for(enc_mat_b_trans.num_horizontal_units(), [&](int j) {
-            isolated_row_cts[j] = eval.multiply_plain(enc_mat_b_trans.cts[unit_row][j], row_mask);
+            isolated_row_cts[j] = eval.multiply_plain(enc_mat_b_trans.unit_ct(unit_row, j), row_mask);
             eval.rescale_to_next_inplace(isolated_row_cts[j]);
+            if (enc_mat_b_trans.is_zero_unit(unit_row, j)) {
+                // replicating a zero row is a no-op
+                return;
+            }
             // we now have isolated the k^th row of B^T. To get an encoding of the k^th column of B
             // we need to replicate this row across all rows of the encoding unit
 
@@ -502,7 +1183,7 @@ namespace hit {
                                 vector<vector<CKKSCiphertext>>{vector<CKKSCiphertext>{isolated_row_cts[j]}}),
                 0, false);
         });
-        return EncryptedColVector(enc_mat_b_trans.width(), unit, isolated_row_cts);
+        return EncryptedColVector(enc_mat_b_trans.width(), unit, move(isolated_row_cts));
     }
 
     /* Computes (the encoding of) the k^th row of A, given A^T */
@@ -530,8 +1211,12 @@ namespace hit {
 
         vector<CKKSCiphertext> isolated_col_cts(enc_mat_a_trans.num_vertical_units());
         parallel_for(enc_mat_a_trans.num_vertical_units(), [&](int i) {
-            isolated_col_cts[i] = eval.multiply_plain(enc_mat_a_trans.cts[i][unit_col], col_mask);
+            isolated_col_cts[i] = eval.multiply_plain(enc_mat_a_trans.unit_ct(i, unit_col), col_mask);
             eval.rescale_to_next_inplace(isolated_col_cts[i]);
+            if (enc_mat_a_trans.is_zero_unit(i, unit_col)) {
+                // replicating a zero column is a no-op
+                return;
+            }
             // we now have isolated the k^th column of A^T. To get an encoding of the k^th row of A
             // we need to replicate this column across all columns of the encoding unit
 
@@ -543,7 +1228,7 @@ namespace hit {
             // now replicate this column to all other columns of the unit
             rot(isolated_col_cts[i], unit.encoding_width(), 1, false);
         });
-        return EncryptedRowVector(enc_mat_a_trans.height(), unit, isolated_col_cts);
+        return EncryptedRowVector(enc_mat_a_trans.height(), unit, move(isolated_col_cts));
     }
 
     /* Computes the k^th column of c*A*B given A and B^T, but NOT encoded as a vector.
@@ -554,7 +1239,6 @@ namespace hit {
                                                                        const EncryptedMatrix &enc_mat_b_trans,
                                                                        double scalar, int k) {
         EncryptedColVector kth_col_B = extract_col(enc_mat_b_trans, k);
-        EncodingUnit unit = enc_mat_a.encoding_unit();
 
         // We could just use `multiply` here, but it's inefficient:
         // it would call hadamard_multiply, followed by `sum_cols` to
@@ -567,8 +1251,14 @@ namespace hit {
         relinearize_inplace(hmul_A_times_kth_col_B);
         rescale_to_next_inplace(hmul_A_times_kth_col_B);
 
+        return mask_col(hmul_A_times_kth_col_B, scalar, k);
+    }
+
+    EncryptedRowVector LinearAlgebra::mask_col(const EncryptedMatrix &hadamard_prod, double scalar, int k) {
+        EncodingUnit unit = hadamard_prod.encoding_unit();
+
         // create a mask for the first column
-        int num_slots = enc_mat_b_trans.num_slots();
+        int num_slots = hadamard_prod.num_slots();
         vector<double> col_mask(num_slots);
         for (int i = 0; i < num_slots; i++) {
             if (i % unit.encoding_width() == 0) {
@@ -578,20 +1268,26 @@ namespace hit {
             }
         }
 
-        vector<CKKSCiphertext> row_cts(enc_mat_a.num_vertical_units());
-        parallel_for(enc_mat_a.num_vertical_units(), [&](int i) {
+        vector<CKKSCiphertext> row_cts(hadamard_prod.num_vertical_units());
+        parallel_for(hadamard_prod.num_vertical_units(), [&](int i) {
             // sum the units in this row
-            CKKSCiphertext unit_sum = eval.add_many(hmul_A_times_kth_col_B.cts[i]);
+            vector<const CKKSCiphertext *> summands = nonzero_units_in_row(hadamard_prod, i);
+            bool is_zero = summands.empty();
+            CKKSCiphertext unit_sum = is_zero ? hadamard_prod.unit_ct(i, 0) : add_units(summands);
             // sum the columns of the unit, putting the result in the first column
-            rot(unit_sum, unit.encoding_width(), 1, true);
+            if (!is_zero) {
+                rot(unit_sum, sum_cols_width(hadamard_prod), 1, true);
+            }
 
             // scale and mask out first column
             row_cts[i] = eval.multiply_plain(unit_sum, col_mask);
             // shift to the target column
-            eval.rotate_right_inplace(row_cts[i], k % unit.encoding_width());
+            if (!is_zero && k % unit.encoding_width() != 0) {
+                eval.rotate_right_inplace(row_cts[i], k % unit.encoding_width());
+            }
         });
 
-        return EncryptedRowVector(enc_mat_a.height(), unit, row_cts);
+        return EncryptedRowVector(hadamard_prod.height(), unit, move(row_cts));
     }
 
     /* Computes the k^th row of c*A*B given A^T and B, but NOT encoded as a vector.
@@ -608,17 +1304,21 @@ namespace hit {
 
         // kth_row_A_times_B is a column vector encoded as rows.
         // we need to mask out the desired row (but NOT replicate it; we will add it to the other rows later)
+        mask_row_inplace(kth_row_A_times_B, scalar, k, transpose_unit);
+        return kth_row_A_times_B;
+    }
 
-        int num_slots = enc_mat_a_trans.num_slots();
+    void LinearAlgebra::mask_row_inplace(EncryptedColVector &enc_vec, double scalar, int k, bool transpose_unit) {
+        int num_slots = enc_vec.num_slots();
 
-        // Currently, each row of kth_row_A_times_B is identical. We want to mask out one
+        // Currently, each row of enc_vec is identical. We want to mask out one
         // so that we can add it to another row later to get our matrix product.
-        // Create a mask for the k^th row of kth_row_A_times_B.
+        // Create a mask for the k^th row of enc_vec.
         // This mask is scaled by c so that we get a constant multiplication for free.
         vector<double> row_mask(num_slots);
 
-        // both inputs have the same encoding unit
-        EncodingUnit mask_unit = enc_mat_b.encoding_unit();
+        // enc_vec has the same encoding unit as the matrix inputs
+        EncodingUnit mask_unit = enc_vec.encoding_unit();
         if (transpose_unit) {
             // inputs have an n-by-m unit, we need to create a mask relative to an m-by-n unit
             mask_unit = mask_unit.transpose();
@@ -639,11 +1339,15 @@ namespace hit {
         }
 
         // iterate over all the (horizontally adjacent) units of this column vector to mask out the kth row
-        for (auto &ct : kth_row_A_times_B.cts) {
+        for (auto &ct : enc_vec.cts) {
             eval.multiply_plain_inplace(ct, row_mask);
         }
+    }
 
-        return kth_row_A_times_B;
+    void LinearAlgebra::row_major_validation(const EncryptedMatrix &enc_mat, const string &api) {
+        if (enc_mat.layout() != LAYOUT_ROW_MAJOR) {
+            LOG_AND_THROW_STREAM("Input to " + api + " must be a matrix in the row-major layout");
+        }
     }
 
     void LinearAlgebra::matrix_multiply_validation(const EncryptedMatrix &enc_mat_a, const EncryptedMatrix &enc_mat_b,
@@ -652,6 +1356,8 @@ namespace hit {
                              "The enc_mat_a argument to " + api + " is invalid; has it been initialized?");
         TRY_AND_THROW_STREAM(enc_mat_b.validate(),
                              "The enc_mat_b_trans argument to " + api + " is invalid; has it been initialized?");
+        row_major_validation(enc_mat_a, api);
+        row_major_validation(enc_mat_b, api);
         if (enc_mat_a.encoding_unit() != enc_mat_b.encoding_unit()) {
             LOG_AND_THROW_STREAM("Inputs to " + api + " must have the same units: "
                                  << dim_string(enc_mat_a.encoding_unit())
@@ -693,34 +1399,40 @@ namespace hit {
             col_results[k] = matrix_matrix_mul_loop_col_major(enc_mat_a, enc_mat_b_trans, scalar, k);
         });
 
+        return combine_col_results(col_results, enc_mat_a.height(), enc_mat_a.encoding_unit());
+    }
+
+    EncryptedMatrix LinearAlgebra::combine_col_results(const vector<EncryptedRowVector> &col_results, int height,
+                                                       const EncodingUnit &unit) {
         // col_results[i] contains a *single* column (possibily distributed across several vertical cts)
         // containing the i^th column of A times the matrix B
         // The next step is to add unit.encoding_width of these together to make a single unit
-        EncodingUnit unit = enc_mat_a.encoding_unit();
-        int result_horizontal_units = ceil(enc_mat_b_trans.height() / static_cast<double>(unit.encoding_width()));
-        vector<vector<CKKSCiphertext>> matrix_cts(enc_mat_a.num_vertical_units());
+        int width = col_results.size();
+        int result_horizontal_units = ceil(width / static_cast<double>(unit.encoding_width()));
+        int result_vertical_units = col_results[0].cts.size();
+        vector<vector<CKKSCiphertext>> matrix_cts(result_vertical_units);
 
         // Proceed to append the individual column vectors one encoding unit row at a time
         for (int i = 0; i < result_horizontal_units; i++) {
             // this is the RowVector containing the first column of this vertical unit
             EncryptedRowVector unit_col_i_cts = col_results[i * unit.encoding_width()];
             for (int j = 1; j < unit.encoding_width(); j++) {
-                // there are exactly enc_mat_b_trans.height items in col_results, but this may not correspond
+                // there are exactly `width` items in col_results, but this may not correspond
                 // to the number of columns in the encoding units (because some rows at the end may be 0-padding)
                 // thus, we need to break once we add all the ciphertexts in col_results
                 // this will break out of the inner loop, but the outer loop will immediately exit because
                 // the inner loop can only break when i = result_horizontal_units-1
-                if (i * unit.encoding_width() + j >= enc_mat_b_trans.height()) {
+                if (i * unit.encoding_width() + j >= width) {
                     break;
                 }
                 add_inplace(unit_col_i_cts, col_results[i * unit.encoding_width() + j]);
             }
-            for (int j = 0; j < enc_mat_a.num_vertical_units(); j++) {
+            for (int j = 0; j < result_vertical_units; j++) {
                 matrix_cts[j].push_back(unit_col_i_cts.cts[j]);
             }
         }
 
-        return EncryptedMatrix(enc_mat_a.height(), enc_mat_b_trans.height(), unit, matrix_cts);
+        return EncryptedMatrix(height, width, unit, move(matrix_cts));
     }
 
     // common core for matrix/matrix multiplication; used by both multiply and multiply_unit_transpose
@@ -738,28 +1450,34 @@ namespace hit {
             row_results[k] = matrix_matrix_mul_loop_row_major(enc_mat_a_trans, enc_mat_b, scalar, k, transpose_unit);
         });
 
-        // row_results[i] contains a *single* row (possibily distributed across several cts)
-        // containing the i^th row of A times the matrix B
-        // The next step is to add unit.encoding_height of these together to make a single unit
         EncodingUnit unit = enc_mat_a_trans.encoding_unit();
 
         if (transpose_unit) {
             unit = unit.transpose();
         }
 
-        int result_vertical_units = ceil(enc_mat_a_trans.width() / static_cast<double>(unit.encoding_height()));
+        return combine_row_results(row_results, enc_mat_b.width(), unit);
+    }
+
+    EncryptedMatrix LinearAlgebra::combine_row_results(const vector<EncryptedColVector> &row_results, int width,
+                                                       const EncodingUnit &unit) {
+        // row_results[i] contains a *single* row (possibily distributed across several cts)
+        // containing the i^th row of A times the matrix B
+        // The next step is to add unit.encoding_height of these together to make a single unit
+        int height = row_results.size();
+        int result_vertical_units = ceil(height / static_cast<double>(unit.encoding_height()));
         vector<vector<CKKSCiphertext>> matrix_cts(result_vertical_units);
 
         for (int i = 0; i < result_vertical_units; i++) {
             // this is the ColVector containing the first row of this horizontal unit
             EncryptedColVector unit_row_i_cts = row_results[i * unit.encoding_height()];
             for (int j = 1; j < unit.encoding_height(); j++) {
-                // there are exactly enc_mat_a_trans.width items in row_results, but this may not correspond
+                // there are exactly `height` items in row_results, but this may not correspond
                 // to the number of rows in the encoding units (because some rows at the end may be 0-padding)
                 // thus, we need to break once we add all the ciphertexts in row_results
                 // this will break out of the inner loop, but the outer loop will immediately exit because
                 // the inner loop can only break when i = result_vertical_units-1
-                if (i * unit.encoding_height() + j >= enc_mat_a_trans.width()) {
+                if (i * unit.encoding_height() + j >= height) {
                     break;
                 }
                 add_inplace(unit_row_i_cts, row_results[i * unit.encoding_height() + j]);
@@ -767,7 +1485,7 @@ namespace hit {
             matrix_cts[i] = unit_row_i_cts.cts;
         }
 
-        return EncryptedMatrix(enc_mat_a_trans.width(), enc_mat_b.width(), unit, matrix_cts);
+        return EncryptedMatrix(height, width, unit, move(matrix_cts));
     }
 
     EncryptedMatrix LinearAlgebra::multiply_row_major(const EncryptedMatrix &enc_mat_a_trans,
@@ -819,9 +1537,531 @@ namespace hit {
         return multiply_common(enc_mat_a_trans, enc_mat_b, scalar, true);
     }
 
+    EncryptedMatrix LinearAlgebra::multiply_row_major_strassen(const EncryptedMatrix &enc_mat_a_trans,
+                                                               const EncryptedMatrix &enc_mat_b, double scalar,
+                                                               int cutoff) {
+        matrix_multiply_validation(enc_mat_a_trans, enc_mat_b, "multiply_row_major_strassen");
+        if (enc_mat_a_trans.he_level() != enc_mat_b.he_level() + 1) {
+            LOG_AND_THROW_STREAM(
+                "Second argument to multiply_row_major_strassen must be one level below first argument: "
+                << enc_mat_a_trans.he_level() << "!=" << enc_mat_b.he_level() << "+1");
+        }
+        if (enc_mat_a_trans.height() != enc_mat_b.height()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_row_major_strassen do not have compatible dimensions: "
+                                 << dim_string(enc_mat_a_trans) + " vs " + dim_string(enc_mat_b));
+        }
+        if (cutoff < 2) {
+            LOG_AND_THROW_STREAM("Cutoff for multiply_row_major_strassen must be at least 2, got " << cutoff);
+        }
+
+        return multiply_strassen(enc_mat_a_trans, enc_mat_b, scalar, cutoff);
+    }
+
+    EncryptedMatrix LinearAlgebra::multiply_strassen(const EncryptedMatrix &enc_mat_a_trans,
+                                                     const EncryptedMatrix &enc_mat_b, double scalar, int cutoff) {
+        EncodingUnit unit = enc_mat_a_trans.encoding_unit();
+        int unit_height = unit.encoding_height();
+        int unit_width = unit.encoding_width();
+
+        // A^T is g-by-f and B is g-by-h. The inner dimension g is split along the vertical units of A^T and B,
+        // and the right dimension h is split along the horizontal units of B and the output. The left dimension
+        // f is split along the horizontal units of A^T, but also along the vertical units of the output, so each
+        // half must consist of whole units of both sizes.
+        int inner_units = enc_mat_a_trans.num_vertical_units();
+        int right_units = enc_mat_b.num_horizontal_units();
+        int padded_left_dim = enc_mat_a_trans.num_horizontal_units() * unit_width;
+        int left_block_size = max(unit_height, unit_width);
+        int output_vertical_units = ceil(enc_mat_a_trans.width() / static_cast<double>(unit_height));
+        bool can_split = inner_units % 2 == 0 && right_units % 2 == 0 &&
+                         padded_left_dim == output_vertical_units * unit_height &&
+                         padded_left_dim % (2 * left_block_size) == 0;
+
+        if (!can_split || inner_units < cutoff || right_units < cutoff ||
+            padded_left_dim / left_block_size < cutoff) {
+            return multiply_common(enc_mat_a_trans, enc_mat_b, scalar, false);
+        }
+
+        int inner_block_units = inner_units / 2;
+        int left_block_units = enc_mat_a_trans.num_horizontal_units() / 2;
+        int right_block_units = right_units / 2;
+
+        // The (i,j) block of A^T is the transpose of the (j,i) block of A.
+        // Each block is padded with zeros to a whole number of units, so all blocks have the same size.
+        EncryptedMatrix a11_trans = matrix_block(enc_mat_a_trans, 0, 0, inner_block_units, left_block_units);
+        EncryptedMatrix a21_trans = matrix_block(enc_mat_a_trans, 0, 1, inner_block_units, left_block_units);
+        EncryptedMatrix a12_trans = matrix_block(enc_mat_a_trans, 1, 0, inner_block_units, left_block_units);
+        EncryptedMatrix a22_trans = matrix_block(enc_mat_a_trans, 1, 1, inner_block_units, left_block_units);
+        EncryptedMatrix b11 = matrix_block(enc_mat_b, 0, 0, inner_block_units, right_block_units);
+        EncryptedMatrix b12 = matrix_block(enc_mat_b, 0, 1, inner_block_units, right_block_units);
+        EncryptedMatrix b21 = matrix_block(enc_mat_b, 1, 0, inner_block_units, right_block_units);
+        EncryptedMatrix b22 = matrix_block(enc_mat_b, 1, 1, inner_block_units, right_block_units);
+
+        // Winograd's form of Strassen's algorithm: seven products and fifteen additions.
+        // Additions don't consume a level, so each product is at the same level as in multiply_row_major.
+        EncryptedMatrix s1_trans = add(a21_trans, a22_trans);
+        EncryptedMatrix s2_trans = sub(s1_trans, a11_trans);
+        EncryptedMatrix s3_trans = sub(a11_trans, a21_trans);
+        EncryptedMatrix s4_trans = sub(a12_trans, s2_trans);
+        EncryptedMatrix t1 = sub(b12, b11);
+        EncryptedMatrix t2 = sub(b22, t1);
+        EncryptedMatrix t3 = sub(b22, b12);
+        EncryptedMatrix t4 = sub(t2, b21);
+
+        EncryptedMatrix m1 = multiply_strassen(a11_trans, b11, scalar, cutoff);
+        EncryptedMatrix m2 = multiply_strassen(a12_trans, b21, scalar, cutoff);
+        EncryptedMatrix m3 = multiply_strassen(s4_trans, b22, scalar, cutoff);
+        EncryptedMatrix m4 = multiply_strassen(a22_trans, t4, scalar, cutoff);
+        EncryptedMatrix m5 = multiply_strassen(s1_trans, t1, scalar, cutoff);
+        EncryptedMatrix m6 = multiply_strassen(s2_trans, t2, scalar, cutoff);
+        EncryptedMatrix m7 = multiply_strassen(s3_trans, t3, scalar, cutoff);
+
+        EncryptedMatrix u2 = add(m1, m6);
+        EncryptedMatrix u3 = add(u2, m7);
+        EncryptedMatrix u4 = add(u2, m5);
+
+        return combine_blocks(add(m1, m2), add(u4, m3), sub(u3, m4), add(u3, m5), enc_mat_a_trans.width(),
+                              enc_mat_b.width());
+    }
+
+    EncryptedMatrix LinearAlgebra::matrix_block(const EncryptedMatrix &enc_mat, int i, int j,
+                                                int block_vertical_units, int block_horizontal_units) {
+        vector<CKKSCiphertext> block_cts;
+        block_cts.reserve(block_vertical_units * block_horizontal_units);
+        for (int k = 0; k < block_vertical_units; k++) {
+            auto unit_row = enc_mat.cts.begin() + enc_mat.unit_index(i * block_vertical_units + k, 0);
+            block_cts.insert(block_cts.end(), unit_row + j * block_horizontal_units,
+                             unit_row + (j + 1) * block_horizontal_units);
+        }
+        EncodingUnit unit = enc_mat.encoding_unit();
+        return EncryptedMatrix(block_vertical_units * unit.encoding_height(),
+                               block_horizontal_units * unit.encoding_width(), unit, block_horizontal_units,
+                               move(block_cts));
+    }
+
+    EncryptedMatrix LinearAlgebra::combine_blocks(const EncryptedMatrix &c11, const EncryptedMatrix &c12,
+                                                  const EncryptedMatrix &c21, const EncryptedMatrix &c22, int height,
+                                                  int width) {
+        int num_horizontal_units = c11.num_horizontal_units() + c12.num_horizontal_units();
+        vector<CKKSCiphertext> cts;
+        cts.reserve((c11.num_vertical_units() + c21.num_vertical_units()) * num_horizontal_units);
+        for (const auto &block_row : {make_pair(&c11, &c12), make_pair(&c21, &c22)}) {
+            for (int k = 0; k < block_row.first->num_vertical_units(); k++) {
+                for (const EncryptedMatrix *block : {block_row.first, block_row.second}) {
+                    cts.insert(cts.end(), block->cts.begin() + block->unit_index(k, 0),
+                               block->cts.begin() + block->unit_index(k + 1, 0));
+                }
+            }
+        }
+        return EncryptedMatrix(height, width, c11.encoding_unit(), num_horizontal_units, move(cts));
+    }
+
+    EncryptedMatrix LinearAlgebra::multiply_plain(const EncryptedMatrix &enc_mat_a, const Matrix &mat_b,
+                                                  double scalar) {
+        TRY_AND_THROW_STREAM(enc_mat_a.validate(),
+                             "The EncryptedMatrix argument to multiply_plain is invalid; has it been initialized?");
+        row_major_validation(enc_mat_a, "multiply_plain");
+        if (enc_mat_a.width() != mat_b.size1()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_plain do not have compatible dimensions: "
+                                 << dim_string(enc_mat_a) << " vs plaintext " << mat_b.size1() << "x"
+                                 << mat_b.size2());
+        }
+        if (enc_mat_a.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must have nominal scale.");
+        }
+        if (enc_mat_a.needs_relin()) {
+            LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must be a linear ciphertext.");
+        }
+
+        EncodingUnit unit = enc_mat_a.encoding_unit();
+
+        // Multiply the matrix A by each column of B, as in multiply_col_major. Since B is public,
+        // the encoding of the k^th column of B is just a plaintext, so there is no need to extract
+        // it from an encryption of B^T.
+        vector<EncryptedRowVector> col_results(mat_b.size2());
+
+        parallel_for(mat_b.size2(), [&](int k) {
+            Vector kth_col_b(mat_b.size1());
+            for (int i = 0; i < mat_b.size1(); i++) {
+                kth_col_b[i] = mat_b(i, k);
+            }
+            vector<Matrix> encoded_col = encode_col_vector(kth_col_b, unit);
+
+            vector<vector<CKKSCiphertext>> cts(enc_mat_a.num_vertical_units(),
+                                               vector<CKKSCiphertext>(enc_mat_a.num_horizontal_units()));
+            for (int i = 0; i < enc_mat_a.num_vertical_units(); i++) {
+                for (int j = 0; j < enc_mat_a.num_horizontal_units(); j++) {
+                    // multiplying by an all-zero plaintext yields a transparent ciphertext, which SEAL rejects
+                    if (is_zero_matrix(encoded_col[j])) {
+                        cts[i][j] = eval.multiply_plain(enc_mat_a.unit_ct(i, j), 0);
+                    } else {
+                        cts[i][j] = eval.multiply_plain(enc_mat_a.unit_ct(i, j), encoded_col[j].data());
+                    }
+                    eval.rescale_to_next_inplace(cts[i][j]);
+                }
+            }
+
+            EncryptedMatrix prod(enc_mat_a.height(), enc_mat_a.width(), unit, move(cts));
+            // a unit of the product is zero if either factor is zero
+            for (int i = 0; i < enc_mat_a.num_vertical_units(); i++) {
+                for (int j = 0; j < enc_mat_a.num_horizontal_units(); j++) {
+                    prod.set_zero_ct(i * prod.num_horizontal_units() + j,
+                                     enc_mat_a.is_zero_unit(i, j) || is_zero_matrix(encoded_col[j]));
+                }
+            }
+            prod.zero_padded = enc_mat_a.is_zero_padded();
+            col_results[k] = mask_col(prod, scalar, k);
+        });
+
+        return combine_col_results(col_results, enc_mat_a.height(), unit);
+    }
+
+    EncryptedMatrix LinearAlgebra::multiply_plain(const Matrix &mat_a, const EncryptedMatrix &enc_mat_b,
+                                                  double scalar) {
+        TRY_AND_THROW_STREAM(enc_mat_b.validate(),
+                             "The EncryptedMatrix argument to multiply_plain is invalid; has it been initialized?");
+        row_major_validation(enc_mat_b, "multiply_plain");
+        if (mat_a.size2() != enc_mat_b.height()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_plain do not have compatible dimensions: plaintext "
+                                 << mat_a.size1() << "x" << mat_a.size2() << " vs " << dim_string(enc_mat_b));
+        }
+        if (enc_mat_b.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must have nominal scale.");
+        }
+        if (enc_mat_b.needs_relin()) {
+            LOG_AND_THROW_STREAM("Encrypted input to multiply_plain must be a linear ciphertext.");
+        }
+
+        EncodingUnit unit = enc_mat_b.encoding_unit();
+
+        // Multiply each row of A by the matrix B, as in multiply_row_major. Since A is public,
+        // the encoding of the k^th row of A is just a plaintext, so there is no need to extract
+        // it from an encryption of A^T.
+        vector<EncryptedColVector> row_results(mat_a.size1());
+
+        parallel_for(mat_a.size1(), [&](int k) {
+            Vector kth_row_a(mat_a.size2());
+            for (int j = 0; j < mat_a.size2(); j++) {
+                kth_row_a[j] = mat_a(k, j);
+            }
+            vector<Matrix> encoded_row = encode_row_vector(kth_row_a, unit);
+
+            vector<vector<CKKSCiphertext>> cts(enc_mat_b.num_vertical_units(),
+                                               vector<CKKSCiphertext>(enc_mat_b.num_horizontal_units()));
+            for (int i = 0; i < enc_mat_b.num_vertical_units(); i++) {
+                for (int j = 0; j < enc_mat_b.num_horizontal_units(); j++) {
+                    // multiplying by an all-zero plaintext yields a transparent ciphertext, which SEAL rejects
+                    if (is_zero_matrix(encoded_row[i])) {
+                        cts[i][j] = eval.multiply_plain(enc_mat_b.unit_ct(i, j), 0);
+                    } else {
+                        cts[i][j] = eval.multiply_plain(enc_mat_b.unit_ct(i, j), encoded_row[i].data());
+                    }
+                    // rescaling before summing the rows makes the rotations cheaper
+                    eval.rescale_to_next_inplace(cts[i][j]);
+                }
+            }
+
+            EncryptedMatrix prod(enc_mat_b.height(), enc_mat_b.width(), unit, move(cts));
+            // a unit of the product is zero if either factor is zero
+            for (int i = 0; i < enc_mat_b.num_vertical_units(); i++) {
+                for (int j = 0; j < enc_mat_b.num_horizontal_units(); j++) {
+                    prod.set_zero_ct(i * prod.num_horizontal_units() + j,
+                                     enc_mat_b.is_zero_unit(i, j) || is_zero_matrix(encoded_row[i]));
+                }
+            }
+            prod.zero_padded = enc_mat_b.is_zero_padded();
+            row_results[k] = sum_rows(prod);
+            mask_row_inplace(row_results[k], scalar, k, false);
+        });
+
+        return combine_row_results(row_results, enc_mat_b.width(), unit);
+    }
+
+    EncryptedMatrix LinearAlgebra::multiply_square(const EncryptedMatrix &enc_mat_a, const EncryptedMatrix &enc_mat_b,
+                                                   double scalar) {
+        matrix_multiply_validation(enc_mat_a, enc_mat_b, "multiply_square");
+        if (enc_mat_a.he_level() != enc_mat_b.he_level()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_square must be at the same level: "
+                                 << enc_mat_a.he_level() << "!=" << enc_mat_b.he_level());
+        }
+        if (enc_mat_a.width() != enc_mat_b.height()) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_square do not have compatible dimensions: "
+                                 << dim_string(enc_mat_a) + " vs " + dim_string(enc_mat_b));
+        }
+
+        EncodingUnit unit = enc_mat_a.encoding_unit();
+        int d = max(enc_mat_a.height(), max(enc_mat_a.width(), enc_mat_b.width()));
+        if (d > min(unit.encoding_height(), unit.encoding_width())) {
+            LOG_AND_THROW_STREAM("Inputs to multiply_square must fit in a single square block of the encoding unit: "
+                                 << dim_string(enc_mat_a) + " and " + dim_string(enc_mat_b));
+        }
+
+        // Each input is a single unit holding a d-by-d matrix (padded with zeros) in its top-left corner.
+        // Using the notation of JKLS'18, A*B = sum_{k=0}^{d-1} phi^k(sigma(A)) (.) psi^k(tau(B)), where
+        //   sigma(A)_{i,j} = A_{i,i+j}
+        //   tau(B)_{i,j} = B_{i+j,j}
+        //   phi^k(A)_{i,j} = A_{i,j+k}
+        //   psi^k(B)_{i,j} = B_{i+k,j}
+        // and all indices are modulo d. Each of these permutations is a sum of masked rotations.
+        int width = unit.encoding_width();
+        int out_level = enc_mat_a.he_level() - 2;
+
+        // the scalar is folded into the sigma masks, so scaling the product is free
+        CKKSCiphertext a_0 = masked_rotation_sum(
+            enc_mat_a.unit_ct(0, 0),
+            permutation_masks(d, unit, scalar, [&](int i, int j) { return i * width + (i + j) % d; }));
+        CKKSCiphertext b_0 = masked_rotation_sum(
+            enc_mat_b.unit_ct(0, 0),
+            permutation_masks(d, unit, 1, [&](int i, int j) { return ((i + j) % d) * width + j; }));
+
+        vector<CKKSCiphertext> prods(d);
+        parallel_for(d, [&](int k) {
+            CKKSCiphertext a_k;
+            CKKSCiphertext b_k;
+            if (k == 0) {
+                a_k = eval.reduce_level_to(a_0, out_level);
+                b_k = eval.reduce_level_to(b_0, out_level);
+            } else {
+                a_k = masked_rotation_sum(
+                    a_0, permutation_masks(d, unit, 1, [&](int i, int j) { return i * width + (j + k) % d; }));
+                if (d == unit.encoding_height()) {
+                    // when the matrix fills the unit vertically, psi^k is just a rotation,
+                    // so no mask (and no level) is needed
+                    b_k = rotate_left_shortest(eval.reduce_level_to(b_0, out_level), k * width);
+                } else {
+                    b_k = masked_rotation_sum(
+                        b_0, permutation_masks(d, unit, 1, [&](int i, int j) { return ((i + k) % d) * width + j; }));
+                }
+            }
+            prods[k] = eval.multiply(a_k, b_k);
+        });
+
+        // relinearize once, after summing all of the products
+        CKKSCiphertext result = eval.add_many(prods);
+        eval.relinearize_inplace(result);
+
+        return EncryptedMatrix(enc_mat_a.height(), enc_mat_b.width(), unit,
+                               vector<vector<CKKSCiphertext>>{vector<CKKSCiphertext>{result}});
+    }
+
+    map<int, vector<double>> LinearAlgebra::permutation_masks(int d, const EncodingUnit &unit, double scalar,
+                                                              const function<int(int, int)> &src) {
+        int num_slots = unit.encoding_height() * unit.encoding_width();
+        map<int, vector<double>> masks;
+
+        for (int i = 0; i < d; i++) {
+            for (int j = 0; j < d; j++) {
+                int dest = i * unit.encoding_width() + j;
+                // rotating left by `steps` moves the value in slot `src` to slot `dest`
+                int steps = ((src(i, j) - dest) % num_slots + num_slots) % num_slots;
+                if (masks.find(steps) == masks.end()) {
+                    masks[steps] = vector<double>(num_slots, 0);
+                }
+                masks[steps][dest] = scalar;
+            }
+        }
+        return masks;
+    }
+
+    CKKSCiphertext LinearAlgebra::masked_rotation_sum(const CKKSCiphertext &ct,
+                                                      const map<int, vector<double>> &masked_rotations) {
+        vector<const pair<const int, vector<double>> *> terms;
+        for (const auto &term : masked_rotations) {
+            terms.push_back(&term);
+        }
+
+        vector<CKKSCiphertext> masked_cts(terms.size());
+        parallel_for(terms.size(), [&](int i) {
+            masked_cts[i] = eval.multiply_plain(rotate_left_shortest(ct, terms[i]->first), terms[i]->second);
+        });
+
+        CKKSCiphertext output = eval.add_many(masked_cts);
+        eval.rescale_to_next_inplace(output);
+        return output;
+    }
+
+    CKKSCiphertext LinearAlgebra::rotate_left_shortest(const CKKSCiphertext &ct, int steps) {
+        int num_slots = ct.num_slots();
+        steps = (steps % num_slots + num_slots) % num_slots;
+        if (steps == 0) {
+            return ct;
+        }
+        if (steps <= num_slots / 2) {
+            return eval.rotate_left(ct, steps);
+        }
+        return eval.rotate_right(ct, num_slots - steps);
+    }
+
+    int LinearAlgebra::rotation_cost(int steps, int num_slots) {
+        steps = (steps % num_slots + num_slots) % num_slots;
+        if (steps > num_slots / 2) {
+            steps = num_slots - steps;
+        }
+        // SEAL decomposes a rotation into power-of-two rotations using the non-adjacent form of `steps`
+        int cost = 0;
+        while (steps != 0) {
+            if (steps % 2 != 0) {
+                steps -= 2 - (steps % 4);
+                cost++;
+            }
+            steps /= 2;
+        }
+        return cost;
+    }
+
+    MatrixMultiplyKernel LinearAlgebra::plan_multiply(int left_dim, int inner_dim, int right_dim,
+                                                      const EncodingUnit &unit, int level) const {
+        if (left_dim <= 0 || inner_dim <= 0 || right_dim <= 0) {
+            LOG_AND_THROW_STREAM("Dimensions for plan_multiply must be positive: " << left_dim << ", " << inner_dim
+                                                                                   << ", " << right_dim);
+        }
+        // multiply_row_major and multiply_col_major take one input at `level` and the other at `level`-1, and
+        // multiply_square takes both inputs at `level`. Each of them outputs a ciphertext with a squared scale at
+        // `level`-2, which must be rescaled before it can be used, so every kernel requires `level` >= 3.
+        if (level < 3) {
+            LOG_AND_THROW_STREAM("Matrix multiplication requires inputs at level 3 or higher, got " << level);
+        }
+
+        int m = unit.encoding_height();
+        int n = unit.encoding_width();
+
+        // Use the same model as estimate_cost, where the cost of a key switch is proportional to the number of
+        // primes in the ciphertext modulus, so an operation at level j is weighted by j+1.
+        double row_major_cost = 0;
+        estimate_op_cost(LinearAlgebraOp{OP_MATMUL_ROW_MAJOR, left_dim, inner_dim, right_dim}, unit, level,
+                         row_major_cost);
+        double col_major_cost = 0;
+        estimate_op_cost(LinearAlgebraOp{OP_MATMUL_COL_MAJOR, left_dim, inner_dim, right_dim}, unit, level,
+                         col_major_cost);
+
+        MatrixMultiplyKernel best = row_major_cost <= col_major_cost ? MATMUL_ROW_MAJOR : MATMUL_COL_MAJOR;
+        double best_cost = min(row_major_cost, col_major_cost);
+
+        int d = max(left_dim, max(inner_dim, right_dim));
+        if (d <= min(m, n)) {
+            int num_slots = m * n;
+            // a rotation which the evaluator has a key for costs a single key switch
+            auto rotation_key_switches = [&](int steps, int slots) {
+                if (steps == 0) {
+                    return 0;
+                }
+                return eval.has_rotation_key(steps) ? 1 : rotation_cost(steps, slots);
+            };
+            // the cost of applying a permutation of a d-by-d block at a ciphertext at level j (see multiply_square)
+            auto permutation_cost = [&](const function<int(int, int)> &src, int j) {
+                set<int> steps;
+                for (int r = 0; r < d; r++) {
+                    for (int c = 0; c < d; c++) {
+                        steps.insert(((src(r, c) - (r * n + c)) % num_slots + num_slots) % num_slots);
+                    }
+                }
+                double cost = 0;
+                for (int s : steps) {
+                    cost += rotation_key_switches(s, num_slots);
+                }
+                return cost * (j + 1);
+            };
+
+            // sigma(A) and tau(B) at level i, then phi^k and psi^k at level i-1, and a single relinearization
+            double square_cost = permutation_cost([&](int r, int c) { return r * n + (r + c) % d; }, level) +
+                                 permutation_cost([&](int r, int c) { return ((r + c) % d) * n + c; }, level) +
+                                 (level - 1);
+            for (int k = 1; k < d; k++) {
+                square_cost += permutation_cost([&](int r, int c) { return r * n + (c + k) % d; }, level - 1);
+                if (d == m) {
+                    square_cost += rotation_key_switches(k * n, num_slots) * (level - 1);
+                } else {
+                    square_cost +=
+                        permutation_cost([&](int r, int c) { return ((r + k) % d) * n + c; }, level - 1);
+                }
+            }
+
+            if (square_cost < best_cost) {
+                best = MATMUL_SQUARE;
+            }
+        }
+
+        return best;
+    }
+
+    EncryptedMatrix LinearAlgebra::gram(const EncryptedMatrix &enc_mat) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to gram is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "gram");
+        if (enc_mat.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Input to gram must have nominal scale");
+        }
+        if (enc_mat.needs_relin()) {
+            LOG_AND_THROW_STREAM("Input to gram must be a linear ciphertext");
+        }
+        EncodingUnit unit = enc_mat.encoding_unit();
+        int n = unit.encoding_width();
+        int width = enc_mat.width();
+        if (enc_mat.num_horizontal_units() != 1 || 2 * width > n || !enc_mat.is_zero_padded()) {
+            // The diagonal kernel below requires a zero-padded input which is at most half as wide as its unit.
+            // Otherwise, X^T*X = A*B where A^T = B = X.
+            return multiply_row_major(enc_mat, reduce_level_to(enc_mat, enc_mat.he_level() - 1));
+        }
+
+        // Let X be the input and G = X^T*X. The k^th (generalized) diagonal of G is
+        //   d_k[t] = G[t][t+k] = sum_s X[s][t] * X[s][t+k],
+        // so it is the sum of the rows of X (.) rot(X, k). Since X is at most n/2 columns wide, the
+        // rotation never brings a non-zero entry from the next row into the product. The output is
+        // replicated in every row of the unit, as required by the diagonal layout. G is symmetric, so
+        //   d_{n-k}[t] = G[t][t-k] = G[t-k][t] = d_k[t-k],
+        // i.e., each of the lower diagonals is a rotation of one of the upper diagonals. Diagonals k with
+        // width <= k <= n-width are zero.
+        int baby_steps = diagonal_baby_steps(n);
+        auto giant_step = [&](int k) { return (k / baby_steps) * baby_steps; };
+
+        vector<int> nonzero_rows;
+        for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
+            if (!enc_mat.is_zero_unit(i, 0)) {
+                nonzero_rows.push_back(i);
+            }
+        }
+
+        auto is_zero_diag = [&](int k) { return nonzero_rows.empty() || (k >= width && k <= n - width); };
+
+        vector<CKKSCiphertext> diags(n);
+        if (!nonzero_rows.empty()) {
+            parallel_for(width, [&](int k) {
+                vector<CKKSCiphertext> prods(nonzero_rows.size());
+                for (int r = 0; r < nonzero_rows.size(); r++) {
+                    const CKKSCiphertext &ct = enc_mat.unit_ct(nonzero_rows[r], 0);
+                    prods[r] = k == 0 ? eval.square(ct) : eval.multiply(ct, eval.rotate_left(ct, k));
+                }
+                CKKSCiphertext diag = eval.add_many(prods);
+                eval.relinearize_inplace(diag);
+                rot(diag, unit.encoding_height(), n, true);
+
+                // apply the pre-rotation expected by the diagonal layout (see encode_diagonals)
+                diags[k] = giant_step(k) == 0 ? diag : eval.rotate_right(diag, giant_step(k));
+                if (k > 0) {
+                    diags[n - k] = eval.rotate_right(diag, (k + giant_step(n - k)) % n);
+                }
+            });
+        }
+
+        // zero diagonals only need the right level and scale
+        CKKSCiphertext zero = eval.multiply_plain(enc_mat.unit_ct(0, 0), 0);
+        for (int k = 0; k < n; k++) {
+            if (is_zero_diag(k)) {
+                diags[k] = zero;
+            }
+        }
+
+        EncryptedMatrix result(width, width, unit, vector<vector<CKKSCiphertext>>{diags}, LAYOUT_DIAGONAL);
+        for (int k = 0; k < n; k++) {
+            result.set_zero_ct(k, is_zero_diag(k));
+        }
+        result.zero_padded = true;
+        return result;
+    }
+
     void LinearAlgebra::transpose_unit_inplace(EncryptedMatrix &enc_mat) {
         TRY_AND_THROW_STREAM(enc_mat.validate(),
                              "The enc_mat argument to transpose_unit is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "transpose_unit");
         // input is encoded with an m-by-n unit where we require m <= n
         EncodingUnit unit = enc_mat.encoding_unit();
         if (unit.encoding_height() > unit.encoding_width()) {
@@ -835,6 +2075,8 @@ namespace hit {
                                  << unit.encoding_height() << "-by-" << unit.encoding_width() << " unit");
         }
         enc_mat.unit = enc_mat.unit.transpose();
+        // the ciphertext is reinterpreted, so the padding of the new unit need not be zero
+        enc_mat.zero_padded = false;
     }
 
     void LinearAlgebra::transpose_unit_inplace(EncryptedColVector &enc_vec) {
@@ -855,24 +2097,466 @@ namespace hit {
         enc_vec.unit = enc_vec.unit.transpose();
     }
 
+    EncryptedMatrix LinearAlgebra::reencode(const EncryptedMatrix &enc_mat, const EncodingUnit &unit) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to reencode is invalid; has it been initialized?");
+        return reencode_matrix(enc_mat, unit, false, "reencode");
+    }
+
+    EncryptedMatrix LinearAlgebra::transpose(const EncryptedMatrix &enc_mat) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to transpose is invalid; has it been initialized?");
+        return reencode_matrix(enc_mat, enc_mat.encoding_unit(), true, "transpose");
+    }
+
+    EncryptedMatrix LinearAlgebra::reencode_matrix(const EncryptedMatrix &enc_mat, const EncodingUnit &unit,
+                                                   bool transpose, const string &api) {
+        if (transpose) {
+            row_major_validation(enc_mat, api);
+        }
+        if (unit.encoding_height() * unit.encoding_width() != enc_mat.num_slots()) {
+            LOG_AND_THROW_STREAM("Encoding unit for " << api << " must have " << enc_mat.num_slots() << " slots, got "
+                                                      << dim_string(unit));
+        }
+        if (enc_mat.needs_rescale()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must have nominal scale");
+        }
+        if (enc_mat.needs_relin()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must be a linear ciphertext");
+        }
+
+        EncodingUnit in_unit = enc_mat.encoding_unit();
+        int in_horizontal_units = enc_mat.num_horizontal_units();
+        int out_height = transpose ? enc_mat.width() : enc_mat.height();
+        int out_width = transpose ? enc_mat.height() : enc_mat.width();
+        int out_vertical_units = ceil(out_height / static_cast<double>(unit.encoding_height()));
+        int out_horizontal_units = ceil(out_width / static_cast<double>(unit.encoding_width()));
+
+        vector<bool> in_zero(enc_mat.num_cts());
+        for (int k = 0; k < enc_mat.num_cts(); k++) {
+            in_zero[k] = enc_mat.is_zero_ct(k);
+        }
+        int in_height = in_unit.encoding_height();
+        int in_width = in_unit.encoding_width();
+        int baby_steps = diagonal_baby_steps(in_width);
+        // slot `slot` of input unit k holds entry (r, c) of the matrix; find its unit and slot in the output
+        auto target = [&](int k, int slot) {
+            int r;
+            int c;
+            if (enc_mat.layout() == LAYOUT_DIAGONAL) {
+                // unit (i, j*n+d) holds diagonal d of block (i, j), pre-rotated by its giant step and replicated
+                // in every row of the unit (see encode_diagonals). Only the copy in the row of the unit which
+                // matches the row of the entry is moved, so each entry moves within its row.
+                int d = (k % in_horizontal_units) % in_width;
+                int t = (slot % in_width - (d / baby_steps) * baby_steps + in_width) % in_width;
+                r = (k / in_horizontal_units) * in_width + t;
+                c = ((k % in_horizontal_units) / in_width) * in_width + (t + d) % in_width;
+                if (slot / in_width != r % in_height) {
+                    return make_pair(-1, 0);
+                }
+            } else {
+                r = (k / in_horizontal_units) * in_height + slot / in_width;
+                c = (k % in_horizontal_units) * in_width + slot % in_width;
+            }
+            if (r >= enc_mat.height() || c >= enc_mat.width()) {
+                return make_pair(-1, 0);
+            }
+            if (transpose) {
+                swap(r, c);
+            }
+            return make_pair((r / unit.encoding_height()) * out_horizontal_units + c / unit.encoding_width(),
+                             (r % unit.encoding_height()) * unit.encoding_width() + c % unit.encoding_width());
+        };
+        vector<bool> out_zero;
+        vector<CKKSCiphertext> out_cts =
+            repack(enc_mat.cts, in_zero, out_vertical_units * out_horizontal_units, target, out_zero);
+
+        EncryptedMatrix result(out_height, out_width, unit, out_horizontal_units, move(out_cts));
+        for (int k = 0; k < result.num_cts(); k++) {
+            result.set_zero_ct(k, out_zero[k]);
+        }
+        // only the entries of the matrix are moved, so the padding is zero even if the input padding is not
+        result.zero_padded = true;
+        return result;
+    }
+
+    EncryptedMatrix LinearAlgebra::unit_block(const EncryptedMatrix &enc_mat, int first_row, int num_rows,
+                                              int first_col, int num_cols) {
+        TRY_AND_THROW_STREAM(enc_mat.validate(),
+                             "The EncryptedMatrix argument to unit_block is invalid; has it been initialized?");
+        row_major_validation(enc_mat, "unit_block");
+        if (first_row < 0 || num_rows <= 0 || first_row + num_rows > enc_mat.num_vertical_units() || first_col < 0 ||
+            num_cols <= 0 || first_col + num_cols > enc_mat.num_horizontal_units()) {
+            LOG_AND_THROW_STREAM("Block of units for unit_block is out of range: rows ["
+                                 << first_row << ", " << first_row + num_rows << ") and columns [" << first_col << ", "
+                                 << first_col + num_cols << ") of a " << enc_mat.num_vertical_units() << "-by-"
+                                 << enc_mat.num_horizontal_units() << " grid");
+        }
+        EncodingUnit unit = enc_mat.encoding_unit();
+        bool last_row = first_row + num_rows == enc_mat.num_vertical_units();
+        bool last_col = first_col + num_cols == enc_mat.num_horizontal_units();
+        int height =
+            last_row ? enc_mat.height() - first_row * unit.encoding_height() : num_rows * unit.encoding_height();
+        int width = last_col ? enc_mat.width() - first_col * unit.encoding_width() : num_cols * unit.encoding_width();
+
+        vector<CKKSCiphertext> cts;
+        cts.reserve(num_rows * num_cols);
+        for (int i = 0; i < num_rows; i++) {
+            auto unit_row = enc_mat.cts.begin() + enc_mat.unit_index(first_row + i, first_col);
+            cts.insert(cts.end(), unit_row, unit_row + num_cols);
+        }
+        EncryptedMatrix result(height, width, unit, num_cols, move(cts));
+        for (int i = 0; i < num_rows; i++) {
+            for (int j = 0; j < num_cols; j++) {
+                result.set_zero_ct(i * num_cols + j, enc_mat.is_zero_unit(first_row + i, first_col + j));
+            }
+        }
+        // a block which doesn't reach the last row or column of units has no padding
+        result.zero_padded = enc_mat.is_zero_padded() || (!last_row && !last_col);
+        return result;
+    }
+
+    EncryptedMatrix LinearAlgebra::concat_horizontal(const vector<EncryptedMatrix> &enc_mats) {
+        return concat_matrices(enc_mats, true);
+    }
+
+    EncryptedMatrix LinearAlgebra::concat_vertical(const vector<EncryptedMatrix> &enc_mats) {
+        return concat_matrices(enc_mats, false);
+    }
+
+    EncryptedMatrix LinearAlgebra::concat_matrices(const vector<EncryptedMatrix> &enc_mats, bool horizontal) {
+        string api = horizontal ? "concat_horizontal" : "concat_vertical";
+        if (enc_mats.empty()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must be non-empty");
+        }
+        const EncryptedMatrix &first = enc_mats[0];
+        EncodingUnit unit = first.encoding_unit();
+        int unit_dim = horizontal ? unit.encoding_width() : unit.encoding_height();
+        int concat_dim = 0;
+        for (int k = 0; k < enc_mats.size(); k++) {
+            TRY_AND_THROW_STREAM(enc_mats[k].validate(),
+                                 "The EncryptedMatrix arguments to " << api
+                                                                     << " are invalid; have they been initialized?");
+            row_major_validation(enc_mats[k], api);
+            if (enc_mats[k].encoding_unit() != unit) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same encoding unit, but "
+                                                  << dim_string(enc_mats[k].encoding_unit())
+                                                  << "!=" << dim_string(unit));
+            }
+            int shared_dim = horizontal ? enc_mats[k].height() : enc_mats[k].width();
+            int first_shared_dim = horizontal ? first.height() : first.width();
+            if (shared_dim != first_shared_dim) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same " << (horizontal ? "height" : "width")
+                                                  << ", but " << shared_dim << "!=" << first_shared_dim);
+            }
+            int dim = horizontal ? enc_mats[k].width() : enc_mats[k].height();
+            if (k + 1 < enc_mats.size() && dim % unit_dim != 0) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must be aligned to the encoding unit, but input " << k
+                                                  << " has dimension " << dim << ", which is not a multiple of "
+                                                  << unit_dim);
+            }
+            if (enc_mats[k].he_level() != first.he_level() || enc_mats[k].scale() != first.scale()) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same level and scale");
+            }
+            concat_dim += dim;
+        }
+
+        vector<vector<CKKSCiphertext>> cts;
+        vector<vector<bool>> zero_units;
+        if (horizontal) {
+            cts.resize(first.num_vertical_units());
+            zero_units.resize(first.num_vertical_units());
+        }
+        for (const auto &enc_mat : enc_mats) {
+            for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
+                if (!horizontal) {
+                    cts.emplace_back();
+                    zero_units.emplace_back();
+                }
+                vector<CKKSCiphertext> &row = horizontal ? cts[i] : cts.back();
+                vector<bool> &zero_row = horizontal ? zero_units[i] : zero_units.back();
+                for (int j = 0; j < enc_mat.num_horizontal_units(); j++) {
+                    row.push_back(enc_mat.unit_ct(i, j));
+                    zero_row.push_back(enc_mat.is_zero_unit(i, j));
+                }
+            }
+        }
+
+        EncryptedMatrix result(horizontal ? first.height() : concat_dim, horizontal ? concat_dim : first.width(), unit,
+                               move(cts));
+        for (int i = 0; i < zero_units.size(); i++) {
+            for (int j = 0; j < zero_units[i].size(); j++) {
+                result.set_zero_ct(i * zero_units[i].size() + j, zero_units[i][j]);
+            }
+        }
+        // the padding of the output is the padding of the inputs
+        result.zero_padded = all_of(enc_mats.begin(), enc_mats.end(),
+                                    [](const EncryptedMatrix &enc_mat) { return enc_mat.is_zero_padded(); });
+        return result;
+    }
+
+    EncryptedRowVector LinearAlgebra::reencode(const EncryptedRowVector &enc_vec, const EncodingUnit &unit) {
+        TRY_AND_THROW_STREAM(enc_vec.validate(),
+                             "The EncryptedRowVector argument to reencode is invalid; has it been initialized?");
+        vector<CKKSCiphertext> cts =
+            reencode_vector(enc_vec.cts, enc_vec.width(), enc_vec.encoding_unit(), true, unit, true, "reencode");
+        return EncryptedRowVector(enc_vec.width(), unit, move(cts));
+    }
+
+    EncryptedColVector LinearAlgebra::reencode(const EncryptedColVector &enc_vec, const EncodingUnit &unit) {
+        TRY_AND_THROW_STREAM(enc_vec.validate(),
+                             "The EncryptedColVector argument to reencode is invalid; has it been initialized?");
+        vector<CKKSCiphertext> cts =
+            reencode_vector(enc_vec.cts, enc_vec.height(), enc_vec.encoding_unit(), false, unit, false, "reencode");
+        return EncryptedColVector(enc_vec.height(), unit, move(cts));
+    }
+
+    EncryptedColVector LinearAlgebra::reencode_as_col_vector(const EncryptedRowVector &enc_vec,
+                                                             const EncodingUnit &unit) {
+        TRY_AND_THROW_STREAM(
+            enc_vec.validate(),
+            "The EncryptedRowVector argument to reencode_as_col_vector is invalid; has it been initialized?");
+        vector<CKKSCiphertext> cts = reencode_vector(enc_vec.cts, enc_vec.width(), enc_vec.encoding_unit(), true,
+                                                     unit, false, "reencode_as_col_vector");
+        return EncryptedColVector(enc_vec.width(), unit, move(cts));
+    }
+
+    EncryptedRowVector LinearAlgebra::reencode_as_row_vector(const EncryptedColVector &enc_vec,
+                                                             const EncodingUnit &unit) {
+        TRY_AND_THROW_STREAM(
+            enc_vec.validate(),
+            "The EncryptedColVector argument to reencode_as_row_vector is invalid; has it been initialized?");
+        vector<CKKSCiphertext> cts = reencode_vector(enc_vec.cts, enc_vec.height(), enc_vec.encoding_unit(), false,
+                                                     unit, true, "reencode_as_row_vector");
+        return EncryptedRowVector(enc_vec.height(), unit, move(cts));
+    }
+
+    vector<CKKSCiphertext> LinearAlgebra::reencode_vector(const vector<CKKSCiphertext> &cts, int dim,
+                                                          const EncodingUnit &in_unit, bool in_row,
+                                                          const EncodingUnit &out_unit, bool out_row,
+                                                          const string &api) {
+        if (out_unit.encoding_height() * out_unit.encoding_width() != cts[0].num_slots()) {
+            LOG_AND_THROW_STREAM("Encoding unit for " << api << " must have " << cts[0].num_slots() << " slots, got "
+                                                      << dim_string(out_unit));
+        }
+        if (cts[0].needs_rescale()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must have nominal scale");
+        }
+        if (cts[0].needs_relin()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must be a linear ciphertext");
+        }
+
+        // A row vector is encoded in the columns of the unit, and a column vector is encoded in the rows
+        // of the unit. We move the copy of each coefficient in the first column (resp. row) of the input
+        // to the first column (resp. row) of the output, then replicate it.
+        int in_dim = in_row ? in_unit.encoding_height() : in_unit.encoding_width();
+        int out_dim = out_row ? out_unit.encoding_height() : out_unit.encoding_width();
+        auto target = [&](int k, int slot) {
+            int t = k * in_dim + (in_row ? slot / in_unit.encoding_width() : slot);
+            bool is_first_copy = in_row ? slot % in_unit.encoding_width() == 0 : slot < in_unit.encoding_width();
+            if (!is_first_copy || t >= dim) {
+                return make_pair(-1, 0);
+            }
+            return make_pair(t / out_dim, out_row ? (t % out_dim) * out_unit.encoding_width() : t % out_dim);
+        };
+        int num_out_cts = ceil(dim / static_cast<double>(out_dim));
+        vector<bool> out_zero;
+        vector<CKKSCiphertext> out_cts = repack(cts, vector<bool>(cts.size()), num_out_cts, target, out_zero);
+        parallel_for(num_out_cts, [&](int i) {
+            if (out_row) {
+                rot(out_cts[i], out_unit.encoding_width(), 1, false);
+            } else {
+                rot(out_cts[i], out_unit.encoding_height(), out_unit.encoding_width(), false);
+            }
+        });
+        return out_cts;
+    }
+
+    vector<CKKSCiphertext> LinearAlgebra::repack(const vector<CKKSCiphertext> &in_cts, const vector<bool> &in_zero,
+                                                 int num_out_cts, const function<pair<int, int>(int, int)> &target,
+                                                 vector<bool> &out_zero) {
+        int num_slots = in_cts[0].num_slots();
+        // masks[o][shift][k] selects the slots of input k which are moved to output o by rotating right by `shift`
+        vector<map<int, map<int, vector<double>>>> masks(num_out_cts);
+        for (int k = 0; k < in_cts.size(); k++) {
+            if (in_zero[k]) {
+                continue;
+            }
+            for (int slot = 0; slot < num_slots; slot++) {
+                pair<int, int> dest = target(k, slot);
+                if (dest.first < 0) {
+                    continue;
+                }
+                vector<double> &mask = masks[dest.first][(dest.second - slot + num_slots) % num_slots][k];
+                if (mask.empty()) {
+                    mask.resize(num_slots);
+                }
+                mask[slot] = 1;
+            }
+        }
+
+        vector<CKKSCiphertext> out_cts(num_out_cts);
+        parallel_for(num_out_cts, [&](int o) {
+            if (masks[o].empty()) {
+                // outputs which receive no slots only need the right level and scale
+                out_cts[o] = eval.multiply_plain(in_cts[0], 0);
+                return;
+            }
+            vector<int> shifts;
+            for (const auto &shift_masks : masks[o]) {
+                shifts.push_back(shift_masks.first);
+            }
+            vector<CKKSCiphertext> parts(shifts.size());
+            parallel_for(shifts.size(), [&](int s) {
+                vector<CKKSCiphertext> summands;
+                for (const auto &in_mask : masks[o].at(shifts[s])) {
+                    summands.push_back(eval.multiply_plain(in_cts[in_mask.first], in_mask.second));
+                }
+                // rotations are linear, so the masked inputs with the same shift are rotated together
+                parts[s] = eval.add_many(summands);
+                if (shifts[s] != 0) {
+                    eval.rotate_right_inplace(parts[s], shifts[s]);
+                }
+            });
+            out_cts[o] = eval.add_many(parts);
+        });
+
+        out_zero = vector<bool>(num_out_cts);
+        for (int o = 0; o < num_out_cts; o++) {
+            out_zero[o] = masks[o].empty();
+        }
+        return out_cts;
+    }
+
     /* Generic helper for summing or replicating the rows or columns of an encoded matrix
      *
-     * To sum columns, set `max` to the width of the matrix (must be a power of two), `stride` to 1, and rotateLeft=true
-     * To sum rows, set `max` to the height of the matrix (must be a power of two), `stride` to the matrix width, and
-     * rotateLeft=true To replicate columns, set `max` to the width of the matrix (must be a power of two), `stride` to
-     * 1, and rotateLeft=false
+     * To sum columns, set `max` to the width of the matrix, `stride` to 1, and rotateLeft=true
+     * To sum rows, set `max` to the height of the matrix, `stride` to the matrix width, and rotateLeft=true
+     * To replicate columns, set `max` to the width of the matrix, `stride` to 1, and rotateLeft=false
+     *
+     * `max` need not be a power of two. As in LPR'13, we view the `max` shifted copies as a tensor with one
+     * dimension for each prime factor p of `max`, and sum each dimension with p-1 rotations, so the cost for
+     * max=p^e is (p-1)*e rotations and additions. Factors of two are grouped into rounds of radix r (see
+     * `rotation_radix`), each of which adds r-1 rotations of the same ciphertext. These rotations are
+     * independent, so they are computed in parallel, and the number of sequential rounds is log_r(max).
      */
     void LinearAlgebra::rot(CKKSCiphertext &t1, int max, int stride, bool rotate_left) {
-        // serial implementation
-        for (int i = 1; i < max; i <<= 1) {
-            CKKSCiphertext t2;
-            if (rotate_left) {
-                t2 = eval.rotate_left(t1, i * stride);
-            } else {
-                t2 = eval.rotate_right(t1, i * stride);
+        int step = 1;
+        int remaining = max;
+        for (int p = 2; remaining > 1; p++) {
+            while (remaining % p == 0) {
+                int radix = p == 2 ? rotation_radix(remaining, step * stride, rotate_left, iterations_in_flight()) : p;
+                vector<CKKSCiphertext> summands(radix);
+                summands[0] = t1;
+                parallel_for(radix - 1, [&](int k) {
+                    if (rotate_left) {
+                        summands[k + 1] = eval.rotate_left(t1, (k + 1) * step * stride);
+                    } else {
+                        summands[k + 1] = eval.rotate_right(t1, (k + 1) * step * stride);
+                    }
+                });
+                t1 = eval.add_many(summands);
+                step *= radix;
+                remaining /= radix;
+            }
+        }
+    }
+
+    int LinearAlgebra::rotation_radix(int count, int shift, bool rotate_left, int in_flight) const {
+        // A round of radix r is a loop over its r-1 rotations. If other ciphertexts are in flight, their work
+        // already occupies the threads, so a wider round would only add rotations without reducing latency.
+        int threads_per_ciphertext = max(num_threads / max(in_flight, 1), 1);
+        int max_radix = min(max_rotation_radix, threads_per_ciphertext + 1);
+        int radix = 2;
+        while (count % (2 * radix) == 0 && 2 * radix <= max_radix) {
+            // radix 2 only needs a rotation by `shift`; larger radices also need rotations by each multiple of
+            // `shift` less than the radix
+            for (int k = radix; k < 2 * radix; k++) {
+                if (!eval.has_rotation_key(rotate_left ? k * shift : -k * shift)) {
+                    return radix;
+                }
+            }
+            radix *= 2;
+        }
+        return radix;
+    }
+
+    int LinearAlgebra::rot_count(int max, int stride, bool rotate_left, int in_flight) const {
+        // mirrors the rounds of `rot`
+        int count = 0;
+        int step = 1;
+        for (int p = 2; max > 1; p++) {
+            while (max % p == 0) {
+                int radix = p == 2 ? rotation_radix(max, step * stride, rotate_left, in_flight) : p;
+                count += radix - 1;
+                step *= radix;
+                max /= radix;
+            }
+        }
+        return count;
+    }
+
+    int LinearAlgebra::rot_cost(int max) {
+        int cost = 0;
+        for (int p = 2; max > 1; p++) {
+            while (max % p == 0) {
+                cost += p - 1;
+                max /= p;
+            }
+        }
+        return cost;
+    }
+
+    vector<const CKKSCiphertext *> LinearAlgebra::nonzero_units_in_row(const EncryptedMatrix &enc_mat, int i) {
+        vector<const CKKSCiphertext *> units;
+        for (int j = 0; j < enc_mat.num_horizontal_units(); j++) {
+            if (!enc_mat.is_zero_unit(i, j)) {
+                units.push_back(&enc_mat.unit_ct(i, j));
+            }
+        }
+        return units;
+    }
+
+    vector<const CKKSCiphertext *> LinearAlgebra::nonzero_units_in_col(const EncryptedMatrix &enc_mat, int j) {
+        vector<const CKKSCiphertext *> units;
+        for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
+            if (!enc_mat.is_zero_unit(i, j)) {
+                units.push_back(&enc_mat.unit_ct(i, j));
+            }
+        }
+        return units;
+    }
+
+    CKKSCiphertext LinearAlgebra::add_units(const vector<const CKKSCiphertext *> &units) {
+        CKKSCiphertext sum = *units[0];
+        for (int k = 1; k < units.size(); k++) {
+            eval.add_inplace(sum, *units[k]);
+        }
+        return sum;
+    }
+
+    int LinearAlgebra::sum_cols_width(const EncryptedMatrix &enc_mat) {
+        return sum_cols_width(enc_mat.width(), enc_mat.encoding_unit().encoding_width(), enc_mat.is_zero_padded());
+    }
+
+    int LinearAlgebra::sum_cols_width(int width, int unit_width, bool zero_padded) {
+        // If the matrix spans more than one unit horizontally, the sum of the units in a row is fully populated.
+        if (width >= unit_width) {
+            return unit_width;
+        }
+        // Summing exactly `width` columns is always correct. Summing more columns (up to the whole unit) would
+        // also sum the padding (see sum_cols_core), so it is only possible if the padding is known to be zero.
+        // In that case, choose whichever number of columns needs the fewest rotations.
+        if (!zero_padded) {
+            return width;
+        }
+        int best = width;
+        for (int w = width + 1; w <= unit_width && rot_cost(best) > 0; w++) {
+            if (rot_cost(w) < rot_cost(best)) {
+                best = w;
             }
-            t1 = eval.add(t1, t2);
         }
+        return best;
     }
 
     /* Algorithm 3 in HHCP'18; see the paper for details.
@@ -886,23 +2570,20 @@ namespace hit {
      *  - ct.width is a power of 2
      *
      * CONSUMES ONE HE LEVEL
-     *
-     * NOTE: This function could be modified to work for any integer width,
-     *       given the complete factorization of the width, though there is some
-     *       computational overhead for widths which are not a power of 2.
-     *       Specifically, the cost for width p^e is (p-1)*e rotations and (p-1)*e
-     *       additions. Viewing each row as a tensor, this can naturally be
-     *       extended to work for an arbitrary width, as in LPR'13.
      */
     // Summing the columns of a matrix would typically produce a column vector.
     // Forget that.
     // This function returns the encoding of the *transpose* of that column vector,
     // which is a *row* vector.
-    CKKSCiphertext LinearAlgebra::sum_cols_core(const CKKSCiphertext &ct, const EncodingUnit &unit, double scalar) {
+    CKKSCiphertext LinearAlgebra::sum_cols_core(const CKKSCiphertext &ct, const EncodingUnit &unit, double scalar,
+                                                int populated_width, bool is_zero) {
         CKKSCiphertext output = ct;
 
         // sum the columns, placing the result in the left-most column
-        rot(output, unit.encoding_width(), 1, true);
+        // if only the first `populated_width` columns are non-zero, we only need to sum those
+        if (!is_zero) {
+            rot(output, populated_width, 1, true);
+        }
 
         // At this point, the first column of the matrix represented by the plaintext holds the column sums
         // with the other columns hold garbage (i.e., the sum of some elements from row 1 and some from row 2)
@@ -936,7 +2617,9 @@ namespace hit {
 
         // now the first column of the matrix holds the column sum; but we want to repeat the first column in each
         // column.
-        rot(output, unit.encoding_width(), 1, false);
+        if (!is_zero) {
+            rot(output, unit.encoding_width(), 1, false);
+        }
 
         return output;
     }
@@ -945,74 +2628,117 @@ namespace hit {
     // then call sum_cols_core on the result.
     // Repeat for each encoding unit row.
     EncryptedRowVector LinearAlgebra::sum_cols(const EncryptedMatrix &enc_mat, double scalar) {
-        if (enc_mat.needs_relin()) {
-            LOG_AND_THROW_STREAM("Input to sum_cols must be a linear ciphertext");
-        }
-        if (enc_mat.needs_rescale()) {
-            LOG_AND_THROW_STREAM("Input to sum_cols must have nominal scale");
-        }
-
-        vector<CKKSCiphertext> cts(enc_mat.num_vertical_units());
-
-        parallel_for(enc_mat.num_vertical_units(), [&](int i) {
-            cts[i] = sum_cols_core(eval.add_many(enc_mat.cts[i]), enc_mat.encoding_unit(), scalar);
-        });
-
-        return EncryptedRowVector(enc_mat.height(), enc_mat.encoding_unit(), cts);
+        return sum_cols_matrices({&enc_mat}, scalar, "sum_cols");
     }
 
-    // we just horizontally concatenate the matrices, then call sum_cols
     EncryptedRowVector LinearAlgebra::sum_cols_many(const vector<EncryptedMatrix> &enc_mats, double scalar) {
-        vector<vector<CKKSCiphertext>> concat_cts(enc_mats[0].num_vertical_units());
-
-        for (int i = 0; i < enc_mats[0].num_vertical_units(); i++) {
-            for (int k = 0; k < enc_mats.size(); k++) {
-                if (enc_mats[k].encoding_unit() != enc_mats[0].encoding_unit()) {
-                    LOG_AND_THROW_STREAM("Inputs to sum_cols_many must have the same encoding unit, but "
-                                         << dim_string(enc_mats[k].encoding_unit())
-                                         << "!=" << dim_string(enc_mats[0].encoding_unit()));
-                }
-                if (enc_mats[k].height() != enc_mats[0].height()) {
-                    LOG_AND_THROW_STREAM("Inputs to sum_cols_many must have the same height, but "
-                                         << enc_mats[k].height() << "!=" << enc_mats[0].height());
-                }
+        vector<const EncryptedMatrix *> mat_ptrs;
+        for (const auto &enc_mat : enc_mats) {
+            mat_ptrs.push_back(&enc_mat);
+        }
+        return sum_cols_matrices(mat_ptrs, scalar, "sum_cols_many");
+    }
 
-                for (int j = 0; j < enc_mats[k].cts[i].size(); j++) {
-                    concat_cts[i].push_back(enc_mats[k].cts[i][j]);
-                }
+    // Summing the columns of several matrices is the same as summing the columns of their horizontal
+    // concatenation, so we sum all of the units in each row of units, then call sum_cols_core. The units
+    // are referenced in place rather than copied into a concatenated matrix.
+    EncryptedRowVector LinearAlgebra::sum_cols_matrices(const vector<const EncryptedMatrix *> &enc_mats,
+                                                        double scalar, const string &api) {
+        if (enc_mats.empty()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must be non-empty");
+        }
+        const EncryptedMatrix &first = *enc_mats[0];
+        int populated_width = 0;
+        for (const auto *enc_mat : enc_mats) {
+            row_major_validation(*enc_mat, api);
+            if (enc_mat->encoding_unit() != first.encoding_unit()) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same encoding unit, but "
+                                                  << dim_string(enc_mat->encoding_unit())
+                                                  << "!=" << dim_string(first.encoding_unit()));
+            }
+            if (enc_mat->height() != first.height()) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same height, but "
+                                                  << enc_mat->height() << "!=" << first.height());
+            }
+            if (enc_mat->needs_relin()) {
+                LOG_AND_THROW_STREAM("Input to " << api << " must be a linear ciphertext");
+            }
+            if (enc_mat->needs_rescale()) {
+                LOG_AND_THROW_STREAM("Input to " << api << " must have nominal scale");
+            }
+            populated_width = max(populated_width, sum_cols_width(*enc_mat));
+        }
+        for (const auto *enc_mat : enc_mats) {
+            // the columns of the sum beyond the width of this matrix hold its padding
+            if (!enc_mat->is_zero_padded() && enc_mat->width() < populated_width) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " which are narrower than another input must have "
+                                                  << "zero padding, but a " << dim_string(*enc_mat)
+                                                  << " input may have non-zero padding");
             }
         }
 
-        size_t synthetic_width = concat_cts[0].size() * enc_mats[0].encoding_unit().encoding_width();
+        vector<CKKSCiphertext> cts(first.num_vertical_units());
+        parallel_for(first.num_vertical_units(), [&](int i) {
+            vector<const CKKSCiphertext *> summands;
+            for (const auto *enc_mat : enc_mats) {
+                vector<const CKKSCiphertext *> row_units = nonzero_units_in_row(*enc_mat, i);
+                summands.insert(summands.end(), row_units.begin(), row_units.end());
+            }
+            if (summands.empty()) {
+                // only the mask needs to be applied to a zero unit
+                cts[i] = sum_cols_core(first.unit_ct(i, 0), first.encoding_unit(), scalar, 0, true);
+            } else {
+                cts[i] = sum_cols_core(add_units(summands), first.encoding_unit(), scalar, populated_width, false);
+            }
+        });
 
-        return sum_cols(EncryptedMatrix(enc_mats[0].height(), synthetic_width, enc_mats[0].encoding_unit(), concat_cts),
-                        scalar);
+        return EncryptedRowVector(first.height(), first.encoding_unit(), move(cts));
     }
 
-    // we just vertically concatenate the matrices, then call sum_rows
     EncryptedColVector LinearAlgebra::sum_rows_many(const vector<EncryptedMatrix> &enc_mats) {
-        vector<vector<CKKSCiphertext>> concat_cts;
-
+        vector<const EncryptedMatrix *> mat_ptrs;
         for (const auto &enc_mat : enc_mats) {
-            if (enc_mat.encoding_unit() != enc_mats[0].encoding_unit()) {
-                LOG_AND_THROW_STREAM("Inputs to sum_rows_many must have the same encoding unit, but "
-                                     << dim_string(enc_mat.encoding_unit())
-                                     << "!=" << dim_string(enc_mats[0].encoding_unit()));
+            mat_ptrs.push_back(&enc_mat);
+        }
+        return sum_rows_matrices(mat_ptrs, "sum_rows_many");
+    }
+
+    // Summing the rows of several matrices is the same as summing the rows of their vertical concatenation,
+    // so we sum all of the units in each column of units, then sum the rows of the result. The units are
+    // referenced in place rather than copied into a concatenated matrix.
+    EncryptedColVector LinearAlgebra::sum_rows_matrices(const vector<const EncryptedMatrix *> &enc_mats,
+                                                        const string &api) {
+        if (enc_mats.empty()) {
+            LOG_AND_THROW_STREAM("Input to " << api << " must be non-empty");
+        }
+        const EncryptedMatrix &first = *enc_mats[0];
+        for (const auto *enc_mat : enc_mats) {
+            row_major_validation(*enc_mat, api);
+            if (enc_mat->encoding_unit() != first.encoding_unit()) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same encoding unit, but "
+                                                  << dim_string(enc_mat->encoding_unit())
+                                                  << "!=" << dim_string(first.encoding_unit()));
             }
-            if (enc_mat.width() != enc_mats[0].width()) {
-                LOG_AND_THROW_STREAM("Inputs to sum_rows_many must have the same width, but "
-                                     << enc_mat.width() << "!=" << enc_mats[0].width());
+            if (enc_mat->width() != first.width()) {
+                LOG_AND_THROW_STREAM("Inputs to " << api << " must have the same width, but " << enc_mat->width()
+                                                  << "!=" << first.width());
             }
-
-            for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
-                concat_cts.push_back(enc_mat.cts[i]);
+            if (enc_mat->needs_relin()) {
+                LOG_AND_THROW_STREAM("Input to " << api << " must be a linear ciphertext");
             }
         }
 
-        size_t synthetic_height = concat_cts.size() * enc_mats[0].encoding_unit().encoding_height();
+        vector<CKKSCiphertext> cts(first.num_horizontal_units());
+        parallel_for(first.num_horizontal_units(), [&](int j) {
+            vector<const CKKSCiphertext *> summands;
+            for (const auto *enc_mat : enc_mats) {
+                vector<const CKKSCiphertext *> col_units = nonzero_units_in_col(*enc_mat, j);
+                summands.insert(summands.end(), col_units.begin(), col_units.end());
+            }
+            cts[j] = sum_rows_units(summands, first.unit_ct(0, j), first.encoding_unit(), false);
+        });
 
-        return sum_rows(
-            EncryptedMatrix(synthetic_height, enc_mats[0].width(), enc_mats[0].encoding_unit(), concat_cts));
+        return EncryptedColVector(first.width(), first.encoding_unit(), move(cts));
     }
 
     /* Summing the rows of a matrix would typically produce a row vector.
@@ -1040,17 +2766,24 @@ namespace hit {
      *       as in colSum, at the cost of flexibility
      */
     CKKSCiphertext LinearAlgebra::sum_rows_core(const EncryptedMatrix &enc_mat, int j, bool transpose_unit) {
-        vector<CKKSCiphertext> col_prods(enc_mat.num_vertical_units());
-        // extract the j^th column of encoding units
-        for (int i = 0; i < enc_mat.num_vertical_units(); i++) {
-            col_prods[i] = enc_mat.cts[i][j];
+        // extract the j^th column of encoding units, skipping units which are known to be zero
+        return sum_rows_units(nonzero_units_in_col(enc_mat, j), enc_mat.unit_ct(0, j), enc_mat.encoding_unit(),
+                              transpose_unit);
+    }
+
+    CKKSCiphertext LinearAlgebra::sum_rows_units(const vector<const CKKSCiphertext *> &units,
+                                                 const CKKSCiphertext &zero, const EncodingUnit &unit,
+                                                 bool transpose_unit) {
+        if (units.empty()) {
+            // the sum of the rows is zero
+            return zero;
         }
 
-        CKKSCiphertext output = eval.add_many(col_prods);
+        CKKSCiphertext output = add_units(units);
         if (transpose_unit) {
-            rot(output, enc_mat.encoding_unit().encoding_width(), enc_mat.encoding_unit().encoding_height(), true);
+            rot(output, unit.encoding_width(), unit.encoding_height(), true);
         } else {
-            rot(output, enc_mat.encoding_unit().encoding_height(), enc_mat.encoding_unit().encoding_width(), true);
+            rot(output, unit.encoding_height(), unit.encoding_width(), true);
         }
         return output;
     }
@@ -1059,13 +2792,6 @@ namespace hit {
     // then call sum_rows_core on the result.
     // Repeat for each encoding unit column.
     EncryptedColVector LinearAlgebra::sum_rows(const EncryptedMatrix &enc_mat) {
-        if (enc_mat.needs_relin()) {
-            LOG_AND_THROW_STREAM("Input to sum_rows must be a linear ciphertext");
-        }
-        vector<CKKSCiphertext> cts(enc_mat.num_horizontal_units());
-
-        parallel_for(enc_mat.num_horizontal_units(), [&](int j) { cts[j] = sum_rows_core(enc_mat, j, false); });
-
-        return EncryptedColVector(enc_mat.width(), enc_mat.encoding_unit(), cts);
+        return sum_rows_matrices({&enc_mat}, "sum_rows");
     }
 }  // namespace hit
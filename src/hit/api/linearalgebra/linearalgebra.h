@@ -6,9 +6,14 @@
 #include <glog/logging.h>
 
 #include <algorithm>
-#include <execution>
+#include <functional>
+#include <map>
+#include <memory>
+#include <type_traits>
+#include <utility>
 
 #include "../../common.h"
+#include "../../numa.h"
 #include "../ciphertext.h"
 #include "../evaluator.h"
 #include "encodingunit.h"
@@ -30,26 +35,54 @@
  * https://eprint.iacr.org/2020/1483 for more details.
  */
 
-/* Intended usage is:
- *
- *      parallel_for(x.size(), i) {
- *          foo1;
- *          foo2;
- *          ...
- *          foon;
- *      });
- */
+namespace hit {
 
-// https://stackoverflow.com/a/10379844/925978
-#define COMBINE1(X, Y) X##Y  // helper macro
-#define COMBINE(X, Y) COMBINE1(X, Y)
-// https://stackoverflow.com/a/17694752/925978
-#define parallel_for(max_idx, body)                                                     \
-    std::vector<int> COMBINE(iterIdxs, __LINE__)(max_idx);                              \
-    std::iota(begin(COMBINE(iterIdxs, __LINE__)), end(COMBINE(iterIdxs, __LINE__)), 0); \
-    for_each(__pstl::execution::par, begin(COMBINE(iterIdxs, __LINE__)), end(COMBINE(iterIdxs, __LINE__)), body)
+    // Restricts a template overload taking `T &&` to non-const rvalue arguments, so that it
+    // can consume a temporary rather than binding to (and modifying) an lvalue.
+    template <typename T>
+    using enable_if_rvalue = std::enable_if_t<!std::is_lvalue_reference<T>::value && !std::is_const<T>::value>;
+
+    // Matrix/matrix multiplication kernels which can be selected by `LinearAlgebra::plan_multiply`
+    enum MatrixMultiplyKernel { MATMUL_ROW_MAJOR, MATMUL_COL_MAJOR, MATMUL_SQUARE };
+
+    // Operations whose cost can be estimated by `LinearAlgebra::estimate_cost`:
+    //   - OP_ROW_VECTOR_MATRIX: multiply(EncryptedRowVector, EncryptedMatrix)
+    //   - OP_MATRIX_COL_VECTOR: multiply(EncryptedMatrix, EncryptedColVector)
+    //   - OP_MATMUL_ROW_MAJOR: multiply_row_major
+    //   - OP_MATMUL_COL_MAJOR: multiply_col_major
+    //   - OP_SUM_ROWS: sum_rows(EncryptedMatrix)
+    //   - OP_SUM_COLS: sum_cols(EncryptedMatrix)
+    enum LinearAlgebraOpType {
+        OP_ROW_VECTOR_MATRIX,
+        OP_MATRIX_COL_VECTOR,
+        OP_MATMUL_ROW_MAJOR,
+        OP_MATMUL_COL_MAJOR,
+        OP_SUM_ROWS,
+        OP_SUM_COLS
+    };
 
-namespace hit {
+    // A single step of a planned computation. The matrix argument is `height`-by-`width`.
+    // For matrix products, the output is the product of a `height`-by-`width` matrix
+    // and a `width`-by-`right_width` matrix, i.e., the (untransposed) inputs.
+    struct LinearAlgebraOp {
+        LinearAlgebraOpType type;
+        int height;
+        int width;
+        int right_width = 0;
+        // number of times this operation is performed
+        int count = 1;
+    };
+
+    // Estimated cost of a planned computation, assuming freshly encrypted (zero-padded) inputs
+    struct LinearAlgebraCost {
+        // ciphertexts in the inputs to each operation
+        int ciphertexts = 0;
+        int rotations = 0;
+        // ciphertext-ciphertext and ciphertext-plaintext multiplications
+        int multiplications = 0;
+        int relinearizations = 0;
+        int rescales = 0;
+    };
 
     // Evaluation and Encryption API for Linear Algebra objects
     class LinearAlgebra {
@@ -58,6 +91,38 @@ namespace hit {
          */
         explicit LinearAlgebra(CKKSEvaluator &eval);
 
+        /* Sets the largest radix used by the rotation ladders which sum or replicate the rows or columns of a
+         * matrix. A radix-r round adds r-1 rotations of the same ciphertext, which are independent of each
+         * other, so larger radices take fewer sequential rounds at the cost of more rotations and more
+         * rotation keys. A round only uses radix r if the evaluator has a dedicated key for each of its
+         * rotations (see `CKKSEvaluator::has_rotation_key`). To perform the same rotations in a dry run, pass
+         * the `galois_steps` of the HomomorphicEval to the constructor of the dry-run evaluator (e.g., OpCount).
+         * By default, the maximum radix is the largest r such that the r-1 rotations of a round can run
+         * concurrently on this machine.
+         *
+         * Wider rounds only reduce latency if there are idle threads to compute their rotations. The radix of
+         * each round is therefore also limited by the number of ciphertexts already being processed
+         * concurrently by enclosing loops (e.g., the units of a matrix): with a single ciphertext in flight,
+         * as in a matrix-vector product with a one-unit vector, the threads are spent on the rotations of that
+         * ciphertext (intra-op parallelism), while with at least as many ciphertexts in flight as threads,
+         * each ladder uses radix 2, which takes the fewest rotations (inter-op parallelism).
+         * Input: The maximum radix, which must be at least 2.
+         */
+        void set_max_rotation_radix(int radix);
+
+        /* NUMA mode. By default, the units of an object are processed by threads which may run on any NUMA
+         * node, so on a multi-socket machine much of their memory traffic (in particular, reads of the
+         * evaluation keys) crosses the interconnect. In NUMA mode, units are instead processed by a pool of
+         * worker threads which are pinned to the nodes of `topology`, and each node processes a contiguous
+         * range of the units. Since an EncryptedMatrix stores its units contiguously, and memory is placed on
+         * the node which first writes it, each node's outputs are allocated locally. To also read keys
+         * locally, call `HomomorphicEval::replicate_keys` with the same topology.
+         */
+        void enable_numa(const NumaTopology &topology = NumaTopology::detect());
+
+        // Throughput counters for each node's workers, indexed by node. This is empty unless NUMA mode is enabled.
+        std::vector<NumaNodeStats> numa_stats() const;
+
         /* Creates a valid encoding unit for this instance, i.e., one which holds exactly as many
          * coefficients as there are plaintext slots.
          * Inputs: Height of the encoding unit (must be a power of two)
@@ -65,12 +130,41 @@ namespace hit {
          */
         EncodingUnit make_unit(int encoding_height) const;
 
+        /* Estimates the cost of performing a sequence of operations on inputs encoded with `unit`.
+         * The estimate uses the same formulas as the kernels, so it is exact (i.e., it agrees with the
+         * OpCount evaluator) for freshly encrypted inputs which have no units that are known to be zero.
+         * This includes the radix of each rotation ladder (see `set_max_rotation_radix`), which depends on
+         * the evaluator's rotation keys, the number of threads, and the number of ciphertexts in flight;
+         * the operations are assumed to be called from the same context as `estimate_cost`.
+         * The number of levels consumed by each operation does not depend on the encoding unit.
+         */
+        LinearAlgebraCost estimate_cost(const std::vector<LinearAlgebraOp> &ops, const EncodingUnit &unit) const;
+
+        /* Chooses the encoding unit for a sequence of operations. The best unit minimizes the number
+         * of key-switching operations (rotations and relinearizations); ties are broken by the number of
+         * multiplications, and then by the number of ciphertexts.
+         */
+        EncodingUnit plan_unit(const std::vector<LinearAlgebraOp> &ops) const;
+
         /* Encrypt a matrix after encoding it with the provided encoding unit.
          * Matrix is encrypted at the specified level, or at the highest level allowed by the
          * encryption parameters if no level is specified. We encode the matrix
-         * as described in encryptedmatrix.h.
+         * as described in encryptedmatrix.h, using the specified layout.
+         * If `public_sparsity` is true, units whose plaintext is all zero are marked as known-zero
+         * units (see encryptedmatrix.h), so later operations skip them. This reveals which units
+         * are zero through the serialized matrix, the operations performed, and their timing, so
+         * only set it when the sparsity pattern of `mat` is public (e.g., for block-sparse weights).
          */
-        EncryptedMatrix encrypt_matrix(const Matrix &mat, const EncodingUnit &unit, int level = -1);
+        EncryptedMatrix encrypt_matrix(const Matrix &mat, const EncodingUnit &unit, int level = -1,
+                                       MatrixLayout layout = LAYOUT_ROW_MAJOR, bool public_sparsity = false);
+
+        /* Encrypt a placeholder for a `height`x`width` matrix, for dry runs with an evaluator which only tracks
+         * metadata (see `CKKSEvaluator::encrypt_placeholder`). The result has the same encoding units and
+         * metadata as the output of `encrypt_matrix`, except that no units are known to be zero, but the matrix
+         * is never encoded.
+         */
+        EncryptedMatrix encrypt_matrix_shape(int height, int width, const EncodingUnit &unit, int level = -1,
+                                             MatrixLayout layout = LAYOUT_ROW_MAJOR);
 
         /* Decrypt a matrix with any ciphertext degree and any scale.
          * This function will log a message if you try to decrypt a ciphertext which
@@ -98,6 +192,9 @@ namespace hit {
          */
         EncryptedRowVector encrypt_row_vector(const Vector &vec, const EncodingUnit &unit, int level = -1);
 
+        // Encrypt a placeholder for a row vector of length `width`; see `encrypt_matrix_shape`.
+        EncryptedRowVector encrypt_row_vector_shape(int width, const EncodingUnit &unit, int level = -1);
+
         /* Decrypt a row vector with any ciphertext degree and any scale.
          * This function will log a message if you try to decrypt a ciphertext which
          * is not at level 0. Sometimes it is expected for a ciphertext to be at a higher
@@ -111,6 +208,9 @@ namespace hit {
          */
         EncryptedColVector encrypt_col_vector(const Vector &vec, const EncodingUnit &unit, int level = -1);
 
+        // Encrypt a placeholder for a column vector of length `height`; see `encrypt_matrix_shape`.
+        EncryptedColVector encrypt_col_vector_shape(int height, const EncodingUnit &unit, int level = -1);
+
         /* Decrypt a column vector with any ciphertext degree and any scale.
          * This function will log a message if you try to decrypt a ciphertext which
          * is not at level 0. Sometimes it is expected for a ciphertext to be at a higher
@@ -145,6 +245,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T add(T &&arg1, const T &arg2) {
+            add_inplace(arg1, arg2);
+            return std::move(arg1);
+        }
+
         /* Add two encrypted linear algebra objects, component-wise.
          * Template Instantiations:
          *   - void add_inplace(const EncryptedMatrix&, const EncryptedMatrix&)
@@ -178,8 +285,18 @@ namespace hit {
                                      << log2(arg1.scale()) << "bits !=" << log2(arg2.scale()) << " bits");
             }
             for (size_t i = 0; i < arg1.num_cts(); i++) {
-                eval.add_inplace(arg1[i], arg2[i]);
+                // adding a known-zero unit is a no-op
+                if (is_zero_ct(arg2, i)) {
+                    continue;
+                }
+                if (is_zero_ct(arg1, i)) {
+                    arg1[i] = arg2[i];
+                    set_zero_ct(arg1, i, false);
+                } else {
+                    eval.add_inplace(arg1[i], arg2[i]);
+                }
             }
+            set_zero_padded(arg1, is_zero_padded(arg1) && is_zero_padded(arg2));
         }
 
         /* Add a public plaintext component-wise to an encrypted plaintext.
@@ -202,6 +319,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T1, typename T2, typename = enable_if_rvalue<T1>>
+        T1 add_plain(T1 &&arg1, const T2 &arg2) {
+            add_plain_inplace(arg1, arg2);
+            return std::move(arg1);
+        }
+
         /* Add a public matrix component-wise to an encrypted matrix.
          * Input Linear Algebra Constraints:
          *       Both inputs must have matching dimensions.
@@ -288,6 +412,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T sub(T &&arg1, const T &arg2) {
+            sub_inplace(arg1, arg2);
+            return std::move(arg1);
+        }
+
         /* Subtract one encrypted linear algebra object from another, component-wise.
          * Template Instantiations:
          *   - void sub_inplace(const EncryptedMatrix&, const EncryptedMatrix&)
@@ -321,8 +452,18 @@ namespace hit {
                                      << log2(arg1.scale()) << "bits !=" << log2(arg2.scale()) << " bits");
             }
             for (size_t i = 0; i < arg1.num_cts(); i++) {
-                eval.sub_inplace(arg1[i], arg2[i]);
+                // subtracting a known-zero unit is a no-op
+                if (is_zero_ct(arg2, i)) {
+                    continue;
+                }
+                if (is_zero_ct(arg1, i)) {
+                    arg1[i] = eval.negate(arg2[i]);
+                    set_zero_ct(arg1, i, false);
+                } else {
+                    eval.sub_inplace(arg1[i], arg2[i]);
+                }
             }
+            set_zero_padded(arg1, is_zero_padded(arg1) && is_zero_padded(arg2));
         }
 
         /* Subtract a public plaintext from an encrypted linear algebra object, component-wise.
@@ -345,6 +486,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T1, typename T2, typename = enable_if_rvalue<T1>>
+        T1 sub_plain(T1 &&arg1, const T2 &arg2) {
+            sub_plain_inplace(arg1, arg2);
+            return std::move(arg1);
+        }
+
         /* Subtract a public matrix from an encrypted matrix, component-wise.
          * Input Linear Algebra Constraints:
          *       Both inputs must have matching dimensions.
@@ -395,6 +543,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T negate(T &&arg) {
+            negate_inplace(arg);
+            return std::move(arg);
+        }
+
         /* Negate an encrypted linear algebra object.
          * Template Instantiations:
          *   - void negate_inplace(const EncryptedMatrix&)
@@ -411,7 +566,9 @@ namespace hit {
         void negate_inplace(T &arg) {
             TRY_AND_THROW_STREAM(arg.validate(), "Argument to negate is invalid; has it been initialized?");
             for (size_t i = 0; i < arg.num_cts(); i++) {
-                eval.negate_inplace(arg[i]);
+                if (!is_zero_ct(arg, i)) {
+                    eval.negate_inplace(arg[i]);
+                }
             }
         }
 
@@ -438,6 +595,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T multiply_plain(T &&arg1, double scalar) {
+            multiply_plain_inplace(arg1, scalar);
+            return std::move(arg1);
+        }
+
         /* Scale an encrypted object by a constant.
          * Template Instantiations:
          *   - void multiply_plain_inplace(const EncryptedMatrix&, double scalar)
@@ -492,6 +656,62 @@ namespace hit {
         EncryptedRowVector multiply(const EncryptedMatrix &enc_mat, const EncryptedColVector &enc_vec,
                                     double scalar = 1);
 
+        /* Computes a standard matrix/column vector product for a matrix in the diagonal layout.
+         * Unlike `multiply`, the output is *not* transposed, and the product is computed with
+         * O(sqrt(n)) rotations per n-by-n block rather than O(log(n)) rotations per unit.
+         * Rotations of the vector are computed once and shared by every row of blocks, which makes
+         * this kernel a good choice for repeated products with a long-lived encrypted matrix.
+         * Blocks whose diagonals are known to be zero are skipped.
+         * Input Linear Algebra Constraints:
+         *       Both arguments must be encoded with the same unit. `enc_mat` is a f-by-g matrix in
+         *       the diagonal layout and `enc_vec` is a g-dimensional vector.
+         * Input Ciphertext Constraints:
+         *       Both inputs must be linear ciphertexts with nominal scale at the same level i >= 1.
+         * Output Linear Algebra Properties:
+         *       An f-dimensional column vector encoded with the same unit as the input.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with nominal scale at level i-1.
+         */
+        EncryptedColVector multiply_diagonal(const EncryptedMatrix &enc_mat, const EncryptedColVector &enc_vec);
+
+        /* Computes `multiply(enc_vec, enc_mat)` for every vector in `enc_vecs`.
+         * When the matrix fits in a single horizontal unit and its padding is known to be zero,
+         * several products are packed into the unused columns of each unit, so the relinearization,
+         * the rescale, and the rotations which sum the rows are shared by the batch. Each output is
+         * then masked to its own columns, so it does not depend on whether the products were packed.
+         * Input Linear Algebra Constraints:
+         *       All arguments must be encoded with the same unit. Each vector is f-dimensional,
+         *       and `enc_mat` is a f-by-g matrix.
+         * Input Ciphertext Constraints:
+         *       All inputs must be linear ciphertexts with nominal scale at level i >= 2.
+         * Output Linear Algebra Properties:
+         *       A list of g-dimensional column vectors encoded with the same unit as the input.
+         *       The padding of each output is zero.
+         * Output Ciphertext Properties:
+         *       Linear ciphertexts with a squared scale at level i-1.
+         */
+        std::vector<EncryptedColVector> multiply_batch(const std::vector<EncryptedRowVector> &enc_vecs,
+                                                       const EncryptedMatrix &enc_mat);
+
+        /* Computes `multiply(enc_mat, enc_vec, scalar)` for every vector in `enc_vecs`.
+         * When the matrix fits in a single horizontal unit and its padding is known to be zero,
+         * several products are packed into the unused columns of each unit, so the relinearization,
+         * the rescale, and the rotations which sum the columns are shared by the batch. Otherwise,
+         * this is equivalent to calling `multiply` on each vector.
+         * Input Linear Algebra Constraints:
+         *       All arguments must be encoded with the same unit. `enc_mat` is a f-by-g matrix
+         *       and each vector is g-dimensional.
+         * Input Ciphertext Constraints:
+         *       All inputs must be linear ciphertexts with nominal scale at level i >= 2.
+         * Output Linear Algebra Properties:
+         *       A list of f-dimensional row vectors encoded with the same unit as the input.
+         * Output Ciphertext Properties:
+         *       Linear ciphertexts with a squared scale at level i-1.
+         */
+        std::vector<EncryptedRowVector> multiply_batch(const EncryptedMatrix &enc_mat,
+                                                       const std::vector<EncryptedColVector> &enc_vecs,
+                                                       double scalar = 1);
+
         /********************************
          * Matrix-Matrix Multiplication *
          ********************************
@@ -563,6 +783,123 @@ namespace hit {
         EncryptedMatrix multiply_row_major_mixed_unit(const EncryptedMatrix &enc_mat_a_trans,
                                                       const EncryptedMatrix &enc_mat_b, double scalar = 1);
 
+        /* Computes a standard (scaled) matrix/matrix product scalar*A*B, except that the inputs
+         * are A^T and B. This is identical to multiply_row_major, except that large products are
+         * computed with Winograd's variant of Strassen's algorithm over blocks of encoding units:
+         * each level of recursion replaces eight block products by seven block products and
+         * fifteen block additions. This reduces the number of ciphertext multiplications and
+         * relinearizations by a factor of 7/8 per level, but increases the number of rotations by
+         * a factor of 7/4 per level, so it is only beneficial when the inner and right dimensions
+         * of the product span many encoding units. Recursion stops when any dimension spans fewer
+         * than `cutoff` blocks, or when a dimension can't be split evenly into blocks of units.
+         * Input Linear Algebra Constraints:
+         *       Both arguments must be encoded with the same unit. `enc_mat_a_trans` is a g-by-f matrix,
+         *       and `enc_mat_b` is a g-by-h matrix.
+         * Input Ciphertext Constraints:
+         *       Both inputs must be linear ciphertexts with nominal scale. `enc_mat_a_trans` must be
+         *       at level i >= 3, and `enc_mat_b` must be at level i-1.
+         * Other Input Constraints:
+         *       Optional scalar defaults to 1. `cutoff` must be at least 2.
+         * Output Linear Algebra Properties:
+         *       An f-by-h matrix scalar*A*B encoded with the same unit as the input.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at level i-2.
+         */
+        EncryptedMatrix multiply_row_major_strassen(const EncryptedMatrix &enc_mat_a_trans,
+                                                    const EncryptedMatrix &enc_mat_b, double scalar = 1,
+                                                    int cutoff = 32);
+
+        /* When one operand of a matrix product is public, we can skip the work needed to
+         * extract rows or columns of that operand: the extracted row (resp. column) is
+         * simply encoded as a plaintext. Consequently, neither operand needs to be transposed,
+         * the public operand consumes no level, and the cost on a system with
+         * ~f*g*h/(m*n) cores is two plaintext multiplications and lg(m) (resp. lg(n)) rotations.
+         */
+
+        /* Computes a standard (scaled) matrix/matrix product scalar*A*B where A is encrypted
+         * and B is public.
+         * Input Linear Algebra Constraints:
+         *       `enc_mat_a` is a f-by-g matrix and `mat_b` is a g-by-h matrix.
+         * Input Ciphertext Constraints:
+         *       `enc_mat_a` must be a linear ciphertext with nominal scale at level i >= 1.
+         * Other Input Constraints:
+         *       Optional scalar defaults to 1.
+         * Output Linear Algebra Properties:
+         *       An f-by-h matrix scalar*A*B encoded with the same unit as the input.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at level i-1.
+         */
+        EncryptedMatrix multiply_plain(const EncryptedMatrix &enc_mat_a, const Matrix &mat_b, double scalar = 1);
+
+        /* Computes a standard (scaled) matrix/matrix product scalar*A*B where A is public
+         * and B is encrypted.
+         * Input Linear Algebra Constraints:
+         *       `mat_a` is a f-by-g matrix and `enc_mat_b` is a g-by-h matrix.
+         * Input Ciphertext Constraints:
+         *       `enc_mat_b` must be a linear ciphertext with nominal scale at level i >= 1.
+         * Other Input Constraints:
+         *       Optional scalar defaults to 1.
+         * Output Linear Algebra Properties:
+         *       An f-by-h matrix scalar*A*B encoded with the same unit as the input.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at level i-1.
+         */
+        EncryptedMatrix multiply_plain(const Matrix &mat_a, const EncryptedMatrix &enc_mat_b, double scalar = 1);
+
+        /* Computes a standard (scaled) matrix/matrix product scalar*A*B for small matrices using the
+         * linear transformations of JKLS'18 (https://eprint.iacr.org/2018/1041). Unlike multiply_row_major
+         * and multiply_col_major, neither input is transposed. Let d = max(f,g,h). The cost is O(d)
+         * rotations and d multiplications, but only one relinearization.
+         * Input Linear Algebra Constraints:
+         *       Both arguments must be encoded with the same m-by-n unit. `enc_mat_a` is a f-by-g matrix
+         *       and `enc_mat_b` is a g-by-h matrix, where f,g,h <= min(m,n).
+         * Input Ciphertext Constraints:
+         *       Both inputs must be linear ciphertexts with nominal scale at level i >= 3.
+         * Other Input Constraints:
+         *       Optional scalar defaults to 1.
+         * Output Linear Algebra Properties:
+         *       An f-by-h matrix scalar*A*B encoded with the same unit as the input.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at level i-2.
+         */
+        EncryptedMatrix multiply_square(const EncryptedMatrix &enc_mat_a, const EncryptedMatrix &enc_mat_b,
+                                        double scalar = 1);
+
+        /* Chooses a kernel for computing the product of an f-by-g matrix A and a g-by-h matrix B which are
+         * encoded with `unit`, where the input with the higher level is at level `level`. The planner estimates
+         * the total number of key-switching operations (rotations and relinearizations) for each kernel,
+         * weighted by the number of primes at the level where the operation is performed, and returns the
+         * cheapest one. Rotations are counted with the same model as `estimate_cost`, using the Galois keys
+         * available to the evaluator. MATMUL_SQUARE is only considered if all dimensions fit in a single
+         * encoding unit.
+         * All kernels require that `level` >= 3.
+         */
+        MatrixMultiplyKernel plan_multiply(int left_dim, int inner_dim, int right_dim, const EncodingUnit &unit,
+                                           int level) const;
+
+        /* Computes the Gram matrix X^T*X, which is needed, for example, to train a linear regression model.
+         * This could be computed as multiply_row_major(X, X), but that costs two extra levels and ignores
+         * the symmetry of the output. Instead, the output is computed directly in the diagonal layout:
+         * the k^th diagonal of X^T*X is a sum of the rows of X (.) rot(X, k), and by symmetry, diagonal n-k
+         * is a rotation of diagonal k. Thus, for an r-by-g input with m-by-n units, the cost is roughly
+         * g*r/m multiplications and g*(r/m+lg(m)+2) rotations. The output can be used with multiply_diagonal,
+         * or converted to the row-major layout with `reencode` after it is rescaled.
+         * This requires that g <= n/2 and that the input is zero-padded; other inputs are multiplied with
+         * multiply_row_major(X, X), whose output is in the row-major layout.
+         * Input Linear Algebra Constraints:
+         *       `enc_mat` is an r-by-g matrix encoded with an m-by-n unit.
+         * Input Ciphertext Constraints:
+         *       `enc_mat` must be a linear ciphertext with nominal scale at level i. If g > n/2 or `enc_mat`
+         *       is not zero-padded, i >= 3.
+         * Output Linear Algebra Properties:
+         *       A g-by-g matrix X^T*X, encoded with the same unit as the input. If g <= n/2 and `enc_mat` is
+         *       zero-padded, the output is in the diagonal layout; otherwise, it is in the row-major layout.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at level i if the output is in the diagonal layout,
+         *       and at level i-2 otherwise.
+         */
+        EncryptedMatrix gram(const EncryptedMatrix &enc_mat);
+
         /******************************************
          * Non-standard Linear Algebra Operations *
          ******************************************/
@@ -586,6 +923,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T add_plain(T &&arg1, double scalar) {
+            add_plain_inplace(arg1, scalar);
+            return std::move(arg1);
+        }
+
         /* Add a scalar to each coefficient of the encrypted value.
          * Template Instantiations:
          *   - void add_plain_inplace(const EncryptedMatrix&, double scalar)
@@ -603,6 +947,13 @@ namespace hit {
             TRY_AND_THROW_STREAM(arg.validate(), "Argument to add_plain is invalid; has it been initialized?");
             for (size_t i = 0; i < arg.num_cts(); i++) {
                 eval.add_plain_inplace(arg[i], scalar);
+                // the scalar is also added to the padding
+                if (scalar != 0) {
+                    set_zero_ct(arg, i, false);
+                }
+            }
+            if (scalar != 0) {
+                set_zero_padded(arg, false);
             }
         }
 
@@ -625,6 +976,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T sub_plain(T &&arg1, double scalar) {
+            sub_plain_inplace(arg1, scalar);
+            return std::move(arg1);
+        }
+
         /* Subtract a scalar from each coefficient of the encrypted value.
          * Template Instantiations:
          *   - void sub_plain_inplace(const EncryptedMatrix&, double scalar)
@@ -642,6 +1000,13 @@ namespace hit {
             TRY_AND_THROW_STREAM(arg.validate(), "Argument to sub_plain is invalid; has it been initialized?");
             for (size_t i = 0; i < arg.num_cts(); i++) {
                 eval.sub_plain_inplace(arg[i], scalar);
+                // the scalar is also subtracted from the padding
+                if (scalar != 0) {
+                    set_zero_ct(arg, i, false);
+                }
+            }
+            if (scalar != 0) {
+                set_zero_padded(arg, false);
             }
         }
 
@@ -696,6 +1061,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T hadamard_multiply(T &&arg1, const T &arg2) {
+            hadamard_multiply_inplace(arg1, arg2);
+            return std::move(arg1);
+        }
+
         /* Coefficient-wise (Hadamard) product of two objects.
          * Template Instantiations:
          *   - void hadamard_multiply_inplace(const EncryptedMatrix&, const EncryptedMatrix&)
@@ -742,7 +1114,22 @@ namespace hit {
                                      << "Vector: " << arg1.needs_relin() << ", Matrix: " << arg2.needs_relin());
             }
 
-            parallel_for(arg1.num_cts(), [&](int i) { eval.multiply_inplace(arg1[i], arg2[i]); });
+            parallel_for(arg1.num_cts(), [&](int i) {
+                if (is_zero_ct(arg1, i)) {
+                    // the product is zero, so we only need to update the scale
+                    eval.multiply_plain_inplace(arg1[i], 1);
+                } else if (is_zero_ct(arg2, i)) {
+                    arg1[i] = eval.multiply_plain(arg2[i], 1);
+                } else {
+                    eval.multiply_inplace(arg1[i], arg2[i]);
+                }
+            });
+            for (size_t i = 0; i < arg1.num_cts(); i++) {
+                if (is_zero_ct(arg2, i)) {
+                    set_zero_ct(arg1, i, true);
+                }
+            }
+            set_zero_padded(arg1, is_zero_padded(arg1) || is_zero_padded(arg2));
         }
 
         /* Tranpose the m-by-n unit of a properly-encoded matrix to an n-by-m unit.
@@ -768,6 +1155,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T transpose_unit(T &&arg) {
+            transpose_unit_inplace(arg);
+            return std::move(arg);
+        }
+
         /* Tranpose the m-by-n unit of a properly-encoded matrix to an n-by-m unit.
          * Note that usually, this does not produce a valid encoding of any object; use with care.
          * Input Linear Algebra Constraints:
@@ -794,6 +1188,101 @@ namespace hit {
          */
         void transpose_unit_inplace(EncryptedColVector &enc_vec);
 
+        /* Re-encode a matrix with a different encoding unit, e.g., to pass the output of one stage of a
+         * computation to a stage which is more efficient with a different unit. Each entry of the matrix
+         * is moved to its position in the new encoding by masking the input units and rotating the masked
+         * ciphertexts. Entries which move by the same amount between the same pair of units share a mask,
+         * and entries which move by the same amount into the same output unit share a rotation. The cost
+         * therefore depends on how the units relate: changing from an m-by-n unit to a 2m-by-(n/2) unit
+         * needs about one rotation per row of the input unit. To measure the cost for a particular pair of
+         * units, run `reencode` with the OpCount evaluator. The input may also be in the diagonal layout, which
+         * is converted to the row-major layout; with the same unit, each entry moves within its row of a unit,
+         * so this needs at most two rotations per diagonal.
+         * Input Linear Algebra Constraints:
+         *       `unit` must have the same number of slots as the encoding unit of `enc_mat`.
+         * Input Ciphertext Constraints:
+         *       `enc_mat` must be a linear ciphertext with nominal scale.
+         * Output Linear Algebra Properties:
+         *       The same matrix as the input, encoded with `unit` in the row-major layout.
+         *       The output is zero-padded.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at the same level as the input.
+         *       The output needs to be rescaled!
+         */
+        EncryptedMatrix reencode(const EncryptedMatrix &enc_mat, const EncodingUnit &unit);
+
+        /* Transpose a matrix of any size. Unlike `transpose_unit`, this moves the entries of the matrix,
+         * so the output is a valid encoding of the transpose with the same unit as the input. With a square
+         * unit, the entries on each diagonal of a unit all move by the same amount, so each output unit
+         * is a sum of the masked diagonals of the mirrored input unit, each rotated once. For an n-by-n unit,
+         * this costs at most 2n-2 rotations per output unit; other units need more rotations.
+         * Input Linear Algebra Constraints:
+         *       `enc_mat` is an f-by-g matrix.
+         * Input Ciphertext Constraints:
+         *       `enc_mat` must be a linear ciphertext with nominal scale.
+         * Output Linear Algebra Properties:
+         *       The g-by-f matrix A^T, encoded with the same unit as the input. The output is zero-padded.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at the same level as the input.
+         *       The output needs to be rescaled!
+         */
+        EncryptedMatrix transpose(const EncryptedMatrix &enc_mat);
+
+        /* Extract the block of encoding units in rows [first_row, first_row + num_rows) and columns
+         * [first_col, first_col + num_cols) of the grid of units of a matrix. This is a sub-matrix which is
+         * aligned to the encoding units, so no homomorphic operations are needed.
+         * Input Linear Algebra Constraints:
+         *       The block must lie within the grid of units of `enc_mat`.
+         * Input Ciphertext Constraints:
+         *       None
+         * Output Linear Algebra Properties:
+         *       The corresponding sub-matrix of the input, encoded with the same unit. The units are the
+         *       units of the input.
+         * Output Ciphertext Properties:
+         *       Same as input.
+         */
+        EncryptedMatrix unit_block(const EncryptedMatrix &enc_mat, int first_row, int num_rows, int first_col,
+                                   int num_cols);
+
+        /* Concatenate matrices horizontally (i.e., [A B]) or vertically (i.e., [A; B]). Since the
+         * concatenation must be aligned to the encoding units, no homomorphic operations are needed.
+         * Input Linear Algebra Constraints:
+         *       All inputs must be encoded with the same unit, in the row-major layout. For a horizontal
+         *       (resp. vertical) concatenation, all inputs must have the same height (resp. width), and all
+         *       inputs except the last must have a width (resp. height) which is a multiple of the unit
+         *       width (resp. height).
+         * Input Ciphertext Constraints:
+         *       All inputs must be at the same level and have the same scale.
+         * Other Input Constraints:
+         *       The input vector must be non-empty.
+         * Output Linear Algebra Properties:
+         *       The concatenation of the inputs, encoded with the same unit as the inputs.
+         * Output Ciphertext Properties:
+         *       Same as input.
+         */
+        EncryptedMatrix concat_horizontal(const std::vector<EncryptedMatrix> &enc_mats);
+        EncryptedMatrix concat_vertical(const std::vector<EncryptedMatrix> &enc_mats);
+
+        /* Re-encode a vector with a different encoding unit, or as a different kind of vector. A row vector
+         * can be re-encoded as a column vector (and vice versa) with any encoding unit, so the vector
+         * can be used as either argument of a matrix product. One copy of each coefficient is moved to its
+         * new position with masks and rotations (see `reencode(const EncryptedMatrix&, ...)`), and is then
+         * replicated across the new unit.
+         * Input Linear Algebra Constraints:
+         *       `unit` must have the same number of slots as the encoding unit of `enc_vec`.
+         * Input Ciphertext Constraints:
+         *       `enc_vec` must be a linear ciphertext with nominal scale.
+         * Output Linear Algebra Properties:
+         *       The same vector as the input, encoded with `unit`.
+         * Output Ciphertext Properties:
+         *       A linear ciphertext with a squared scale at the same level as the input.
+         *       The output needs to be rescaled!
+         */
+        EncryptedRowVector reencode(const EncryptedRowVector &enc_vec, const EncodingUnit &unit);
+        EncryptedColVector reencode(const EncryptedColVector &enc_vec, const EncodingUnit &unit);
+        EncryptedColVector reencode_as_col_vector(const EncryptedRowVector &enc_vec, const EncodingUnit &unit);
+        EncryptedRowVector reencode_as_row_vector(const EncryptedColVector &enc_vec, const EncodingUnit &unit);
+
         /* Square each coefficient of an object.
          * Template Instantiations:
          *   - EncryptedMatrix hadamard_square(const EncryptedMatrix&)
@@ -815,6 +1304,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T hadamard_square(T &&arg) {
+            hadamard_square_inplace(arg);
+            return std::move(arg);
+        }
+
         /* Square each coefficient of an object.
          * Template Instantiations:
          *   - void hadamard_square_inplace(const EncryptedMatrix&)
@@ -839,7 +1335,14 @@ namespace hit {
                 LOG_AND_THROW_STREAM("Input to hadamard_square must have nominal scale");
             }
 
-            parallel_for(arg.num_cts(), [&](int i) { eval.square_inplace(arg[i]); });
+            parallel_for(arg.num_cts(), [&](int i) {
+                if (is_zero_ct(arg, i)) {
+                    // the product is zero, so we only need to update the scale
+                    eval.multiply_plain_inplace(arg[i], 1);
+                } else {
+                    eval.square_inplace(arg[i]);
+                }
+            });
         }
 
         /* Hadamard product of a row vector with each column of a matrix.
@@ -858,6 +1361,9 @@ namespace hit {
          */
         EncryptedMatrix hadamard_multiply(const EncryptedRowVector &enc_vec, const EncryptedMatrix &enc_mat);
 
+        // Same as above, but reuses the ciphertexts of a temporary matrix.
+        EncryptedMatrix hadamard_multiply(const EncryptedRowVector &enc_vec, EncryptedMatrix &&enc_mat);
+
         /* Hadamard product of a column vector with each row of a matrix.
          * Input Linear Algebra Constraints:
          *      Input dimensions must be compatibile for standard matrix/column-vector product,
@@ -873,6 +1379,9 @@ namespace hit {
          */
         EncryptedMatrix hadamard_multiply(const EncryptedMatrix &enc_mat, const EncryptedColVector &enc_vec);
 
+        // Same as above, but reuses the ciphertexts of a temporary matrix.
+        EncryptedMatrix hadamard_multiply(EncryptedMatrix &&enc_mat, const EncryptedColVector &enc_vec);
+
         /* Sum the columns of a matrix, and encode the result as a row vector.
          * This is a key algorithm for (standard) matrix/column-vector multiplication,
          * which is achieved by performing a hadamard product between the matrix and column
@@ -968,6 +1477,12 @@ namespace hit {
             return reduce_level_to(arg1, arg2.he_level());
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T1, typename T2, typename = enable_if_rvalue<T1>>
+        T1 reduce_level_to(T1 &&arg1, const T2 &arg2) {
+            return reduce_level_to(std::move(arg1), arg2.he_level());
+        }
+
         /* Reduce the HE level of `ct` to the level of the `target`.
          * Input: The first argument must be a linear encrypted linear algebra object
          *        with nominal scale and level i, and the second argument must be a
@@ -1019,6 +1534,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary first argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T reduce_level_to(T &&arg, int level) {
+            reduce_level_to_inplace(arg, level);
+            return std::move(arg);
+        }
+
         /* Reduce the HE level of the first argument to the target level.
          * Inputs: A linear EncryptedMatrix, EncryptedRowVector, or EncryptedColVector
          *         with nominal scale and level i, and a target level 0 <= j <= i.
@@ -1045,6 +1567,13 @@ namespace hit {
             return temp;
         }
 
+        // Same as above, but reuses the ciphertexts of a temporary argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T rescale_to_next(T &&arg) {
+            rescale_to_next_inplace(arg);
+            return std::move(arg);
+        }
+
         /* Remove a prime from the modulus (i.e. go down one level) and scale
          * down the plaintext by that prime.
          * Inputs: A linear or quadratic EncryptedMatrix, EncryptedRowVector, or EncryptedColVector
@@ -1070,6 +1599,26 @@ namespace hit {
          * that encrypts the same plaintext.
          *
          * Relinearize the encrypted object.
+         * Input: A quadratic EncryptedMatrix, EncryptedRowVector, or EncryptedColVector
+         *        with nominal or squared scale.
+         * Output: A linear ciphertext with the same scale and level as the input.
+         * NOTE: Inputs which are linear ciphertexts to begin with are unchanged by this function.
+         */
+        template <typename T>
+        T relinearize(const T &arg) {
+            T temp = arg;
+            relinearize_inplace(temp);
+            return temp;
+        }
+
+        // Same as above, but reuses the ciphertexts of a temporary argument.
+        template <typename T, typename = enable_if_rvalue<T>>
+        T relinearize(T &&arg) {
+            relinearize_inplace(arg);
+            return std::move(arg);
+        }
+
+        /* Relinearize the encrypted object.
          * Input: A quadratic EncryptedMatrix, EncryptedRowVector, or EncryptedColVector
          *        with nominal or squared scale.
          * Output (Inplace): A linear ciphertext with the same scale and level as the input.
@@ -1080,7 +1629,12 @@ namespace hit {
             TRY_AND_THROW_STREAM(arg.validate(),
                                  "Argument to relinearize_inplace is invalid; has it been initialized?");
 
-            parallel_for(arg.num_cts(), [&](int i) { eval.relinearize_inplace(arg[i]); });
+            // known-zero units are always linear
+            parallel_for(arg.num_cts(), [&](int i) {
+                if (!is_zero_ct(arg, i)) {
+                    eval.relinearize_inplace(arg[i]);
+                }
+            });
         }
 
         CKKSEvaluator &eval;
@@ -1089,6 +1643,44 @@ namespace hit {
         template <typename T>
         std::string dim_string(const T &arg);
 
+        // Known-zero units and padding are only tracked for matrices; see encryptedmatrix.h
+        static bool is_zero_ct(const EncryptedMatrix &arg, size_t idx) {
+            return arg.is_zero_ct(idx);
+        }
+        template <typename T>
+        static bool is_zero_ct(const T &, size_t) {
+            return false;
+        }
+        static void set_zero_ct(EncryptedMatrix &arg, size_t idx, bool is_zero) {
+            arg.set_zero_ct(idx, is_zero);
+        }
+        template <typename T>
+        static void set_zero_ct(T &, size_t, bool) {
+        }
+        static bool is_zero_padded(const EncryptedMatrix &arg) {
+            return arg.is_zero_padded();
+        }
+        template <typename T>
+        static bool is_zero_padded(const T &) {
+            return false;
+        }
+        static void set_zero_padded(EncryptedMatrix &arg, bool zero_padded) {
+            arg.zero_padded = zero_padded;
+        }
+        template <typename T>
+        static void set_zero_padded(T &, bool) {
+        }
+
+        // number of matrix-vector products which fit side-by-side in the columns of the matrix's unit
+        static int batch_pack_factor(const EncryptedMatrix &enc_mat);
+
+        // copies of the (single) column of units of `enc_mat`, shifted right by multiples of `stride` columns
+        std::vector<std::vector<CKKSCiphertext>> shifted_unit_copies(const EncryptedMatrix &enc_mat, int copies,
+                                                                     int stride);
+
+        // helper function for rejecting matrices which are not in the row-major layout
+        static void row_major_validation(const EncryptedMatrix &enc_mat, const std::string &api);
+
         // helper function for validating inputs to matrix-matrix multiplication
         void matrix_multiply_validation(const EncryptedMatrix &enc_mat_a, const EncryptedMatrix &enc_mat_b,
                                         const std::string &api);
@@ -1105,15 +1697,14 @@ namespace hit {
          *
          * CONSUMES ONE HE LEVEL
          *
-         * NOTE: This function could be modified to work for any integer width,
-         *       given the complete factorization of the width, though there is some
-         *       computational overhead for widths which are not a power of 2.
-         *       Specifically, the cost for width p^e is (p-1)*e rotations and (p-1)*e
-         *       additions. Viewing each row as a tensor, this can naturally be
-         *       extended to work for an arbitrary width, as in LPR'13.
          * The output needs to be rescaled!
+         *
+         * If only the first `populated_width` columns of the input are non-zero, we only sum
+         * those columns; `populated_width` need not be a power of two. If `is_zero` is true, the
+         * input is known to be zero, so the only operation performed is the mask.
          */
-        CKKSCiphertext sum_cols_core(const CKKSCiphertext &ct, const EncodingUnit &unit, double scalar);
+        CKKSCiphertext sum_cols_core(const CKKSCiphertext &ct, const EncodingUnit &unit, double scalar,
+                                     int populated_width, bool is_zero);
 
         /* Algorithm 2 in HHCP'18; see the paper for details.
          * sum the rows of a matrix packed into a single ciphertext
@@ -1134,10 +1725,99 @@ namespace hit {
          */
         CKKSCiphertext sum_rows_core(const EncryptedMatrix &enc_mat, int j, bool transpose_unit);
 
-        // helper function for sum_rows and sum_cols which repeatedly shifts by increasing powers of two, adding the
-        // results
+        // helper function for sum_rows and sum_cols which adds `max` copies of the input, shifted by multiples of
+        // `stride`. `max` can be any positive integer; the shifts are organized by the prime factors of `max`.
         void rot(CKKSCiphertext &t1, int max, int stride, bool rotate_left);
 
+        // helper for reencode and transpose which moves slots between ciphertexts. `target(k, slot)` returns the
+        // index of the output ciphertext and the slot of that ciphertext to which slot `slot` of `in_cts[k]` is
+        // moved, or an output index of -1 if the slot is dropped. Inputs flagged in `in_zero` are known to be
+        // zero, and are skipped. Outputs which receive no slots are zero, and are flagged in `out_zero`.
+        std::vector<CKKSCiphertext> repack(const std::vector<CKKSCiphertext> &in_cts, const std::vector<bool> &in_zero,
+                                           int num_out_cts, const std::function<std::pair<int, int>(int, int)> &target,
+                                           std::vector<bool> &out_zero);
+
+        // helper for reencode and transpose, which moves entry (r, c) of the input to entry (r, c) of the output
+        // (or to entry (c, r) if `transpose` is true), encoded with `unit`
+        EncryptedMatrix reencode_matrix(const EncryptedMatrix &enc_mat, const EncodingUnit &unit, bool transpose,
+                                        const std::string &api);
+
+        // helper for concat_horizontal and concat_vertical
+        EncryptedMatrix concat_matrices(const std::vector<EncryptedMatrix> &enc_mats, bool horizontal);
+
+        // helper for reencoding vectors, where `in_row` and `out_row` indicate whether the input and output
+        // are row vectors
+        std::vector<CKKSCiphertext> reencode_vector(const std::vector<CKKSCiphertext> &cts, int dim,
+                                                    const EncodingUnit &in_unit, bool in_row,
+                                                    const EncodingUnit &out_unit, bool out_row,
+                                                    const std::string &api);
+
+        // largest power of two radix (up to `max_rotation_radix`, and up to one more than the number of threads
+        // available to each of the `in_flight` ciphertexts) dividing `count` for which the evaluator has keys for
+        // every rotation by a multiple of `shift` in a round of `rot`
+        int rotation_radix(int count, int shift, bool rotate_left, int in_flight) const;
+
+        // number of rotations (and additions) performed by `rot` with the given arguments when `in_flight`
+        // ciphertexts are processed concurrently
+        int rot_count(int max, int stride, bool rotate_left, int in_flight) const;
+
+        // cost of an operation in `estimate_cost`. Also adds the number of key-switching operations, weighted by
+        // the number of primes at the level where they are performed, to `weighted_key_switches`, assuming that
+        // the input with the higher level is at `level`.
+        LinearAlgebraCost estimate_op_cost(const LinearAlgebraOp &op, const EncodingUnit &unit, int level,
+                                           double &weighted_key_switches) const;
+
+        // number of rotations (and additions) performed by `rot` with the given `max`, using radix 2 for
+        // factors of two
+        static int rot_cost(int max);
+
+        // the number of threads which evaluate `parallel_for` loops
+        int num_threads;
+
+        int max_rotation_radix;
+
+        // the pinned workers used in NUMA mode, or null if it is not enabled; shared between copies of this object
+        std::shared_ptr<NumaWorkerPool> numa_workers;
+
+        /* Evaluate `body(i)` for each i in [0, max_idx) in parallel, on the NUMA workers if NUMA mode is enabled.
+         * Intended usage is:
+         *
+         *      parallel_for(x.size(), [&](int i) {
+         *          foo1;
+         *          ...
+         *          foon;
+         *      });
+         */
+        void parallel_for(int max_idx, const std::function<void(int)> &body) const;
+
+        // The number of independent iterations (e.g., ciphertexts) which the `parallel_for` loops enclosing the
+        // calling thread evaluate concurrently, i.e., the product of their sizes, or 1 outside of any loop.
+        static int iterations_in_flight();
+
+        // the units in a row (resp. column) of the grid of encoding units which are not known to be zero
+        static std::vector<const CKKSCiphertext *> nonzero_units_in_row(const EncryptedMatrix &enc_mat, int i);
+        static std::vector<const CKKSCiphertext *> nonzero_units_in_col(const EncryptedMatrix &enc_mat, int j);
+
+        // sum a non-empty list of units, copying only the first
+        CKKSCiphertext add_units(const std::vector<const CKKSCiphertext *> &units);
+
+        // implementations of sum_cols/sum_cols_many and sum_rows/sum_rows_many, which reference the units of
+        // the inputs rather than copying them
+        EncryptedRowVector sum_cols_matrices(const std::vector<const EncryptedMatrix *> &enc_mats, double scalar,
+                                             const std::string &api);
+        EncryptedColVector sum_rows_matrices(const std::vector<const EncryptedMatrix *> &enc_mats,
+                                             const std::string &api);
+
+        // sum the rows of the sum of `units`, which may be empty, in which case `zero` is returned
+        CKKSCiphertext sum_rows_units(const std::vector<const CKKSCiphertext *> &units, const CKKSCiphertext &zero,
+                                      const EncodingUnit &unit, bool transpose_unit);
+
+        // number of columns which sum_cols_core must sum to compute the column sums of a matrix, after summing the
+        // units in each row. This is at least the width of the matrix (up to the width of the unit), and is
+        // chosen to minimize the number of rotations.
+        static int sum_cols_width(const EncryptedMatrix &enc_mat);
+        static int sum_cols_width(int width, int unit_width, bool zero_padded);
+
         // inner loop for multiply_row_major
         EncryptedColVector matrix_matrix_mul_loop_row_major(const EncryptedMatrix &enc_mat_a_trans,
                                                             const EncryptedMatrix &enc_mat_b, double scalar, int k,
@@ -1148,6 +1828,22 @@ namespace hit {
                                                             const EncryptedMatrix &enc_mat_b_trans, double scalar,
                                                             int k);
 
+        // helper function for the row-major inner loops which masks out (and scales) the k^th row of a column
+        // vector whose rows are all identical
+        void mask_row_inplace(EncryptedColVector &enc_vec, double scalar, int k, bool transpose_unit);
+
+        // helper function for the col-major inner loops which sums the columns of the Hadamard product of A
+        // and the k^th column of B, then masks (and scales) the result into the k^th column
+        EncryptedRowVector mask_col(const EncryptedMatrix &hadamard_prod, double scalar, int k);
+
+        // sum the individual rows computed by the row-major inner loop into a `height`-by-`width` matrix
+        EncryptedMatrix combine_row_results(const std::vector<EncryptedColVector> &row_results, int width,
+                                            const EncodingUnit &unit);
+
+        // sum the individual columns computed by the col-major inner loop into a `height`-by-`width` matrix
+        EncryptedMatrix combine_col_results(const std::vector<EncryptedRowVector> &col_results, int height,
+                                            const EncodingUnit &unit);
+
         // common core for matrix/matrix multiplication; used by both multiply_row_major and
         // multiply_row_major_mixed_unit
         EncryptedMatrix multiply_common(const EncryptedMatrix &enc_mat_a_trans, const EncryptedMatrix &enc_mat_b,
@@ -1158,6 +1854,37 @@ namespace hit {
 
         // helper function for multiply_col_major which extracts a single column of B given the encoding of B^T
         EncryptedColVector extract_col(const EncryptedMatrix &enc_mat_b_trans, int col);
+
+        // helper function for multiply_row_major_strassen which computes one level of the Winograd recursion
+        EncryptedMatrix multiply_strassen(const EncryptedMatrix &enc_mat_a_trans, const EncryptedMatrix &enc_mat_b,
+                                          double scalar, int cutoff);
+
+        // helper function for multiply_row_major_strassen which returns the (i,j) block of a matrix which is
+        // split into a 2-by-2 grid of blocks, each with `block_vertical_units`-by-`block_horizontal_units` units
+        EncryptedMatrix matrix_block(const EncryptedMatrix &enc_mat, int i, int j, int block_vertical_units,
+                                     int block_horizontal_units);
+
+        // inverse of matrix_block: combines a 2-by-2 grid of blocks into a height-by-width matrix
+        EncryptedMatrix combine_blocks(const EncryptedMatrix &c11, const EncryptedMatrix &c12,
+                                       const EncryptedMatrix &c21, const EncryptedMatrix &c22, int height, int width);
+
+        // helper function for multiply_square which groups the entries of a permutation of a d-by-d matrix
+        // by the (left) rotation which moves them into place. `src` maps the row and column of an output entry
+        // to the slot which holds the corresponding input entry. Each mask is scaled by `scalar`.
+        std::map<int, std::vector<double>> permutation_masks(int d, const EncodingUnit &unit, double scalar,
+                                                             const std::function<int(int, int)> &src);
+
+        // helper function for multiply_square which computes the sum over all masks of mask*rot(ct, steps),
+        // and then rescales the result
+        CKKSCiphertext masked_rotation_sum(const CKKSCiphertext &ct,
+                                           const std::map<int, std::vector<double>> &masked_rotations);
+
+        // rotate a ciphertext left by `steps` (mod num_slots), in whichever direction is shorter
+        CKKSCiphertext rotate_left_shortest(const CKKSCiphertext &ct, int steps);
+
+        // helper function for plan_multiply which computes the number of key-switching operations needed to
+        // rotate a ciphertext left by `steps` (mod num_slots) with power-of-two Galois keys
+        static int rotation_cost(int steps, int num_slots);
     };
 
 }  // namespace hit
@@ -5,7 +5,8 @@
 
 #include <glog/logging.h>
 
-#include <iomanip>  // setprecision
+#include <algorithm>  // any_of
+#include <iomanip>    // setprecision
 
 using namespace std;
 
@@ -126,6 +127,19 @@ namespace hit {
         }
     }
 
+    bool has_galois_key(const vector<int> &galois_steps, int steps, int num_slots) {
+        // rotating left by `steps` is the same as rotating left by `steps` mod num_slots
+        auto normalize = [num_slots](int s) { return ((s % num_slots) + num_slots) % num_slots; };
+        steps = normalize(steps);
+        if (steps == 0) {
+            return true;
+        }
+        if (galois_steps.empty()) {
+            return is_pow2(steps) || is_pow2(num_slots - steps);
+        }
+        return any_of(galois_steps.begin(), galois_steps.end(), [&](int s) { return normalize(s) == steps; });
+    }
+
     int poly_degree_to_max_mod_bits(int poly_modulus_degree) {
         switch (poly_modulus_degree) {
             case 1024:
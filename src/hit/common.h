@@ -61,6 +61,12 @@ namespace hit {
     // tests if x is a power of two or not
     bool is_pow2(int x);
 
+    /* Tests if the Galois keys generated for `galois_steps` include a key for rotating a plaintext with
+     * `num_slots` slots left by `steps` (right, if `steps` is negative). As in HomomorphicEval, an empty
+     * list of steps stands for SEAL's default keys, which rotate by every power of two in either direction.
+     */
+    bool has_galois_key(const std::vector<int> &galois_steps, int steps, int num_slots);
+
     /* For each poly_modulus_degree (a power of two between 1024 and 32768,
      * inclusive), SEAL limits the size of the total modulus. This function
      * returns that limit (in bits).
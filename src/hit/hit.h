@@ -7,6 +7,7 @@
 
 #include "hit/api/ciphertext.h"
 #include "hit/api/evaluator.h"
+#include "hit/api/evaluator/boundsestimator.h"
 #include "hit/api/evaluator/debug.h"
 #include "hit/api/evaluator/depthfinder.h"
 #include "hit/api/evaluator/homomorphic.h"
@@ -19,3 +20,4 @@
 #include "hit/api/linearalgebra/encryptedrowvector.h"
 #include "hit/api/linearalgebra/linearalgebra.h"
 #include "hit/common.h"
+#include "hit/numa.h"
@@ -0,0 +1,225 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "numa.h"
+
+#include <glog/logging.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <numeric>
+#include <string>
+
+#include "common.h"
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+using namespace std;
+
+namespace hit {
+    // parse a Linux CPU or node list such as "0-3,8-11"; outputs an empty list if the file does not exist
+    static vector<int> read_id_list(const string &path) {
+        vector<int> ids;
+        ifstream file(path);
+        string range;
+        while (getline(file, range, ',')) {
+            range.erase(remove_if(range.begin(), range.end(), ::isspace), range.end());
+            if (range.empty()) {
+                continue;
+            }
+            size_t dash = range.find('-');
+            int first = stoi(range.substr(0, dash));
+            int last = dash == string::npos ? first : stoi(range.substr(dash + 1));
+            for (int id = first; id <= last; id++) {
+                ids.push_back(id);
+            }
+        }
+        return ids;
+    }
+
+    NumaTopology NumaTopology::detect() {
+        NumaTopology topology;
+#ifdef __linux__
+        // nodes without CPUs (e.g., memory-only nodes) are skipped, so node indices here are dense
+        for (int node_id : read_id_list("/sys/devices/system/node/online")) {
+            vector<int> cpus = read_id_list("/sys/devices/system/node/node" + to_string(node_id) + "/cpulist");
+            if (!cpus.empty()) {
+                topology.node_cpus.push_back(cpus);
+            }
+        }
+#endif
+        if (topology.node_cpus.empty()) {
+            int num_cpus = static_cast<int>(max(thread::hardware_concurrency(), 1U));
+            topology.node_cpus.emplace_back(num_cpus);
+            iota(topology.node_cpus[0].begin(), topology.node_cpus[0].end(), 0);
+        }
+        for (int node = 0; node < topology.num_nodes(); node++) {
+            for (int cpu : topology.node_cpus[node]) {
+                if (cpu >= static_cast<int>(topology.cpu_node.size())) {
+                    topology.cpu_node.resize(cpu + 1, -1);
+                }
+                topology.cpu_node[cpu] = node;
+            }
+        }
+        VLOG(VLOG_VERBOSE) << "Detected " << topology.num_nodes() << " NUMA node(s) with "
+                           << count_if(topology.cpu_node.begin(), topology.cpu_node.end(),
+                                       [](int node) { return node >= 0; })
+                           << " CPUs";
+        return topology;
+    }
+
+    int NumaTopology::num_nodes() const {
+        return static_cast<int>(node_cpus.size());
+    }
+
+    int NumaTopology::current_node() const {
+#ifdef __linux__
+        int cpu = sched_getcpu();
+        if (cpu >= 0 && cpu < static_cast<int>(cpu_node.size()) && cpu_node[cpu] >= 0) {
+            return cpu_node[cpu];
+        }
+#endif
+        return 0;
+    }
+
+    bool pin_thread_to_node(const NumaTopology &topology, int node) {
+#ifdef __linux__
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        for (int cpu : topology.node_cpus[node]) {
+            CPU_SET(cpu, &cpus);
+        }
+        // a pid of 0 refers to the calling thread
+        return sched_setaffinity(0, sizeof(cpus), &cpus) == 0;
+#else
+        (void)topology;
+        (void)node;
+        return false;
+#endif
+    }
+
+    // the pool whose worker is the calling thread, if any
+    static thread_local const NumaWorkerPool *current_worker_pool = nullptr;
+
+    NumaWorkerPool::NumaWorkerPool(const NumaTopology &topology) : topology_(topology) {
+        for (int node = 0; node < topology_.num_nodes(); node++) {
+            nodes_.push_back(make_unique<Node>());
+        }
+        for (int node = 0; node < topology_.num_nodes(); node++) {
+            for (size_t i = 0; i < topology_.node_cpus[node].size(); i++) {
+                workers_.emplace_back(&NumaWorkerPool::worker_loop, this, node);
+            }
+        }
+    }
+
+    NumaWorkerPool::~NumaWorkerPool() {
+        {
+            lock_guard lock(mutex_);
+            stopping_ = true;
+        }
+        work_cv_.notify_all();
+        for (auto &worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void NumaWorkerPool::run(int num_iters, const function<void(int)> &body) {
+        if (num_iters <= 0) {
+            return;
+        }
+        if (current_worker_pool != nullptr) {
+            for (int i = 0; i < num_iters; i++) {
+                body(i);
+            }
+            return;
+        }
+
+        lock_guard run_lock(run_mutex_);
+        int64_t num_cpus = workers_.size();
+        int64_t cpus_before = 0;
+        int start = 0;
+        for (int node = 0; node < topology_.num_nodes(); node++) {
+            cpus_before += topology_.node_cpus[node].size();
+            int end = static_cast<int>(num_iters * cpus_before / num_cpus);
+            nodes_[node]->next = start;
+            nodes_[node]->end = end;
+            start = end;
+        }
+
+        exception_ptr error;
+        {
+            unique_lock lock(mutex_);
+            body_ = &body;
+            error_ = nullptr;
+            num_busy_ = static_cast<int>(workers_.size());
+            generation_++;
+            work_cv_.notify_all();
+            done_cv_.wait(lock, [this]() { return num_busy_ == 0; });
+            body_ = nullptr;
+            error = error_;
+        }
+        if (error) {
+            rethrow_exception(error);
+        }
+    }
+
+    void NumaWorkerPool::worker_loop(int node) {
+        if (!pin_thread_to_node(topology_, node)) {
+            VLOG(VLOG_VERBOSE) << "Unable to pin a worker thread to NUMA node " << node;
+        }
+        current_worker_pool = this;
+        Node &local = *nodes_[node];
+        uint64_t last_generation = 0;
+        while (true) {
+            const function<void(int)> *body;
+            {
+                unique_lock lock(mutex_);
+                work_cv_.wait(lock, [&]() { return stopping_ || generation_ != last_generation; });
+                if (stopping_) {
+                    return;
+                }
+                last_generation = generation_;
+                body = body_;
+            }
+
+            size_t num_units = 0;
+            timepoint start = chrono::steady_clock::now();
+            try {
+                for (int i = local.next++; i < local.end; i = local.next++) {
+                    (*body)(i);
+                    num_units++;
+                }
+            } catch (...) {
+                lock_guard lock(mutex_);
+                if (!error_) {
+                    error_ = current_exception();
+                }
+            }
+            timepoint end = chrono::steady_clock::now();
+            local.num_units += num_units;
+            local.busy_us += chrono::duration_cast<chrono::microseconds>(end - start).count();
+
+            lock_guard lock(mutex_);
+            if (--num_busy_ == 0) {
+                done_cv_.notify_one();
+            }
+        }
+    }
+
+    const NumaTopology &NumaWorkerPool::topology() const {
+        return topology_;
+    }
+
+    vector<NumaNodeStats> NumaWorkerPool::node_stats() const {
+        vector<NumaNodeStats> stats(nodes_.size());
+        for (size_t node = 0; node < nodes_.size(); node++) {
+            stats[node].num_units = nodes_[node]->num_units;
+            stats[node].busy_us = nodes_[node]->busy_us;
+        }
+        return stats;
+    }
+}  // namespace hit
@@ -0,0 +1,103 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace hit {
+    /* The CPUs of each NUMA node of this machine. On Linux, this is read from sysfs; on other
+     * platforms (or if sysfs is unavailable), every CPU is placed on a single node.
+     */
+    struct NumaTopology {
+        // the CPUs on each node
+        std::vector<std::vector<int>> node_cpus;
+        // the node of each CPU, or -1 for CPUs which are not on any node (e.g., offline CPUs)
+        std::vector<int> cpu_node;
+
+        static NumaTopology detect();
+
+        int num_nodes() const;
+
+        // The node of the CPU the calling thread is currently running on (or 0 if this is unknown).
+        // Unless the thread is pinned to a node, the result may be stale as soon as it is returned.
+        int current_node() const;
+    };
+
+    // Restrict the calling thread to the CPUs of `node`. Outputs false if the thread could not be pinned.
+    bool pin_thread_to_node(const NumaTopology &topology, int node);
+
+    // Throughput counters for the workers of one NUMA node
+    struct NumaNodeStats {
+        // loop iterations (e.g., ciphertext units) evaluated by this node's workers
+        size_t num_units = 0;
+        // total time this node's workers spent evaluating loop iterations, in microseconds
+        uint64_t busy_us = 0;
+    };
+
+    /* A pool with one worker thread per CPU, where each worker is pinned to the node of its CPU.
+     * `run` splits a loop into one contiguous range of iterations per node, so that iterations
+     * which touch adjacent data (e.g., neighboring units of an EncryptedMatrix) are evaluated,
+     * and their outputs first written, on the same node. Since memory is placed on the node which
+     * first writes it, outputs allocated by a worker are local to that worker's node.
+     */
+    class NumaWorkerPool {
+       public:
+        explicit NumaWorkerPool(const NumaTopology &topology);
+        ~NumaWorkerPool();
+
+        NumaWorkerPool(const NumaWorkerPool &) = delete;
+        NumaWorkerPool &operator=(const NumaWorkerPool &) = delete;
+        NumaWorkerPool(NumaWorkerPool &&) = delete;
+        NumaWorkerPool &operator=(NumaWorkerPool &&) = delete;
+
+        /* Evaluate `body(i)` for each i in [0, num_iters) and wait for all iterations to finish.
+         * Each node receives a range of iterations in proportion to its number of CPUs; within a node,
+         * workers take iterations from that range one at a time. Calls from a worker thread (i.e., loops
+         * nested in `body`) are evaluated serially on that worker, and calls from other threads are
+         * evaluated one at a time. If any iteration throws, the first exception is rethrown here once all
+         * workers have finished.
+         */
+        void run(int num_iters, const std::function<void(int)> &body);
+
+        const NumaTopology &topology() const;
+
+        std::vector<NumaNodeStats> node_stats() const;
+
+       private:
+        struct Node {
+            // the next unclaimed iteration, and the end of this node's range for the current loop
+            std::atomic<int> next{0};
+            int end = 0;
+            std::atomic<size_t> num_units{0};
+            std::atomic<uint64_t> busy_us{0};
+        };
+
+        void worker_loop(int node);
+
+        NumaTopology topology_;
+        std::vector<std::unique_ptr<Node>> nodes_;
+        std::vector<std::thread> workers_;
+
+        // serializes calls to `run`
+        std::mutex run_mutex_;
+
+        // guards the state below, which describes the current loop
+        std::mutex mutex_;
+        std::condition_variable work_cv_;
+        std::condition_variable done_cv_;
+        const std::function<void(int)> *body_ = nullptr;
+        uint64_t generation_ = 0;
+        int num_busy_ = 0;
+        std::exception_ptr error_;
+        bool stopping_ = false;
+    };
+}  // namespace hit
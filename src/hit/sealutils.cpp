@@ -5,11 +5,21 @@
 
 #include <glog/logging.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 
+#include "common.h"
 #include "seal/seal.h"
 
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
 using namespace std;
 using namespace seal;
 
@@ -142,4 +152,157 @@ namespace hit {
 
         return sk_bytes + pk_bytes + rk_bytes + gk_bytes;
     }
+
+    /*
+    Helper function: Create the SEAL context used by the estimator evaluators. They never encrypt,
+    so the context only provides the modulus chain, and is not required to be secure.
+    */
+    shared_ptr<SEALContext> make_estimator_context(int num_slots, int multiplicative_depth, int log_scale,
+                                                   const string &evaluator_name) {
+        if (!is_pow2(num_slots) || num_slots < 4096) {
+            LOG_AND_THROW_STREAM("Invalid parameters when creating " << evaluator_name << " instance: "
+                                 << "num_slots must be a power of 2, and at least 4096. Got " << num_slots);
+        }
+
+        int num_primes = multiplicative_depth + 2;
+        vector<int> modulusVector = gen_modulus_vec(num_primes, log_scale);
+
+        int modBits = 0;
+        for (const auto &bits : modulusVector) {
+            modBits += bits;
+        }
+        int min_poly_degree = modulus_to_poly_degree(modBits);
+        int poly_modulus_degree = num_slots * 2;
+        if (poly_modulus_degree < min_poly_degree) {
+            LOG_AND_THROW_STREAM("Invalid parameters when creating " << evaluator_name << " instance: "
+                                 << "Parameters for depth " << multiplicative_depth << " circuits and scale "
+                                 << log_scale << " bits require more than " << num_slots << " plaintext slots.");
+        }
+
+        EncryptionParameters params = EncryptionParameters(scheme_type::ckks);
+        params.set_poly_modulus_degree(poly_modulus_degree);
+        params.set_coeff_modulus(CoeffModulus::Create(poly_modulus_degree, modulusVector));
+
+        // for large parameter sets, see https://github.com/microsoft/SEAL/issues/84
+        return make_shared<SEALContext>(params, true, sec_level_type::none);
+    }
+
+    /*
+    Helper function: The largest log scale an estimator can report before any ciphertexts are evaluated.
+    */
+    double initial_max_log_scale(const shared_ptr<SEALContext> &context) {
+        // if scale is too close to 60, SEAL throws the error "encoded values are too large" during encoding.
+        double estimated_max_log_scale = PLAINTEXT_LOG_MAX - 60;
+        for (const auto &prime : context->first_context_data()->parms().coeff_modulus()) {
+            estimated_max_log_scale += log2(prime.value());
+        }
+        return estimated_max_log_scale;
+    }
+
+    /*
+    Helper function: The largest log scale SEAL allows for the modulus chain of `context`.
+    */
+    double modulus_max_log_scale(const shared_ptr<SEALContext> &context, int num_slots) {
+        /* A SEAL modulus is the product of k primes p_i, where log2(p_1)=log2(p_k)=60
+         * and log2(p_i)=s=log(scale). SEAL limits the maximum size of the modulus (in bits)
+         * based on the poly_modulus_degree, so s must be less than (maxModBits-120)/(k-2).
+         */
+        int max_mod_bits = poly_degree_to_max_mod_bits(2 * num_slots);
+        auto max_log_scale = static_cast<double>(PLAINTEXT_LOG_MAX);
+        int top_he_level = context->first_context_data()->chain_index();
+        if (top_he_level > 0) {
+            max_log_scale = min(max_log_scale, (max_mod_bits - 120) / static_cast<double>(top_he_level));
+        }
+        return max_log_scale;
+    }
+
+    /*
+    Helper function: The power of the nominal scale in the scale of `ct`, which is 1 or 2.
+    */
+    int scale_exponent(const CKKSCiphertext &ct, int log_scale) {
+        auto scale_exp = static_cast<int>(round(log2(ct.scale()) / log_scale));
+        if (scale_exp != 1 && scale_exp != 2) {
+            LOG_AND_THROW_STREAM("Internal error: scale_exp is not 1 or 2: got "
+                                 << scale_exp << ". "
+                                 << "HIT ciphertext scale is " << log2(ct.scale()) << " bits, and nominal scale is "
+                                 << log_scale << " bits");
+        }
+        return scale_exp;
+    }
+
+    /*
+    Helper function: The largest log scale for which a plaintext whose magnitude is at most 2^log_max_val
+    does not overflow at the given scale exponent and level.
+    */
+    double max_log_scale_bound(int scale_exp, int he_level, double log_max_val) {
+        // Define scale = pow(2,log_scale)^i for i \in {1,2}
+        // If(i > he_level): log_scale \le (PLAINTEXT_LOG_MAX-log_max_val)/(i-he_level)
+        // Else if (i == he_level): log_max_val <= PLAINTEXT_LOG_MAX, independent of the scale
+        // Else [i < he_level]:
+        //      In this case, the constraint becomes log_scale > (something less than 0).
+        //      this is bogus, so there is no constraint.
+        if (scale_exp > he_level) {
+            return (PLAINTEXT_LOG_MAX - log_max_val) / (scale_exp - he_level);
+        }
+        if (scale_exp == he_level && log_max_val > PLAINTEXT_LOG_MAX) {
+            LOG_AND_THROW_STREAM("The maximum value in the plaintext is "
+                                 << log_max_val << " bits which exceeds SEAL's capacity of " << PLAINTEXT_LOG_MAX
+                                 << " bits. Overflow is imminent.");
+        }
+        return numeric_limits<double>::infinity();
+    }
+
+    /*
+    Helper function: Ask the kernel to back the given memory ranges with 2 MB transparent huge pages.
+    SEAL allocates objects of the same size contiguously in its memory pools, so adjacent ranges are
+    merged before advising, and only the 2 MB-aligned part of each merged range is eligible.
+    */
+    size_t advise_huge_pages(vector<pair<const void *, size_t>> ranges) {
+        size_t advised_bytes = 0;
+#ifdef __linux__
+        const uintptr_t huge_page_size = 1 << 21;
+        // ranges which are at most this far apart are merged
+        const uintptr_t max_gap = 4096;
+
+        vector<pair<uintptr_t, uintptr_t>> intervals;
+        intervals.reserve(ranges.size());
+        for (const auto &range : ranges) {
+            auto start = reinterpret_cast<uintptr_t>(range.first);
+            intervals.emplace_back(start, start + range.second);
+        }
+        sort(intervals.begin(), intervals.end());
+
+        for (size_t i = 0; i < intervals.size();) {
+            uintptr_t start = intervals[i].first;
+            uintptr_t end = intervals[i].second;
+            for (i++; i < intervals.size() && intervals[i].first <= end + max_gap; i++) {
+                end = max(end, intervals[i].second);
+            }
+
+            uintptr_t aligned_start = (start + huge_page_size - 1) & ~(huge_page_size - 1);
+            uintptr_t aligned_end = end & ~(huge_page_size - 1);
+            if (aligned_end <= aligned_start) {
+                continue;
+            }
+            void *addr = reinterpret_cast<void *>(aligned_start);
+            size_t length = aligned_end - aligned_start;
+#ifdef MADV_COLLAPSE
+            // Linux 6.1+ can move memory which is already populated to huge pages immediately
+            if (madvise(addr, length, MADV_COLLAPSE) == 0) {
+                advised_bytes += length;
+                continue;
+            }
+#endif
+            // otherwise, khugepaged collapses the range in the background
+            if (madvise(addr, length, MADV_HUGEPAGE) == 0) {
+                advised_bytes += length;
+            } else {
+                VLOG(VLOG_VERBOSE) << "madvise failed for " << bytes_to_str(length) << ": " << strerror(errno);
+            }
+        }
+#else
+        (void)ranges;
+#endif
+        return advised_bytes;
+    }
 }  // namespace hit
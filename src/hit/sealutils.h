@@ -5,6 +5,9 @@
 
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "api/ciphertext.h"
 #include "common.h"
@@ -42,4 +45,40 @@ namespace hit {
     std::vector<int> gen_modulus_vec(int num_primes, int log_scale);
 
     uint64_t estimate_key_size(int num_galois_shift, int plaintext_slots, int depth);
+
+    /*
+    Helper function: Create the insecure SEAL context shared by the estimator evaluators (ScaleEstimator and
+    BoundsEstimator). Throws if `num_slots` is too small for the depth; `evaluator_name` is used in the error.
+    */
+    std::shared_ptr<seal::SEALContext> make_estimator_context(int num_slots, int multiplicative_depth, int log_scale,
+                                                              const std::string &evaluator_name);
+
+    /*
+    Helper function: The largest log scale an estimator can report before any ciphertexts are evaluated.
+    */
+    double initial_max_log_scale(const std::shared_ptr<seal::SEALContext> &context);
+
+    /*
+    Helper function: The largest log scale SEAL allows for the modulus chain of `context`.
+    */
+    double modulus_max_log_scale(const std::shared_ptr<seal::SEALContext> &context, int num_slots);
+
+    /*
+    Helper function: The power of the nominal scale in the scale of `ct`, which is 1 or 2.
+    */
+    int scale_exponent(const CKKSCiphertext &ct, int log_scale);
+
+    /*
+    Helper function: The largest log scale for which a plaintext whose magnitude is at most 2^log_max_val
+    does not overflow at the given scale exponent and level, or infinity if there is no constraint.
+    Throws if the plaintext overflows regardless of the scale.
+    */
+    double max_log_scale_bound(int scale_exp, int he_level, double log_max_val);
+
+    /*
+    Helper function: Ask the kernel to back the given (address, byte count) ranges with 2 MB transparent
+    huge pages. Outputs the number of bytes which were successfully advised, which is zero on platforms
+    without transparent huge pages.
+    */
+    size_t advise_huge_pages(std::vector<std::pair<const void *, size_t>> ranges);
 }  // namespace hit
@@ -32,3 +32,49 @@ TEST(CKKSCiphertextTest, Serialization) {
     vector<double> vector2 = ckks_instance.decrypt(ciphertext2);
     ASSERT_LT(relative_error(vector1, vector2), MAX_NORM);
 }
+
+TEST(CKKSCiphertextTest, CopyOnWrite) {
+    CopyOnWrite<vector<double>> value1;
+    ASSERT_TRUE(value1.get().empty());
+    value1.overwrite() = {1, 2, 3};
+
+    // copies share storage until one of them is modified
+    CopyOnWrite<vector<double>> value2 = value1;
+    ASSERT_TRUE(value1.shared());
+    ASSERT_EQ(&value1.get(), &value2.get());
+
+    value2.mutate()[0] = 4;
+    ASSERT_FALSE(value1.shared());
+    ASSERT_NE(&value1.get(), &value2.get());
+    ASSERT_EQ(value1.get(), vector<double>({1, 2, 3}));
+    ASSERT_EQ(value2.get(), vector<double>({4, 2, 3}));
+
+    // modifying an unshared value does not clone it
+    const vector<double> *storage = &value2.get();
+    value2.mutate()[1] = 5;
+    ASSERT_EQ(storage, &value2.get());
+    ASSERT_EQ(value2.get(), vector<double>({4, 5, 3}));
+}
+
+// copies of a ciphertext share storage, but modifying one must not change the others.
+TEST(CKKSCiphertextTest, CopiesAreIndependent) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> expected = vector1;
+    for (auto &coeff : expected) {
+        coeff += 1;
+    }
+
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ciphertext1;
+    ckks_instance.add_plain_inplace(ciphertext2, 1);
+    ASSERT_LT(relative_error(vector1, ckks_instance.decrypt(ciphertext1)), MAX_NORM);
+    ASSERT_LT(relative_error(expected, ckks_instance.decrypt(ciphertext2)), MAX_NORM);
+
+    // the destination of an out-of-place operation may share storage with its input
+    CKKSCiphertext ciphertext3 = ciphertext1;
+    ckks_instance.add_plain(ciphertext1, 1, ciphertext3);
+    ASSERT_LT(relative_error(vector1, ckks_instance.decrypt(ciphertext1)), MAX_NORM);
+    ASSERT_LT(relative_error(expected, ckks_instance.decrypt(ciphertext3)), MAX_NORM);
+}
@@ -0,0 +1,101 @@
+// Copyright Amazon.com, Inc. or its affiliates. All Rights Reserved.
+// SPDX-License-Identifier: Apache-2.0
+
+#include "hit/api/evaluator/boundsestimator.h"
+
+#include "../../testutil.h"
+#include "gtest/gtest.h"
+#include "hit/api/ciphertext.h"
+#include "hit/api/evaluator/scaleestimator.h"
+#include "hit/api/linearalgebra/linearalgebra.h"
+#include "hit/common.h"
+
+using namespace std;
+using namespace hit;
+
+// Test variables.
+const int NUM_OF_SLOTS = 4096;
+const int ZERO_MULTI_DEPTH = 0;
+const int ONE_MULTI_DEPTH = 1;
+const int TWO_MULTI_DEPTH = 2;
+
+TEST(BoundsEstimatorTest, IntervalArithmetic) {
+    BoundsEstimator ckks_instance = BoundsEstimator(NUM_OF_SLOTS, TWO_MULTI_DEPTH, 16);
+    CKKSCiphertext ct1 = ckks_instance.encrypt_placeholder();
+    CKKSCiphertext ct2 = ckks_instance.encrypt_interval(1, 3);
+    vector<double> plain(NUM_OF_SLOTS, 2);
+    plain[0] = -1;
+
+    ASSERT_EQ(make_pair(-16.0, 16.0), BoundsEstimator::bounds(ct1));
+    ASSERT_EQ(make_pair(-3.0, -1.0), BoundsEstimator::bounds(ckks_instance.negate(ct2)));
+    ASSERT_EQ(make_pair(-15.0, 19.0), BoundsEstimator::bounds(ckks_instance.add(ct1, ct2)));
+    ASSERT_EQ(make_pair(-19.0, 15.0), BoundsEstimator::bounds(ckks_instance.sub(ct1, ct2)));
+    // interval arithmetic does not know that ct2 - ct2 = 0
+    ASSERT_EQ(make_pair(-2.0, 2.0), BoundsEstimator::bounds(ckks_instance.sub(ct2, ct2)));
+    ASSERT_EQ(make_pair(0.0, 5.0), BoundsEstimator::bounds(ckks_instance.add_plain(ct2, plain)));
+    ASSERT_EQ(make_pair(-1.0, 4.0), BoundsEstimator::bounds(ckks_instance.sub_plain(ct2, plain)));
+    ASSERT_EQ(make_pair(-3.0, 6.0), BoundsEstimator::bounds(ckks_instance.multiply_plain(ct2, plain)));
+    ASSERT_EQ(make_pair(-6.0, -2.0), BoundsEstimator::bounds(ckks_instance.multiply_plain(ct2, -2)));
+    ASSERT_EQ(make_pair(-48.0, 48.0), BoundsEstimator::bounds(ckks_instance.multiply(ct1, ct2)));
+    ASSERT_EQ(make_pair(0.0, 256.0), BoundsEstimator::bounds(ckks_instance.square(ct1)));
+    ASSERT_EQ(make_pair(1.0, 9.0), BoundsEstimator::bounds(ckks_instance.multiply(ct2, ct2)));
+    ASSERT_EQ(make_pair(1.0, 3.0), BoundsEstimator::bounds(ckks_instance.rotate_left(ct2, 1)));
+
+    CKKSCiphertext ct3 = ckks_instance.square(ckks_instance.encrypt_interval(-3, -2));
+    ckks_instance.relinearize_inplace(ct3);
+    ckks_instance.rescale_to_next_inplace(ct3);
+    ASSERT_EQ(make_pair(4.0, 9.0), BoundsEstimator::bounds(ct3));
+    ASSERT_EQ(ONE_MULTI_DEPTH, ct3.he_level());
+}
+
+TEST(BoundsEstimatorTest, Encrypt) {
+    BoundsEstimator ckks_instance = BoundsEstimator(NUM_OF_SLOTS, ONE_MULTI_DEPTH);
+    ScaleEstimator scale_estimator = ScaleEstimator(NUM_OF_SLOTS, ONE_MULTI_DEPTH);
+    vector<double> coeffs = random_vector(NUM_OF_SLOTS, 10);
+    auto minmax = minmax_element(coeffs.begin(), coeffs.end());
+
+    CKKSCiphertext ct = ckks_instance.encrypt(coeffs, ZERO_MULTI_DEPTH);
+    CKKSCiphertext expected = scale_estimator.encrypt(coeffs, ZERO_MULTI_DEPTH);
+    ASSERT_EQ(make_pair(*minmax.first, *minmax.second), BoundsEstimator::bounds(ct));
+    ASSERT_EQ(expected.he_level(), ct.he_level());
+    ASSERT_EQ(expected.scale(), ct.scale());
+
+    ASSERT_THROW(ckks_instance.encrypt(vector<double>(NUM_OF_SLOTS - 1)), invalid_argument);
+    ASSERT_THROW(ckks_instance.encrypt_interval(1, -1), invalid_argument);
+    ASSERT_THROW(BoundsEstimator(NUM_OF_SLOTS, ONE_MULTI_DEPTH, -1), invalid_argument);
+}
+
+TEST(BoundsEstimatorTest, EstimateIsWorstCase) {
+    BoundsEstimator ckks_instance = BoundsEstimator(NUM_OF_SLOTS, TWO_MULTI_DEPTH, 10);
+    CKKSCiphertext ct = ckks_instance.encrypt_placeholder();
+    CKKSCiphertext ct_sq = ckks_instance.square(ct);
+    ckks_instance.relinearize_inplace(ct_sq);
+    ckks_instance.rescale_to_next_inplace(ct_sq);
+    ckks_instance.multiply_inplace(ct_sq, ckks_instance.encrypt_placeholder(ct_sq.he_level()));
+
+    // the estimate for the declared range is no larger than the estimate for any sample from that range
+    for (int i = 0; i < 3; i++) {
+        ScaleEstimator scale_estimator = ScaleEstimator(NUM_OF_SLOTS, TWO_MULTI_DEPTH);
+        CKKSCiphertext sample = scale_estimator.encrypt(random_vector(NUM_OF_SLOTS, 10));
+        CKKSCiphertext sample_sq = scale_estimator.square(sample);
+        scale_estimator.relinearize_inplace(sample_sq);
+        scale_estimator.rescale_to_next_inplace(sample_sq);
+        scale_estimator.multiply_inplace(
+            sample_sq, scale_estimator.encrypt(random_vector(NUM_OF_SLOTS, 10), sample_sq.he_level()));
+        ASSERT_LE(ckks_instance.get_estimated_max_log_scale(), scale_estimator.get_estimated_max_log_scale());
+    }
+}
+
+TEST(BoundsEstimatorTest, EncryptShape) {
+    BoundsEstimator ckks_instance = BoundsEstimator(NUM_OF_SLOTS, ONE_MULTI_DEPTH, 4);
+    LinearAlgebra la_inst = LinearAlgebra(ckks_instance);
+    EncodingUnit unit = la_inst.make_unit(64);
+
+    // a dry run over placeholders bounds the scale for every matrix and vector with entries in [-4, 4]
+    EncryptedMatrix mat = la_inst.encrypt_matrix_shape(64, 64, unit);
+    EncryptedRowVector vec = la_inst.encrypt_row_vector_shape(64, unit);
+    double initial_estimate = ckks_instance.get_estimated_max_log_scale();
+    EncryptedColVector result = la_inst.multiply(vec, mat);
+    ASSERT_EQ(ONE_MULTI_DEPTH, result.he_level());
+    ASSERT_LT(ckks_instance.get_estimated_max_log_scale(), initial_estimate);
+}
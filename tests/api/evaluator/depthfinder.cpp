@@ -233,3 +233,16 @@ TEST(DepthFinderTest, RescaleToNextInPlace_ExplicitLevel) {
     ASSERT_EQ(he_level - 1, ciphertext1.he_level());
     ASSERT_EQ(1, ckks_instance.get_multiplicative_depth());
 }
+
+TEST(DepthFinderTest, EncryptPlaceholder) {
+    DepthFinder ckks_instance = DepthFinder();
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt_placeholder(2);
+    ASSERT_EQ(ciphertext1.he_level(), 2);
+    ckks_instance.square_inplace(ciphertext1);
+    ckks_instance.relinearize_inplace(ciphertext1);
+    ckks_instance.rescale_to_next_inplace(ciphertext1);
+    ASSERT_EQ(ciphertext1.he_level(), 1);
+
+    // placeholders follow the same rules for explicit encryption levels as `encrypt`
+    ASSERT_THROW(ckks_instance.encrypt_placeholder(), invalid_argument);
+}
@@ -4,6 +4,7 @@
 #include "hit/api/evaluator/homomorphic.h"
 
 #include <iostream>
+#include <thread>
 
 #include "../../testutil.h"
 #include "gtest/gtest.h"
@@ -131,6 +132,23 @@ TEST(HomomorphicTest, RotateRight_InvalidCase) {
                  invalid_argument);
 }
 
+TEST(HomomorphicTest, HasRotationKey) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE, true, {1, 3, -2});
+    ASSERT_TRUE(ckks_instance.has_rotation_key(0));
+    ASSERT_TRUE(ckks_instance.has_rotation_key(1));
+    ASSERT_TRUE(ckks_instance.has_rotation_key(3));
+    ASSERT_TRUE(ckks_instance.has_rotation_key(-2));
+    ASSERT_TRUE(ckks_instance.has_rotation_key(NUM_OF_SLOTS - 2));
+    ASSERT_FALSE(ckks_instance.has_rotation_key(2));
+    ASSERT_FALSE(ckks_instance.has_rotation_key(-1));
+
+    // by default, SEAL only generates keys for rotations by powers of two
+    HomomorphicEval default_keys = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+    ASSERT_TRUE(default_keys.has_rotation_key(4));
+    ASSERT_TRUE(default_keys.has_rotation_key(-4));
+    ASSERT_FALSE(default_keys.has_rotation_key(3));
+}
+
 TEST(HomomorphicTest, Negate) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
     CKKSCiphertext ciphertext1, ciphertext2, ciphertext3;
@@ -433,3 +451,116 @@ TEST(HomomorphicTest, RescaleToNextInPlace) {
     ASSERT_NE(diff, INVALID_NORM);
     ASSERT_LE(diff, MAX_NORM);
 }
+
+TEST(HomomorphicTest, Destination) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    vector<double> vector2 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+    CKKSCiphertext ciphertext2 = ckks_instance.encrypt(vector2);
+    vector<double> expected(NUM_OF_SLOTS);
+
+    // the same destination is reused for each result
+    CKKSCiphertext dest;
+    ckks_instance.sub(ciphertext1, ciphertext2, dest);
+    transform(vector1.begin(), vector1.end(), vector2.begin(), expected.begin(), minus<>());
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(dest)), MAX_NORM);
+    ckks_instance.rotate_left(ciphertext1, STEPS, dest);
+    for (int i = 0; i < NUM_OF_SLOTS; i++) {
+        expected[i] = vector1[(i + STEPS) % NUM_OF_SLOTS];
+    }
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(dest)), MAX_NORM);
+    ckks_instance.multiply(ciphertext1, ciphertext2, dest);
+    ASSERT_TRUE(dest.needs_relin());
+    ckks_instance.relinearize(dest, dest);
+    ckks_instance.rescale_to_next(dest, dest);
+    ASSERT_EQ(dest.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_FALSE(dest.needs_relin());
+    ASSERT_FALSE(dest.needs_rescale());
+    transform(vector1.begin(), vector1.end(), vector2.begin(), expected.begin(), multiplies<>());
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(dest)), MAX_NORM);
+    ckks_instance.multiply_plain(ciphertext1, 0, dest);
+    ASSERT_EQ(dest.scale(), pow(2, LOG_SCALE * 2));
+    ASSERT_LE(relative_error(vector<double>(NUM_OF_SLOTS), ckks_instance.decrypt(dest)), MAX_NORM);
+
+    // the destination may be either input
+    CKKSCiphertext ciphertext3 = ciphertext2;
+    ckks_instance.sub(ciphertext1, ciphertext3, ciphertext3);
+    transform(vector1.begin(), vector1.end(), vector2.begin(), expected.begin(), minus<>());
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(ciphertext3)), MAX_NORM);
+    ckks_instance.add(ciphertext3, ciphertext2, ciphertext3);
+    ASSERT_LE(relative_error(vector1, ckks_instance.decrypt(ciphertext3)), MAX_NORM);
+    ckks_instance.reduce_level_to(ciphertext3, ZERO_MULTI_DEPTH, ciphertext3);
+    ASSERT_EQ(ciphertext3.he_level(), ZERO_MULTI_DEPTH);
+    ASSERT_LE(relative_error(vector1, ckks_instance.decrypt(ciphertext3)), MAX_NORM);
+
+    // inputs are unchanged
+    ASSERT_LE(relative_error(vector1, ckks_instance.decrypt(ciphertext1)), MAX_NORM);
+    ASSERT_LE(relative_error(vector2, ckks_instance.decrypt(ciphertext2)), MAX_NORM);
+}
+
+TEST(HomomorphicTest, MemoryPools) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+
+    // this thread has its own pool
+    MemoryPoolStats stats = ckks_instance.pool_stats();
+    ASSERT_EQ(stats.num_pools, 1);
+    ASSERT_EQ(stats.arena_byte_count, 0);
+
+    // so does any other thread, until it exits
+    size_t num_pools_in_thread = 0;
+    thread other_thread([&]() {
+        ckks_instance.square(ciphertext1);
+        num_pools_in_thread = ckks_instance.pool_stats().num_pools;
+    });
+    other_thread.join();
+    ASSERT_EQ(num_pools_in_thread, 2);
+    ASSERT_EQ(ckks_instance.pool_stats().num_pools, 1);
+
+    // temporaries in an arena come from a separate pool, which is released with the arena
+    CKKSCiphertext ciphertext2;
+    {
+        MemoryArena arena(ckks_instance);
+        ASSERT_EQ(MemoryArena::current(), &arena);
+        ciphertext2 = ckks_instance.square(ciphertext1);
+        ckks_instance.relinearize_inplace(ciphertext2);
+        ASSERT_EQ(ckks_instance.pool_stats().num_pools, 2);
+
+        // arenas nest
+        {
+            MemoryArena inner_arena(ckks_instance);
+            ckks_instance.rescale_to_next_inplace(ciphertext2);
+            ASSERT_EQ(ckks_instance.pool_stats().num_pools, 3);
+        }
+        ASSERT_EQ(MemoryArena::current(), &arena);
+        ASSERT_EQ(ckks_instance.pool_stats().num_pools, 2);
+
+        // the arena does not apply to other threads, whose pools are released when they exit
+        thread unrelated_thread([&]() { ckks_instance.square(ciphertext1); });
+        unrelated_thread.join();
+        ASSERT_EQ(ckks_instance.pool_stats().num_pools, 2);
+    }
+    ASSERT_EQ(MemoryArena::current(), nullptr);
+    ASSERT_EQ(ckks_instance.pool_stats().num_pools, 1);
+
+    // results computed in the arena outlive it
+    vector<double> expected(NUM_OF_SLOTS);
+    transform(vector1.begin(), vector1.end(), expected.begin(), [](double x) { return x * x; });
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(ciphertext2)), MAX_NORM);
+}
+
+TEST(HomomorphicTest, AdviseHugePages) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    vector<double> vector1 = random_vector(NUM_OF_SLOTS, RANGE);
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt(vector1);
+
+    // advice is only a hint, so whether any memory is advised depends on the kernel,
+    // but the keys must be unaffected
+    ckks_instance.advise_huge_pages();
+    CKKSCiphertext ciphertext2 = ckks_instance.rotate_left(ciphertext1, STEPS);
+    vector<double> expected(NUM_OF_SLOTS);
+    rotate_copy(vector1.begin(), vector1.begin() + STEPS, vector1.end(), expected.begin());
+    ASSERT_LE(relative_error(expected, ckks_instance.decrypt(ciphertext2)), MAX_NORM);
+}
@@ -22,3 +22,18 @@ TEST(OpcountTest, BasicFlow) {
     ckks_instance.relinearize_inplace(ciphertext);
     ckks_instance.rescale_to_next_inplace(ciphertext);
 }
+
+TEST(OpcountTest, HasRotationKey) {
+    // like HomomorphicEval, the default keys rotate by every power of two in either direction
+    OpCount default_keys = OpCount(NUM_OF_SLOTS);
+    ASSERT_TRUE(default_keys.has_rotation_key(0));
+    ASSERT_TRUE(default_keys.has_rotation_key(4));
+    ASSERT_TRUE(default_keys.has_rotation_key(-4));
+    ASSERT_FALSE(default_keys.has_rotation_key(3));
+
+    OpCount explicit_keys = OpCount(NUM_OF_SLOTS, {3, -5});
+    ASSERT_TRUE(explicit_keys.has_rotation_key(3));
+    // rotating right by 5 is the same as rotating left by NUM_OF_SLOTS-5
+    ASSERT_TRUE(explicit_keys.has_rotation_key(NUM_OF_SLOTS - 5));
+    ASSERT_FALSE(explicit_keys.has_rotation_key(4));
+}
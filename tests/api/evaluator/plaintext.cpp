@@ -263,3 +263,60 @@ TEST(PlaintextTest, Square) {
     ASSERT_NE(diff, INVALID_NORM);
     ASSERT_LE(diff, MAX_NORM);
 }
+
+TEST(PlaintextTest, Batched) {
+    int num_samples = 3;
+    PlaintextEval ckks_instance = PlaintextEval(NUM_OF_SLOTS, num_samples);
+    PlaintextEval single_instance = PlaintextEval(NUM_OF_SLOTS);
+    vector<vector<double>> samples;
+    for (int i = 0; i < num_samples; i++) {
+        samples.push_back(random_vector(NUM_OF_SLOTS, RANGE));
+    }
+    vector<double> plain = random_vector(NUM_OF_SLOTS, RANGE);
+
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt_batch(samples);
+    CKKSCiphertext ciphertext2 = ckks_instance.encrypt(plain);
+    CKKSCiphertext ciphertext3 = ckks_instance.rotate_left(ckks_instance.add(ciphertext1, ciphertext2), STEPS);
+    ckks_instance.multiply_plain_inplace(ciphertext3, plain);
+    vector<double> batch = ciphertext3.plaintext();
+    ASSERT_EQ(NUM_OF_SLOTS * num_samples, batch.size());
+
+    // each sample matches an unbatched evaluation of the same circuit
+    for (int i = 0; i < num_samples; i++) {
+        CKKSCiphertext expected = single_instance.rotate_left(
+            single_instance.add(single_instance.encrypt(samples[i]), single_instance.encrypt(plain)), STEPS);
+        single_instance.multiply_plain_inplace(expected, plain);
+        vector<double> actual(batch.begin() + i * NUM_OF_SLOTS, batch.begin() + (i + 1) * NUM_OF_SLOTS);
+        ASSERT_EQ(expected.plaintext(), actual);
+    }
+    ASSERT_EQ(single_instance.get_exact_max_log_plain_val(), ckks_instance.get_exact_max_log_plain_val());
+
+    ASSERT_THROW(ckks_instance.encrypt_batch(vector<vector<double>>(num_samples - 1, plain)), invalid_argument);
+    ASSERT_THROW(PlaintextEval(NUM_OF_SLOTS, 0), invalid_argument);
+}
+
+TEST(PlaintextTest, PendingRotations) {
+    int num_samples = 2;
+    PlaintextEval ckks_instance = PlaintextEval(NUM_OF_SLOTS, num_samples);
+    vector<vector<double>> samples1 = {random_vector(NUM_OF_SLOTS, RANGE), random_vector(NUM_OF_SLOTS, RANGE)};
+    vector<vector<double>> samples2 = {random_vector(NUM_OF_SLOTS, RANGE), random_vector(NUM_OF_SLOTS, RANGE)};
+    vector<double> plain = random_vector(NUM_OF_SLOTS, RANGE);
+
+    // operands with different rotations are combined without rotating either one in memory
+    CKKSCiphertext ciphertext1 = ckks_instance.rotate_left(ckks_instance.encrypt_batch(samples1), 5);
+    CKKSCiphertext ciphertext2 = ckks_instance.rotate_right(ckks_instance.encrypt_batch(samples2), 3);
+    CKKSCiphertext ciphertext3 = ckks_instance.sub(ciphertext1, ciphertext2);
+    ckks_instance.multiply_plain_inplace(ciphertext3, plain);
+    ckks_instance.rotate_right_inplace(ciphertext3, 5);
+    ckks_instance.add_plain_inplace(ciphertext3, 1);
+
+    vector<double> batch = ciphertext3.plaintext();
+    for (int i = 0; i < num_samples; i++) {
+        for (int j = 0; j < NUM_OF_SLOTS; j++) {
+            int k = (j - 5 + NUM_OF_SLOTS) % NUM_OF_SLOTS;
+            double expected = (samples1[i][(k + 5) % NUM_OF_SLOTS] -
+                               samples2[i][(k - 3 + NUM_OF_SLOTS) % NUM_OF_SLOTS]) * plain[k] + 1;
+            ASSERT_EQ(expected, batch[i * NUM_OF_SLOTS + j]);
+        }
+    }
+}
@@ -266,3 +266,32 @@ TEST(ScaleEstimatorTest, RescaleToNextInPlace) {
     double estimatedMaxLogScale = PLAINTEXT_LOG_MAX - log2(VALUE * VALUE);
     ASSERT_EQ(estimatedMaxLogScale, ckks_instance.get_estimated_max_log_scale());
 }
+
+TEST(ScaleEstimatorTest, Batched) {
+    int num_samples = 4;
+    ScaleEstimator ckks_instance = ScaleEstimator(NUM_OF_SLOTS, ONE_MULTI_DEPTH, num_samples);
+    vector<vector<double>> samples;
+    for (int i = 0; i < num_samples; i++) {
+        samples.push_back(vector<double>(NUM_OF_SLOTS, VALUE * (i + 1)));
+    }
+    CKKSCiphertext ciphertext1 = ckks_instance.encrypt_batch(samples);
+    CKKSCiphertext ciphertext2 = ckks_instance.square(ciphertext1);
+    ckks_instance.rescale_to_next_inplace(ciphertext2);
+
+    // each sample's estimate matches an unbatched estimate for that sample
+    vector<double> estimates = ckks_instance.get_estimated_max_log_scales();
+    ASSERT_EQ(num_samples, estimates.size());
+    for (int i = 0; i < num_samples; i++) {
+        ScaleEstimator single_instance = ScaleEstimator(NUM_OF_SLOTS, ONE_MULTI_DEPTH);
+        CKKSCiphertext ciphertext3 = single_instance.square(single_instance.encrypt(samples[i]));
+        single_instance.rescale_to_next_inplace(ciphertext3);
+        ASSERT_EQ(single_instance.get_estimated_max_log_scale(), estimates[i]);
+    }
+
+    // larger samples need smaller scales
+    ASSERT_EQ(estimates[num_samples - 1], ckks_instance.get_estimated_max_log_scale());
+    ASSERT_EQ(estimates[num_samples - 1], ckks_instance.get_estimated_max_log_scale_percentile(0));
+    ASSERT_EQ(estimates[2], ckks_instance.get_estimated_max_log_scale_percentile(50));
+    ASSERT_EQ(estimates[0], ckks_instance.get_estimated_max_log_scale_percentile(100));
+    ASSERT_THROW(ckks_instance.get_estimated_max_log_scale_percentile(101), invalid_argument);
+}
@@ -31,3 +31,38 @@ TEST(EncryptMatrixTest, Serialization) {
     Matrix output = laInst.decrypt(ct2);
     ASSERT_LT(relative_error(plaintext, output), MAX_NORM);
 }
+
+TEST(EncryptMatrixTest, Serialization_ZeroUnits) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+    auto laInst = LinearAlgebra(ckks_instance);
+    EncodingUnit unit1 = laInst.make_unit(64);
+    // the bottom-left unit of the matrix is zero
+    Matrix plaintext = random_mat(128, 100);
+    for (int i = 64; i < 128; i++) {
+        for (int j = 0; j < 64; j++) {
+            plaintext(i, j) = 0;
+        }
+    }
+    EncryptedMatrix ct1 = laInst.encrypt_matrix(plaintext, unit1, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct2 = EncryptedMatrix(ckks_instance.context, *ct1.serialize());
+    ASSERT_FALSE(ct2.is_zero_unit(0, 0));
+    ASSERT_FALSE(ct2.is_zero_unit(0, 1));
+    ASSERT_TRUE(ct2.is_zero_unit(1, 0));
+    ASSERT_FALSE(ct2.is_zero_unit(1, 1));
+    ASSERT_TRUE(ct2.is_zero_padded());
+    Matrix output = laInst.decrypt(ct2);
+    ASSERT_LT(relative_error(plaintext, output), MAX_NORM);
+}
+
+TEST(EncryptMatrixTest, Serialization_Diagonal) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ZERO_MULTI_DEPTH, LOG_SCALE);
+    auto laInst = LinearAlgebra(ckks_instance);
+    EncodingUnit unit1 = laInst.make_unit(64);
+    Matrix plaintext = random_mat(100, 70);
+    EncryptedMatrix ct1 = laInst.encrypt_matrix(plaintext, unit1, -1, LAYOUT_DIAGONAL);
+    EncryptedMatrix ct2 = EncryptedMatrix(ckks_instance.context, *ct1.serialize());
+    ASSERT_EQ(ct2.layout(), LAYOUT_DIAGONAL);
+    ASSERT_EQ(ct1.num_horizontal_units(), ct2.num_horizontal_units());
+    Matrix output = laInst.decrypt(ct2);
+    ASSERT_LT(relative_error(plaintext, output), MAX_NORM);
+}
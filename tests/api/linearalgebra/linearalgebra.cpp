@@ -8,7 +8,9 @@
 #include "../../testutil.h"
 #include "gtest/gtest.h"
 #include "hit/api/ciphertext.h"
+#include "hit/api/evaluator/depthfinder.h"
 #include "hit/api/evaluator/homomorphic.h"
+#include "hit/api/evaluator/opcount.h"
 #include "hit/common.h"
 #include "hit/sealutils.h"
 
@@ -1299,6 +1301,88 @@ TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Row_Major_Mixed_Unit) {
                                                      unit1_width - 11, PI, unit1);
 }
 
+TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Row_Major_Strassen_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    Matrix mat1 = random_mat(55, 78);
+    Matrix mat2 = random_mat(77, 39);
+    EncryptedMatrix ciphertext1 = linear_algebra.encrypt_matrix(mat1, unit1);
+    EncryptedMatrix ciphertext2 = linear_algebra.encrypt_matrix(mat2, unit1, ciphertext1.he_level() - 1);
+    EncryptedMatrix ciphertext3 = linear_algebra.encrypt_matrix(mat1, unit1, ciphertext1.he_level() - 1);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because inner dimensions do not match.
+        (linear_algebra.multiply_row_major_strassen(ciphertext1, ciphertext2)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the cutoff is too small.
+        (linear_algebra.multiply_row_major_strassen(ciphertext1, ciphertext3, 1, 1)), invalid_argument);
+}
+
+void test_multiply_matrix_matrix_row_major_strassen(LinearAlgebra &linear_algebra, int left_dim, int inner_dim,
+                                                    int right_dim, double scalar, EncodingUnit &unit) {
+    // Matrix A is left_dim x inner_dim, so A^T is the reverse
+    Matrix matrix_a_transpose = random_mat(inner_dim, left_dim);
+    // Matrix B is inner_dim x right_dim
+    Matrix matrix_b = random_mat(inner_dim, right_dim);
+
+    EncryptedMatrix ct_a_transpose = linear_algebra.encrypt_matrix(matrix_a_transpose, unit);
+    EncryptedMatrix ct_b = linear_algebra.encrypt_matrix(matrix_b, unit, ct_a_transpose.he_level() - 1);
+    // use the smallest cutoff so that the recursion is exercised on small inputs
+    EncryptedMatrix ct_c_times_A_times_B =
+        linear_algebra.multiply_row_major_strassen(ct_a_transpose, ct_b, scalar, 2);
+    Matrix actual_output = linear_algebra.decrypt(ct_c_times_A_times_B);
+
+    Matrix matrix_a = trans(matrix_a_transpose);
+    Matrix expected_output = scalar * prec_prod(matrix_a, matrix_b);
+
+    ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+    ASSERT_FALSE(ct_c_times_A_times_B.needs_relin());
+    ASSERT_TRUE(ct_c_times_A_times_B.needs_rescale());
+    ASSERT_EQ(ct_c_times_A_times_B.he_level(), ONE_MULTI_DEPTH);
+}
+
+TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Row_Major_Strassen) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    // every dimension splits evenly into two blocks of units
+    test_multiply_matrix_matrix_row_major_strassen(linear_algebra, 256, 128, 256, PI, unit1);
+    // padding required
+    test_multiply_matrix_matrix_row_major_strassen(linear_algebra, 200, 100, 150, PI, unit1);
+    // the left dimension can't be split into whole units, so this uses multiply_row_major
+    test_multiply_matrix_matrix_row_major_strassen(linear_algebra, 150, 100, 150, PI, unit1);
+    // smaller than the cutoff
+    test_multiply_matrix_matrix_row_major_strassen(linear_algebra, 13, 78, 141, PI, unit1);
+}
+
+TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Row_Major_Strassen_Depth) {
+    // a 64x64 encoding unit
+    DepthFinder depth_finder;
+    LinearAlgebra linear_algebra = LinearAlgebra(depth_finder);
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    EncryptedMatrix ct_a_transpose = linear_algebra.encrypt_matrix(random_mat(128, 128), unit1, THREE_MULTI_DEPTH);
+    EncryptedMatrix ct_b = linear_algebra.encrypt_matrix(random_mat(128, 128), unit1, TWO_MULTI_DEPTH);
+    linear_algebra.multiply_row_major(ct_a_transpose, ct_b);
+    int depth = depth_finder.get_multiplicative_depth();
+
+    DepthFinder depth_finder2;
+    LinearAlgebra linear_algebra2 = LinearAlgebra(depth_finder2);
+    ct_a_transpose = linear_algebra2.encrypt_matrix(random_mat(128, 128), unit1, THREE_MULTI_DEPTH);
+    ct_b = linear_algebra2.encrypt_matrix(random_mat(128, 128), unit1, TWO_MULTI_DEPTH);
+    linear_algebra2.multiply_row_major_strassen(ct_a_transpose, ct_b, 1, 2);
+
+    // block additions do not consume any levels
+    ASSERT_EQ(depth_finder2.get_multiplicative_depth(), depth);
+}
+
 TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Col_Major_InvalidCase) {
     HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
     LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
@@ -1401,6 +1485,503 @@ TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Col_Major) {
     test_multiply_matrix_matrix_col_major(linear_algebra, 300, 27, 29, PI, unit1);
 }
 
+TEST(LinearAlgebraTest, MultiplyMatrixPlaintextMatrix_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, TWO_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    int unit1_height = 64;
+    EncodingUnit unit1 = linear_algebra.make_unit(unit1_height);
+
+    Matrix mat1 = random_mat(55, 78);
+    Matrix mat2 = random_mat(77, 39);
+    EncryptedMatrix ciphertext1 = linear_algebra.encrypt_matrix(mat1, unit1);
+    EncryptedMatrix ciphertext2 = linear_algebra.encrypt_matrix(mat2, unit1);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because inner dimensions do not match.
+        (linear_algebra.multiply_plain(ciphertext1, mat2)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because inner dimensions do not match.
+        (linear_algebra.multiply_plain(mat2, ciphertext1)), invalid_argument);
+
+    EncryptedMatrix ciphertext3 = linear_algebra.hadamard_multiply(ciphertext2, ciphertext2);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the ciphertext is not linear.
+        (linear_algebra.multiply_plain(mat1, ciphertext3)), invalid_argument);
+}
+
+void test_multiply_matrix_plaintext_matrix(LinearAlgebra &linear_algebra, int left_dim, int inner_dim,
+                                           int right_dim, double scalar, EncodingUnit &unit) {
+    // Matrix A is left_dim x inner_dim
+    Matrix matrix_a = random_mat(left_dim, inner_dim);
+    // Matrix B is inner_dim x right_dim
+    Matrix matrix_b = random_mat(inner_dim, right_dim);
+    Matrix expected_output = scalar * prec_prod(matrix_a, matrix_b);
+
+    // encrypted A, public B
+    EncryptedMatrix ct_a = linear_algebra.encrypt_matrix(matrix_a, unit);
+    EncryptedMatrix ct_a_times_b = linear_algebra.multiply_plain(ct_a, matrix_b, scalar);
+    Matrix actual_output = linear_algebra.decrypt(ct_a_times_b);
+
+    ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+    ASSERT_FALSE(ct_a_times_b.needs_relin());
+    ASSERT_TRUE(ct_a_times_b.needs_rescale());
+    ASSERT_EQ(ct_a_times_b.he_level(), ct_a.he_level() - 1);
+
+    // public A, encrypted B
+    EncryptedMatrix ct_b = linear_algebra.encrypt_matrix(matrix_b, unit);
+    ct_a_times_b = linear_algebra.multiply_plain(matrix_a, ct_b, scalar);
+    actual_output = linear_algebra.decrypt(ct_a_times_b);
+
+    ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+    ASSERT_FALSE(ct_a_times_b.needs_relin());
+    ASSERT_TRUE(ct_a_times_b.needs_rescale());
+    ASSERT_EQ(ct_a_times_b.he_level(), ct_b.he_level() - 1);
+}
+
+TEST(LinearAlgebraTest, MultiplyMatrixPlaintextMatrix) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, TWO_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    int unit1_height = 64;
+    EncodingUnit unit1 = linear_algebra.make_unit(unit1_height);
+
+    int unit1_width = 8192 / unit1_height;
+
+    // both matrices are exactly the size of the encoding unit
+    test_multiply_matrix_plaintext_matrix(linear_algebra, unit1_height, unit1_width, unit1_width, 1.0, unit1);
+    test_multiply_matrix_plaintext_matrix(linear_algebra, unit1_height, unit1_width, unit1_width, PI, unit1);
+
+    // one or more dimensions are are multiple of the encoding unit (no padding)
+    int large_width = 2 * unit1_width;
+    int large_height = 2 * unit1_height;
+    test_multiply_matrix_plaintext_matrix(linear_algebra, large_height, unit1_width, unit1_width, PI, unit1);
+    test_multiply_matrix_plaintext_matrix(linear_algebra, unit1_height, large_width, large_width, PI, unit1);
+
+    // one or more dimensions are larger than the encoding unit (padding required)
+    test_multiply_matrix_plaintext_matrix(linear_algebra, unit1_height + 11, unit1_width + 17, unit1_height, PI,
+                                          unit1);
+
+    // some random dimensions
+    test_multiply_matrix_plaintext_matrix(linear_algebra, 13, 78, 141, PI, unit1);
+    test_multiply_matrix_plaintext_matrix(linear_algebra, 67, 17, 312, PI, unit1);
+    test_multiply_matrix_plaintext_matrix(linear_algebra, 300, 27, 29, PI, unit1);
+
+    // the public factor has a block of zeros, so some plaintext segments are all zero
+    Matrix matrix_a = random_mat(100, large_width);
+    Matrix matrix_b = random_mat(large_width, 150);
+    for (int i = 0; i < large_width; i++) {
+        for (int j = 0; j < 150; j++) {
+            // rows of B covered by the second horizontal unit of A
+            if (i >= unit1_width) {
+                matrix_b(i, j) = 0;
+            }
+        }
+        for (int j = 0; j < 100; j++) {
+            // columns of A covered by the second vertical unit of B
+            if (i >= unit1_height && i < 2 * unit1_height) {
+                matrix_a(j, i) = 0;
+            }
+        }
+    }
+    Matrix expected_output = PI * prec_prod(matrix_a, matrix_b);
+    EncryptedMatrix ct_a = linear_algebra.encrypt_matrix(matrix_a, unit1);
+    EncryptedMatrix ct_b = linear_algebra.encrypt_matrix(matrix_b, unit1);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.multiply_plain(ct_a, matrix_b, PI)),
+                             expected_output),
+              MAX_NORM);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.multiply_plain(matrix_a, ct_b, PI)),
+                             expected_output),
+              MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Square_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    // a 128x64 encoding unit
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+
+    Matrix mat1 = random_mat(20, 30);
+    Matrix mat2 = random_mat(30, 40);
+    EncryptedMatrix ciphertext1 = linear_algebra.encrypt_matrix(mat1, unit1);
+    EncryptedMatrix ciphertext2 = linear_algebra.encrypt_matrix(mat2, unit1);
+    EncryptedMatrix ciphertext3 = linear_algebra.encrypt_matrix(mat2, unit2);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the units do not match.
+        (linear_algebra.multiply_square(ciphertext1, ciphertext3)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because inner dimensions do not match.
+        (linear_algebra.multiply_square(ciphertext2, ciphertext1)), invalid_argument);
+
+    EncryptedMatrix ciphertext4 = linear_algebra.reduce_level_to(ciphertext2, ciphertext2.he_level() - 1);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the inputs are at different levels.
+        (linear_algebra.multiply_square(ciphertext1, ciphertext4)), invalid_argument);
+
+    Matrix mat3 = random_mat(30, 65);
+    EncryptedMatrix ciphertext5 = linear_algebra.encrypt_matrix(mat3, unit1);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the output does not fit into a single 64x64 block.
+        (linear_algebra.multiply_square(ciphertext1, ciphertext5)), invalid_argument);
+}
+
+void test_multiply_matrix_matrix_square(LinearAlgebra &linear_algebra, int left_dim, int inner_dim, int right_dim,
+                                        double scalar, EncodingUnit &unit) {
+    // Matrix A is left_dim x inner_dim
+    Matrix matrix_a = random_mat(left_dim, inner_dim);
+    // Matrix B is inner_dim x right_dim
+    Matrix matrix_b = random_mat(inner_dim, right_dim);
+    Matrix expected_output = scalar * prec_prod(matrix_a, matrix_b);
+
+    EncryptedMatrix ct_a = linear_algebra.encrypt_matrix(matrix_a, unit);
+    EncryptedMatrix ct_b = linear_algebra.encrypt_matrix(matrix_b, unit);
+    EncryptedMatrix ct_a_times_b = linear_algebra.multiply_square(ct_a, ct_b, scalar);
+    Matrix actual_output = linear_algebra.decrypt(ct_a_times_b, true);
+
+    ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+    ASSERT_FALSE(ct_a_times_b.needs_relin());
+    ASSERT_TRUE(ct_a_times_b.needs_rescale());
+    ASSERT_EQ(ct_a_times_b.he_level(), ct_a.he_level() - 2);
+}
+
+TEST(LinearAlgebraTest, MultiplyMatrixMatrix_Square) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    // a 128x64 encoding unit
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+
+    // the matrices fill the encoding unit vertically
+    test_multiply_matrix_matrix_square(linear_algebra, 64, 64, 64, 1.0, unit1);
+    test_multiply_matrix_matrix_square(linear_algebra, 64, 64, 64, PI, unit1);
+    test_multiply_matrix_matrix_square(linear_algebra, 13, 64, 9, PI, unit1);
+
+    // padding required
+    test_multiply_matrix_matrix_square(linear_algebra, 13, 17, 9, PI, unit1);
+    test_multiply_matrix_matrix_square(linear_algebra, 1, 1, 1, PI, unit1);
+    test_multiply_matrix_matrix_square(linear_algebra, 64, 64, 64, PI, unit2);
+    test_multiply_matrix_matrix_square(linear_algebra, 30, 17, 41, PI, unit2);
+}
+
+TEST(LinearAlgebraTest, PlanMultiply) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    // a very small product is cheapest with multiply_square
+    ASSERT_EQ(linear_algebra.plan_multiply(3, 3, 3, unit1, 3), MATMUL_SQUARE);
+
+    // multiply_square is not available for matrices which do not fit into a single block
+    ASSERT_NE(linear_algebra.plan_multiply(65, 64, 64, unit1, 3), MATMUL_SQUARE);
+    ASSERT_NE(linear_algebra.plan_multiply(300, 27, 29, unit1, 3), MATMUL_SQUARE);
+
+    // a single output row is cheapest to compute in row-major order
+    ASSERT_EQ(linear_algebra.plan_multiply(1, 200, 300, unit1, 3), MATMUL_ROW_MAJOR);
+    // a single output column is cheapest to compute in column-major order
+    ASSERT_EQ(linear_algebra.plan_multiply(300, 200, 1, unit1, 3), MATMUL_COL_MAJOR);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the level is too low for matrix multiplication.
+        (linear_algebra.plan_multiply(8, 8, 8, unit1, 2)), invalid_argument);
+}
+
+TEST(LinearAlgebraTest, PlanMultiply_MinimumLevel) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    // every kernel chosen by the planner can be evaluated with inputs at the minimum level
+    vector<vector<int>> dims = {{3, 3, 3}, {1, 200, 30}, {30, 200, 1}};
+    for (const auto &dim : dims) {
+        Matrix matrix_a = random_mat(dim[0], dim[1]);
+        Matrix matrix_b = random_mat(dim[1], dim[2]);
+        EncryptedMatrix ct_c;
+        switch (linear_algebra.plan_multiply(dim[0], dim[1], dim[2], unit1, THREE_MULTI_DEPTH)) {
+            case MATMUL_ROW_MAJOR:
+                ct_c = linear_algebra.multiply_row_major(
+                    linear_algebra.encrypt_matrix(trans(matrix_a), unit1, THREE_MULTI_DEPTH),
+                    linear_algebra.encrypt_matrix(matrix_b, unit1, TWO_MULTI_DEPTH));
+                break;
+            case MATMUL_COL_MAJOR:
+                ct_c = linear_algebra.multiply_col_major(
+                    linear_algebra.encrypt_matrix(matrix_a, unit1, TWO_MULTI_DEPTH),
+                    linear_algebra.encrypt_matrix(trans(matrix_b), unit1, THREE_MULTI_DEPTH));
+                break;
+            case MATMUL_SQUARE:
+                ct_c = linear_algebra.multiply_square(
+                    linear_algebra.encrypt_matrix(matrix_a, unit1, THREE_MULTI_DEPTH),
+                    linear_algebra.encrypt_matrix(matrix_b, unit1, THREE_MULTI_DEPTH));
+                break;
+        }
+        Matrix expected_output = prec_prod(matrix_a, matrix_b);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(ct_c), expected_output), MAX_NORM);
+        ASSERT_EQ(ct_c.he_level(), ONE_MULTI_DEPTH);
+    }
+}
+
+LinearAlgebraCost op_count_cost(const OpCount &op_count, const LinearAlgebraCost &before) {
+    LinearAlgebraCost cost;
+    cost.ciphertexts = op_count.num_encryptions() - before.ciphertexts;
+    cost.rotations = op_count.num_rotations() - before.rotations;
+    cost.multiplications = op_count.num_multiplications() - before.multiplications;
+    cost.relinearizations = op_count.num_relinearizations() - before.relinearizations;
+    cost.rescales = op_count.num_rescales() - before.rescales;
+    return cost;
+}
+
+void test_estimate_cost(LinearAlgebra &linear_algebra, OpCount &op_count, const LinearAlgebraOp &op,
+                        const EncodingUnit &unit) {
+    int level = 3;
+    LinearAlgebraCost before = op_count_cost(op_count, LinearAlgebraCost());
+    switch (op.type) {
+        case OP_ROW_VECTOR_MATRIX:
+            linear_algebra.multiply(linear_algebra.encrypt_row_vector(random_vec(op.height), unit, level),
+                                    linear_algebra.encrypt_matrix(random_mat(op.height, op.width), unit, level));
+            break;
+        case OP_MATRIX_COL_VECTOR:
+            linear_algebra.multiply(linear_algebra.encrypt_matrix(random_mat(op.height, op.width), unit, level),
+                                    linear_algebra.encrypt_col_vector(random_vec(op.width), unit, level));
+            break;
+        case OP_SUM_ROWS:
+            linear_algebra.sum_rows(linear_algebra.encrypt_matrix(random_mat(op.height, op.width), unit, level));
+            break;
+        case OP_SUM_COLS:
+            linear_algebra.sum_cols(linear_algebra.encrypt_matrix(random_mat(op.height, op.width), unit, level));
+            break;
+        case OP_MATMUL_ROW_MAJOR:
+            linear_algebra.multiply_row_major(
+                linear_algebra.encrypt_matrix(random_mat(op.width, op.height), unit, level),
+                linear_algebra.encrypt_matrix(random_mat(op.width, op.right_width), unit, level - 1));
+            break;
+        case OP_MATMUL_COL_MAJOR:
+            linear_algebra.multiply_col_major(
+                linear_algebra.encrypt_matrix(random_mat(op.height, op.width), unit, level - 1),
+                linear_algebra.encrypt_matrix(random_mat(op.right_width, op.width), unit, level));
+            break;
+    }
+    LinearAlgebraCost actual = op_count_cost(op_count, before);
+    LinearAlgebraCost expected = linear_algebra.estimate_cost({op}, unit);
+
+    ASSERT_EQ(actual.ciphertexts, expected.ciphertexts);
+    ASSERT_EQ(actual.rotations, expected.rotations);
+    ASSERT_EQ(actual.multiplications, expected.multiplications);
+    ASSERT_EQ(actual.relinearizations, expected.relinearizations);
+    ASSERT_EQ(actual.rescales, expected.rescales);
+}
+
+TEST(LinearAlgebraTest, EstimateCost) {
+    OpCount op_count = OpCount(8192);
+    LinearAlgebra linear_algebra = LinearAlgebra(op_count);
+
+    for (int height : {16, 64, 512}) {
+        EncodingUnit unit = linear_algebra.make_unit(height);
+        for (auto type : {OP_ROW_VECTOR_MATRIX, OP_MATRIX_COL_VECTOR, OP_SUM_ROWS, OP_SUM_COLS}) {
+            test_estimate_cost(linear_algebra, op_count, LinearAlgebraOp{type, 100, 37}, unit);
+            test_estimate_cost(linear_algebra, op_count, LinearAlgebraOp{type, 300, 700}, unit);
+        }
+        for (auto type : {OP_MATMUL_ROW_MAJOR, OP_MATMUL_COL_MAJOR}) {
+            test_estimate_cost(linear_algebra, op_count, LinearAlgebraOp{type, 70, 37, 45}, unit);
+            test_estimate_cost(linear_algebra, op_count, LinearAlgebraOp{type, 20, 150, 600}, unit);
+        }
+    }
+
+    // operations are weighted by their count
+    EncodingUnit unit = linear_algebra.make_unit(64);
+    LinearAlgebraCost once = linear_algebra.estimate_cost({LinearAlgebraOp{OP_SUM_COLS, 100, 37}}, unit);
+    LinearAlgebraCost twice = linear_algebra.estimate_cost(
+        {LinearAlgebraOp{OP_SUM_COLS, 100, 37}, LinearAlgebraOp{OP_SUM_COLS, 100, 37}}, unit);
+    ASSERT_EQ(twice.rotations, 2 * once.rotations);
+    ASSERT_EQ(
+        linear_algebra.estimate_cost({LinearAlgebraOp{OP_SUM_COLS, 100, 37, 0, 2}}, unit).rotations, twice.rotations);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because matrix products need a right dimension.
+        (linear_algebra.estimate_cost({LinearAlgebraOp{OP_MATMUL_ROW_MAJOR, 100, 37}}, unit)), invalid_argument);
+}
+
+TEST(LinearAlgebraTest, EstimateCost_RotationRadix) {
+    // keys for every rotation needed by radix-4 ladders
+    vector<int> galois_steps;
+    for (int shift = 1; shift < NUM_OF_SLOTS; shift <<= 1) {
+        for (int k = 1; k < 4 && k * shift < NUM_OF_SLOTS; k++) {
+            galois_steps.push_back(k * shift);
+            galois_steps.push_back(-k * shift);
+        }
+    }
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, true, galois_steps);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    linear_algebra.set_max_rotation_radix(4);
+
+    // three worker threads on a single node, so that key switches are counted
+    NumaTopology topology;
+    topology.node_cpus = {{0, 0, 0}};
+    topology.cpu_node = {0};
+    ckks_instance.replicate_keys(topology);
+    linear_algebra.enable_numa(topology);
+
+    EncodingUnit unit = linear_algebra.make_unit(64);
+    auto key_switches = [&](const LinearAlgebraOp &op) {
+        LinearAlgebraCost cost = linear_algebra.estimate_cost({op}, unit);
+        return cost.rotations + cost.relinearizations;
+    };
+
+    // a single ciphertext in flight uses three radix-4 rounds rather than six radix-2 rounds
+    ASSERT_EQ(linear_algebra.estimate_cost({LinearAlgebraOp{OP_SUM_ROWS, 64, 64}}, unit).rotations, 9);
+
+    for (int width : {64, 192}) {
+        Matrix mat = random_mat(64, width);
+        size_t before = ckks_instance.key_switches_per_node()[0];
+        linear_algebra.sum_rows(linear_algebra.encrypt_matrix(mat, unit));
+        ASSERT_EQ(ckks_instance.key_switches_per_node()[0] - before, key_switches({OP_SUM_ROWS, 64, width}));
+
+        before = ckks_instance.key_switches_per_node()[0];
+        linear_algebra.multiply(linear_algebra.encrypt_row_vector(random_vec(64), unit),
+                                linear_algebra.encrypt_matrix(mat, unit));
+        ASSERT_EQ(ckks_instance.key_switches_per_node()[0] - before, key_switches({OP_ROW_VECTOR_MATRIX, 64, width}));
+    }
+    for (int height : {64, 192}) {
+        Matrix mat = random_mat(height, 64);
+        size_t before = ckks_instance.key_switches_per_node()[0];
+        linear_algebra.sum_cols(linear_algebra.encrypt_matrix(mat, unit));
+        ASSERT_EQ(ckks_instance.key_switches_per_node()[0] - before, key_switches({OP_SUM_COLS, height, 64}));
+    }
+}
+
+TEST(LinearAlgebraTest, PlanUnit) {
+    OpCount op_count = OpCount(8192);
+    LinearAlgebra linear_algebra = LinearAlgebra(op_count);
+
+    vector<LinearAlgebraOp> ops = {LinearAlgebraOp{OP_MATRIX_COL_VECTOR, 1000, 8}};
+    EncodingUnit best = linear_algebra.plan_unit(ops);
+    LinearAlgebraCost best_cost = linear_algebra.estimate_cost(ops, best);
+    for (int height = 1; height <= 8192; height <<= 1) {
+        LinearAlgebraCost cost = linear_algebra.estimate_cost(ops, linear_algebra.make_unit(height));
+        ASSERT_LE(best_cost.rotations + best_cost.relinearizations, cost.rotations + cost.relinearizations);
+    }
+    // a tall, narrow matrix is best encoded with a tall, narrow unit
+    ASSERT_EQ(best.encoding_height(), 2048);
+
+    // a short, wide matrix is best encoded with a short, wide unit
+    ASSERT_LE(linear_algebra.plan_unit({LinearAlgebraOp{OP_ROW_VECTOR_MATRIX, 8, 1000}}).encoding_height(), 8);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because there are no operations.
+        (linear_algebra.plan_unit({})), invalid_argument);
+}
+
+TEST(LinearAlgebraTest, Gram_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    EncryptedMatrix ciphertext1 = linear_algebra.encrypt_matrix(random_mat(100, 20), unit1);
+    EncryptedMatrix ciphertext2 = linear_algebra.hadamard_square(ciphertext1);
+    EncryptedMatrix ciphertext3 = linear_algebra.encrypt_matrix(random_mat(100, 20), unit1, -1, LAYOUT_DIAGONAL);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the input is not linear.
+        (linear_algebra.gram(ciphertext2)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the input is not in the row-major layout.
+        (linear_algebra.gram(ciphertext3)), invalid_argument);
+}
+
+void test_gram(LinearAlgebra &linear_algebra, int height, int width, EncodingUnit &unit) {
+    Matrix mat = random_mat(height, width);
+    Matrix expected_output = prec_prod(trans(mat), mat);
+
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit);
+    EncryptedMatrix ct_gram = linear_algebra.gram(ct_mat);
+    ASSERT_EQ(ct_gram.layout(), LAYOUT_DIAGONAL);
+    ASSERT_FALSE(ct_gram.needs_relin());
+    ASSERT_TRUE(ct_gram.needs_rescale());
+    ASSERT_EQ(ct_gram.he_level(), ct_mat.he_level());
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_gram, true), expected_output), MAX_NORM);
+
+    // the output can be used to compute matrix-vector products
+    linear_algebra.rescale_to_next_inplace(ct_gram);
+    Vector vec = random_vec(width);
+    EncryptedColVector ct_vec = linear_algebra.encrypt_col_vector(vec, unit, ct_gram.he_level());
+    EncryptedColVector result = linear_algebra.multiply_diagonal(ct_gram, ct_vec);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(result, true), prec_prod(expected_output, vec)), MAX_NORM);
+
+    // or converted to the row-major layout
+    EncryptedMatrix ct_gram_row_major = linear_algebra.reencode(ct_gram, unit);
+    ASSERT_EQ(ct_gram_row_major.layout(), LAYOUT_ROW_MAJOR);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_gram_row_major, true), expected_output), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, Gram) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, TWO_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    test_gram(linear_algebra, 64, 64, unit1);
+    test_gram(linear_algebra, 200, 13, unit1);
+    test_gram(linear_algebra, 1, 1, unit1);
+
+    // a 128x64 encoding unit
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+    test_gram(linear_algebra, 300, 32, unit2);
+    test_gram(linear_algebra, 128, 17, unit2);
+
+    // only the diagonals within the band of the output are non-zero
+    EncryptedMatrix ct_gram = linear_algebra.gram(linear_algebra.encrypt_matrix(random_mat(100, 10), unit1));
+    ASSERT_FALSE(ct_gram.is_zero_unit(0, 9));
+    ASSERT_TRUE(ct_gram.is_zero_unit(0, 10));
+    ASSERT_TRUE(ct_gram.is_zero_unit(0, 118));
+    ASSERT_FALSE(ct_gram.is_zero_unit(0, 119));
+
+    // blocks of rows which are known to be zero are skipped
+    Matrix mat = random_mat(256, 20);
+    for (int i = 64; i < 128; i++) {
+        for (int j = 0; j < 20; j++) {
+            mat(i, j) = 0;
+        }
+    }
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit1, -1, LAYOUT_ROW_MAJOR, true);
+    ASSERT_TRUE(ct_mat.is_zero_unit(1, 0));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.gram(ct_mat), true), prec_prod(trans(mat), mat)),
+              MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, Gram_RowMajor) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    // inputs which are more than half as wide as the unit, or whose padding is not known to be zero,
+    // are multiplied with multiply_row_major
+    Matrix mat = random_mat(100, 65);
+    EncryptedMatrix ct_mat1 = linear_algebra.encrypt_matrix(mat, unit1);
+    EncryptedMatrix ct_mat2 = linear_algebra.add_plain(linear_algebra.encrypt_matrix(mat, unit1), PI);
+    linear_algebra.sub_plain_inplace(ct_mat2, PI);
+    for (const auto &ct_mat : {ct_mat1, ct_mat2}) {
+        EncryptedMatrix ct_gram = linear_algebra.gram(ct_mat);
+        ASSERT_EQ(ct_gram.layout(), LAYOUT_ROW_MAJOR);
+        ASSERT_TRUE(ct_gram.needs_rescale());
+        ASSERT_EQ(ct_gram.he_level(), ct_mat.he_level() - 2);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(ct_gram, true), prec_prod(trans(mat), mat)), MAX_NORM);
+    }
+}
+
 // Covers EncryptedColVector multiply(const EncryptedRowVector &enc_vec, const EncryptedMatrix &enc_mat)
 TEST(LinearAlgebraTest, MultiplyRowMatrix_InvalidCase) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
@@ -1780,6 +2361,195 @@ TEST(LinearAlgebraTest, MultiplyMatrixCol_Mixed_Unit) {
 // void transpose_unit_inplace(EncryptedColVector &enc_vec)
 // All dimensions of the input object must be smaller than both dimensions of the
 // encoding unit so that the object fits into a single unit and a single transpose unit.
+TEST(LinearAlgebraTest, MultiplyDiagonal_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit
+    int unit1_height = 64;
+    EncodingUnit unit1 = linear_algebra.make_unit(unit1_height);
+    // a 128x32 encoding unit
+    int unit2_height = 128;
+    EncodingUnit unit2 = linear_algebra.make_unit(unit2_height);
+
+    Vector vec1 = random_vec(79);
+    Vector vec2 = random_vec(78);
+    Matrix mat = random_mat(55, 78);
+    EncryptedColVector ciphertext1 = linear_algebra.encrypt_col_vector(vec1, unit1);
+    EncryptedColVector ciphertext2 = linear_algebra.encrypt_col_vector(vec2, unit2);
+    EncryptedColVector ciphertext3 = linear_algebra.encrypt_col_vector(vec2, unit1);
+    EncryptedMatrix ciphertext4 = linear_algebra.encrypt_matrix(mat, unit1, -1, LAYOUT_DIAGONAL);
+    EncryptedMatrix ciphertext5 = linear_algebra.encrypt_matrix(mat, unit1);
+    EncryptedColVector ciphertext6 = linear_algebra.encrypt_col_vector(vec2, unit1, 0);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because dimensions do not match.
+        (linear_algebra.multiply_diagonal(ciphertext4, ciphertext1)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because encoding units do not match.
+        (linear_algebra.multiply_diagonal(ciphertext4, ciphertext2)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the matrix is not in the diagonal layout.
+        (linear_algebra.multiply_diagonal(ciphertext5, ciphertext3)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the levels do not match.
+        (linear_algebra.multiply_diagonal(ciphertext4, ciphertext6)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because sum_rows requires the row-major layout.
+        (linear_algebra.sum_rows(ciphertext4)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the layouts do not match.
+        (linear_algebra.add(ciphertext4, ciphertext5)), invalid_argument);
+}
+
+void test_multiply_diagonal(LinearAlgebra &linear_algebra, int left_dim, int right_dim, EncodingUnit &unit) {
+    // Matrix A is left_dim x right_dim
+    Vector vec = random_vec(right_dim);
+    Matrix mat = random_mat(left_dim, right_dim);
+
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit, -1, LAYOUT_DIAGONAL);
+    ASSERT_EQ(ct_mat.layout(), LAYOUT_DIAGONAL);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_mat), mat), MAX_NORM);
+
+    EncryptedColVector ct_vec = linear_algebra.encrypt_col_vector(vec, unit);
+    EncryptedColVector result = linear_algebra.multiply_diagonal(ct_mat, ct_vec);
+    Vector actual_output = linear_algebra.decrypt(result);
+
+    Vector expected_output = prec_prod(mat, vec);
+
+    ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+    ASSERT_FALSE(result.needs_relin());
+    ASSERT_FALSE(result.needs_rescale());
+    ASSERT_EQ(result.he_level(), ct_mat.he_level() - 1);
+}
+
+TEST(LinearAlgebraTest, MultiplyDiagonal) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit, so blocks are 128x128
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    test_multiply_diagonal(linear_algebra, 128, 128, unit1);
+    test_multiply_diagonal(linear_algebra, 256, 128, unit1);
+    test_multiply_diagonal(linear_algebra, 128, 256, unit1);
+    test_multiply_diagonal(linear_algebra, 13, 78, unit1);
+    test_multiply_diagonal(linear_algebra, 141, 13, unit1);
+    test_multiply_diagonal(linear_algebra, 300, 200, unit1);
+
+    // a 128x64 encoding unit, so blocks are 64x64
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+    test_multiply_diagonal(linear_algebra, 64, 64, unit2);
+    test_multiply_diagonal(linear_algebra, 100, 150, unit2);
+
+    // a block-diagonal matrix: the off-diagonal blocks are skipped
+    Matrix mat = random_mat(256, 256);
+    for (int i = 0; i < 256; i++) {
+        for (int j = 0; j < 256; j++) {
+            if (i / 128 != j / 128) {
+                mat(i, j) = 0;
+            }
+        }
+    }
+    Vector vec = random_vec(256);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit1, -1, LAYOUT_DIAGONAL, true);
+    ASSERT_TRUE(ct_mat.is_zero_unit(0, 128));
+    ASSERT_TRUE(ct_mat.is_zero_unit(1, 0));
+    EncryptedColVector result = linear_algebra.multiply_diagonal(ct_mat, linear_algebra.encrypt_col_vector(vec, unit1));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(result), prec_prod(mat, vec)), MAX_NORM);
+
+    // elementwise operations work in the diagonal layout
+    Matrix mat2 = random_mat(300, 200);
+    Matrix mat3 = random_mat(300, 200);
+    EncryptedMatrix ct_mat2 = linear_algebra.encrypt_matrix(mat2, unit1, -1, LAYOUT_DIAGONAL);
+    EncryptedMatrix ct_mat3 = linear_algebra.encrypt_matrix(mat3, unit1, -1, LAYOUT_DIAGONAL);
+    EncryptedMatrix ct_sum = linear_algebra.add(ct_mat2, ct_mat3);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum), mat2 + mat3), MAX_NORM);
+    EncryptedMatrix ct_prod = linear_algebra.hadamard_multiply(ct_mat2, ct_mat3);
+    linear_algebra.relinearize_inplace(ct_prod);
+    linear_algebra.rescale_to_next_inplace(ct_prod);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_prod), element_prod(mat2, mat3)), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, MultiplyBatch_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    // a 128x32 encoding unit
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+
+    Matrix mat = random_mat(55, 20);
+    EncryptedMatrix ciphertext1 = linear_algebra.encrypt_matrix(mat, unit1);
+    vector<EncryptedColVector> col_vecs{linear_algebra.encrypt_col_vector(random_vec(20), unit1),
+                                        linear_algebra.encrypt_col_vector(random_vec(21), unit1)};
+    vector<EncryptedRowVector> row_vecs{linear_algebra.encrypt_row_vector(random_vec(55), unit1),
+                                        linear_algebra.encrypt_row_vector(random_vec(55), unit2)};
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because dimensions do not match.
+        (linear_algebra.multiply_batch(ciphertext1, col_vecs)), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because encoding units do not match.
+        (linear_algebra.multiply_batch(row_vecs, ciphertext1)), invalid_argument);
+}
+
+void test_multiply_batch(LinearAlgebra &linear_algebra, int left_dim, int right_dim, int batch_size, double scalar,
+                         EncodingUnit &unit) {
+    // Matrix A is left_dim x right_dim
+    Matrix mat = random_mat(left_dim, right_dim);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit);
+
+    vector<Vector> col_vecs(batch_size);
+    vector<Vector> row_vecs(batch_size);
+    vector<EncryptedColVector> ct_col_vecs(batch_size);
+    vector<EncryptedRowVector> ct_row_vecs(batch_size);
+    for (int k = 0; k < batch_size; k++) {
+        col_vecs[k] = random_vec(right_dim);
+        row_vecs[k] = random_vec(left_dim);
+        ct_col_vecs[k] = linear_algebra.encrypt_col_vector(col_vecs[k], unit);
+        ct_row_vecs[k] = linear_algebra.encrypt_row_vector(row_vecs[k], unit);
+    }
+
+    vector<EncryptedRowVector> col_results = linear_algebra.multiply_batch(ct_mat, ct_col_vecs, scalar);
+    vector<EncryptedColVector> row_results = linear_algebra.multiply_batch(ct_row_vecs, ct_mat);
+    ASSERT_EQ(col_results.size(), batch_size);
+    ASSERT_EQ(row_results.size(), batch_size);
+    for (int k = 0; k < batch_size; k++) {
+        ASSERT_LT(relative_error(linear_algebra.decrypt(col_results[k]), scalar * prec_prod(mat, col_vecs[k])),
+                  MAX_NORM);
+        ASSERT_FALSE(col_results[k].needs_relin());
+        ASSERT_TRUE(col_results[k].needs_rescale());
+        ASSERT_EQ(col_results[k].he_level(), ct_mat.he_level() - 1);
+
+        ASSERT_LT(relative_error(linear_algebra.decrypt(row_results[k]), prec_prod(row_vecs[k], mat)), MAX_NORM);
+        ASSERT_FALSE(row_results[k].needs_relin());
+        ASSERT_TRUE(row_results[k].needs_rescale());
+        ASSERT_EQ(row_results[k].he_level(), ct_mat.he_level() - 1);
+    }
+}
+
+TEST(LinearAlgebraTest, MultiplyBatch) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, TWO_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+
+    // products are packed four to a unit, with a partial group
+    test_multiply_batch(linear_algebra, 64, 20, 7, PI, unit1);
+    // multiple vertical units
+    test_multiply_batch(linear_algebra, 150, 32, 5, PI, unit1);
+    // a single vector
+    test_multiply_batch(linear_algebra, 40, 13, 1, PI, unit1);
+    // the matrix spans more than one horizontal unit, so there are no free columns
+    test_multiply_batch(linear_algebra, 40, 200, 3, PI, unit1);
+    // the matrix fills the unit, so there are no free columns
+    test_multiply_batch(linear_algebra, 40, 128, 2, PI, unit1);
+    // an empty batch
+    test_multiply_batch(linear_algebra, 40, 13, 0, PI, unit1);
+}
+
 TEST(LinearAlgebraTest, TransposeUnit_InvalidCase) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
     LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
@@ -1857,6 +2627,273 @@ TEST(LinearAlgebraTest, TransposeUnit) {
               MAX_NORM);
 }
 
+TEST(LinearAlgebraTest, Reencode_InvalidCase) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(random_mat(64, 64), unit1);
+    EncryptedRowVector ct_vec = linear_algebra.encrypt_row_vector(random_vec(64), unit1);
+    // a unit for a different number of slots
+    OpCount op_count = OpCount(2 * NUM_OF_SLOTS);
+    EncodingUnit unit2 = LinearAlgebra(op_count).make_unit(64);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the unit has the wrong number of slots.
+        linear_algebra.reencode(ct_mat, unit2), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the unit has the wrong number of slots.
+        linear_algebra.reencode_as_col_vector(ct_vec, unit2), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the input must have nominal scale.
+        linear_algebra.reencode(linear_algebra.hadamard_square(ct_mat), unit1), invalid_argument);
+}
+
+void test_reencode(LinearAlgebra &linear_algebra, int height, int width, EncodingUnit &unit1, EncodingUnit &unit2) {
+    Matrix mat = random_mat(height, width);
+    // adding and then subtracting a scalar leaves arbitrary values in the padding
+    EncryptedMatrix ct_mat = linear_algebra.add_plain(linear_algebra.encrypt_matrix(mat, unit1), PI);
+    linear_algebra.sub_plain_inplace(ct_mat, PI);
+    EncryptedMatrix result = linear_algebra.reencode(ct_mat, unit2);
+
+    ASSERT_EQ(result.encoding_unit(), unit2);
+    ASSERT_TRUE(result.is_zero_padded());
+    ASSERT_TRUE(result.needs_rescale());
+    ASSERT_EQ(result.he_level(), ct_mat.he_level());
+    ASSERT_LT(relative_error(linear_algebra.decrypt(result, true), mat), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, Reencode) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+    EncodingUnit unit3 = linear_algebra.make_unit(16);
+    test_reencode(linear_algebra, 64, 64, unit1, unit2);
+    test_reencode(linear_algebra, 39, 37, unit1, unit2);
+    test_reencode(linear_algebra, 150, 70, unit1, unit2);
+    test_reencode(linear_algebra, 150, 70, unit2, unit1);
+    test_reencode(linear_algebra, 150, 70, unit1, unit3);
+    test_reencode(linear_algebra, 20, 300, unit3, unit2);
+    test_reencode(linear_algebra, 70, 70, unit1, unit1);
+
+    // units which are known to be zero are skipped, and outputs which only receive zero units are zero
+    Matrix mat = random_mat(128, 64);
+    for (int i = 64; i < 128; i++) {
+        for (int j = 0; j < 64; j++) {
+            mat(i, j) = 0;
+        }
+    }
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit1, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix result = linear_algebra.reencode(ct_mat, unit3);
+    ASSERT_FALSE(result.is_zero_unit(3, 0));
+    ASSERT_TRUE(result.is_zero_unit(4, 0));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(result, true), mat), MAX_NORM);
+
+    // moving from a 64x64 unit to a 128x32 unit shifts each row of the input by a different amount
+    OpCount op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra la_op_count = LinearAlgebra(op_count);
+    la_op_count.reencode(la_op_count.encrypt_matrix(random_mat(64, 64), unit1), unit2);
+    ASSERT_EQ(op_count.num_rotations(), 127);
+}
+
+void test_reencode_diagonal(LinearAlgebra &linear_algebra, int height, int width, EncodingUnit &unit1,
+                            EncodingUnit &unit2) {
+    Matrix mat = random_mat(height, width);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit1, -1, LAYOUT_DIAGONAL);
+    EncryptedMatrix result = linear_algebra.reencode(ct_mat, unit2);
+
+    ASSERT_EQ(result.layout(), LAYOUT_ROW_MAJOR);
+    ASSERT_EQ(result.encoding_unit(), unit2);
+    ASSERT_TRUE(result.is_zero_padded());
+    ASSERT_TRUE(result.needs_rescale());
+    ASSERT_EQ(result.he_level(), ct_mat.he_level());
+    ASSERT_LT(relative_error(linear_algebra.decrypt(result, true), mat), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, Reencode_Diagonal) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+    EncodingUnit unit3 = linear_algebra.make_unit(16);
+    test_reencode_diagonal(linear_algebra, 64, 64, unit1, unit1);
+    test_reencode_diagonal(linear_algebra, 100, 70, unit1, unit1);
+    test_reencode_diagonal(linear_algebra, 100, 70, unit1, unit2);
+    test_reencode_diagonal(linear_algebra, 40, 20, unit2, unit2);
+    test_reencode_diagonal(linear_algebra, 20, 300, unit3, unit3);
+
+    // with the same unit, each entry moves within its row, so each diagonal needs at most two rotations
+    OpCount op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra la_op_count = LinearAlgebra(op_count);
+    la_op_count.reencode(la_op_count.encrypt_matrix(random_mat(64, 64), unit1, -1, LAYOUT_DIAGONAL), unit1);
+    ASSERT_LE(op_count.num_rotations(), 2 * 64);
+}
+
+void test_transpose(LinearAlgebra &linear_algebra, int height, int width, EncodingUnit &unit) {
+    Matrix mat = random_mat(height, width);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit);
+    EncryptedMatrix result = linear_algebra.transpose(ct_mat);
+
+    ASSERT_EQ(result.height(), width);
+    ASSERT_EQ(result.width(), height);
+    ASSERT_EQ(result.encoding_unit(), unit);
+    ASSERT_TRUE(result.needs_rescale());
+    ASSERT_EQ(result.he_level(), ct_mat.he_level());
+    ASSERT_LT(relative_error(linear_algebra.decrypt(result, true), trans(mat)), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, Transpose) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, TWO_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    EncodingUnit unit2 = linear_algebra.make_unit(16);
+    test_transpose(linear_algebra, 64, 64, unit1);
+    test_transpose(linear_algebra, 39, 37, unit1);
+    test_transpose(linear_algebra, 150, 70, unit1);
+    test_transpose(linear_algebra, 20, 300, unit1);
+    test_transpose(linear_algebra, 1, 100, unit1);
+    test_transpose(linear_algebra, 150, 70, unit2);
+
+    // the transpose can be used in a matrix product in place of a second encryption of A^T
+    HomomorphicEval ckks_instance2 = HomomorphicEval(8192, 4, LOG_SCALE);
+    LinearAlgebra linear_algebra2 = LinearAlgebra(ckks_instance2);
+    EncodingUnit unit3 = linear_algebra2.make_unit(64);
+    Matrix mat_a = random_mat(70, 30);
+    Matrix mat_b = random_mat(30, 50);
+    EncryptedMatrix ct_a = linear_algebra2.encrypt_matrix(mat_a, unit3);
+    EncryptedMatrix ct_a_trans = linear_algebra2.rescale_to_next(linear_algebra2.transpose(ct_a));
+    EncryptedMatrix ct_b = linear_algebra2.encrypt_matrix(mat_b, unit3, ct_a_trans.he_level() - 1);
+    ASSERT_LT(relative_error(linear_algebra2.decrypt(linear_algebra2.multiply_row_major(ct_a_trans, ct_b), true),
+                             prec_prod(mat_a, mat_b)),
+              MAX_NORM);
+
+    // each diagonal of a square unit is rotated once
+    OpCount op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra la_op_count = LinearAlgebra(op_count);
+    la_op_count.transpose(la_op_count.encrypt_matrix(random_mat(64, 64), unit1));
+    ASSERT_EQ(op_count.num_rotations(), 126);
+}
+
+Matrix sub_matrix(const Matrix &mat, int first_row, int height, int first_col, int width) {
+    Matrix result(height, width);
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            result(i, j) = mat(first_row + i, first_col + j);
+        }
+    }
+    return result;
+}
+
+TEST(LinearAlgebraTest, UnitBlock) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit, so the matrix is a 3x2 grid of units
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    Matrix mat = random_mat(150, 70);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit1);
+
+    EncryptedMatrix block1 = linear_algebra.unit_block(ct_mat, 1, 2, 0, 1);
+    ASSERT_EQ(block1.height(), 86);
+    ASSERT_EQ(block1.width(), 64);
+    ASSERT_TRUE(block1.is_zero_padded());
+    ASSERT_LT(relative_error(linear_algebra.decrypt(block1), sub_matrix(mat, 64, 86, 0, 64)), MAX_NORM);
+
+    EncryptedMatrix block2 = linear_algebra.unit_block(ct_mat, 0, 1, 1, 1);
+    ASSERT_EQ(block2.height(), 64);
+    ASSERT_EQ(block2.width(), 6);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(block2), sub_matrix(mat, 0, 64, 64, 6)), MAX_NORM);
+
+    // blocks can be used with any API
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.sum_rows(block1)),
+                             linear_algebra.decrypt(linear_algebra.sum_rows(linear_algebra.encrypt_matrix(
+                                 sub_matrix(mat, 64, 86, 0, 64), unit1)))),
+              MAX_NORM);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the block is outside of the grid.
+        linear_algebra.unit_block(ct_mat, 2, 2, 0, 1), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the block is empty.
+        linear_algebra.unit_block(ct_mat, 0, 0, 0, 1), invalid_argument);
+}
+
+TEST(LinearAlgebraTest, Concat) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    Matrix mat = random_mat(150, 70);
+    EncryptedMatrix top = linear_algebra.encrypt_matrix(sub_matrix(mat, 0, 64, 0, 70), unit1);
+    EncryptedMatrix bottom = linear_algebra.encrypt_matrix(sub_matrix(mat, 64, 86, 0, 70), unit1);
+    EncryptedMatrix vertical = linear_algebra.concat_vertical({top, bottom});
+    ASSERT_EQ(vertical.height(), 150);
+    ASSERT_EQ(vertical.width(), 70);
+    ASSERT_TRUE(vertical.is_zero_padded());
+    ASSERT_LT(relative_error(linear_algebra.decrypt(vertical), mat), MAX_NORM);
+
+    EncryptedMatrix left = linear_algebra.encrypt_matrix(sub_matrix(mat, 0, 150, 0, 64), unit1);
+    EncryptedMatrix right = linear_algebra.encrypt_matrix(sub_matrix(mat, 0, 150, 64, 6), unit1);
+    EncryptedMatrix horizontal = linear_algebra.concat_horizontal({left, right});
+    ASSERT_EQ(horizontal.height(), 150);
+    ASSERT_EQ(horizontal.width(), 70);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(horizontal), mat), MAX_NORM);
+
+    // slicing and stacking are inverses
+    EncryptedMatrix restacked = linear_algebra.concat_vertical(
+        {linear_algebra.unit_block(vertical, 0, 1, 0, 2), linear_algebra.unit_block(vertical, 1, 2, 0, 2)});
+    ASSERT_LT(relative_error(linear_algebra.decrypt(restacked), mat), MAX_NORM);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the first input is not aligned to the unit.
+        linear_algebra.concat_horizontal({right, left}), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the heights do not match.
+        linear_algebra.concat_horizontal({left, top}), invalid_argument);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the input is empty.
+        linear_algebra.concat_vertical({}), invalid_argument);
+}
+
+TEST(LinearAlgebraTest, ReencodeVector) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, TWO_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    EncodingUnit unit2 = linear_algebra.make_unit(128);
+    for (int dim : {37, 64, 200}) {
+        Vector vec = random_vec(dim);
+        EncryptedRowVector ct_row = linear_algebra.encrypt_row_vector(vec, unit1);
+        EncryptedColVector ct_col = linear_algebra.encrypt_col_vector(vec, unit1);
+
+        EncryptedRowVector row_to_row = linear_algebra.reencode(ct_row, unit2);
+        EncryptedColVector col_to_col = linear_algebra.reencode(ct_col, unit2);
+        EncryptedColVector row_to_col = linear_algebra.reencode_as_col_vector(ct_row, unit2);
+        EncryptedRowVector col_to_row = linear_algebra.reencode_as_row_vector(ct_col, unit1);
+
+        ASSERT_EQ(row_to_row.encoding_unit(), unit2);
+        ASSERT_EQ(col_to_row.encoding_unit(), unit1);
+        ASSERT_TRUE(row_to_col.needs_rescale());
+        ASSERT_LT(relative_error(linear_algebra.decrypt(row_to_row, true), vec), MAX_NORM);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(col_to_col, true), vec), MAX_NORM);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(row_to_col, true), vec), MAX_NORM);
+        ASSERT_LT(relative_error(linear_algebra.decrypt(col_to_row, true), vec), MAX_NORM);
+
+        // the output is a valid encoding, so it can be used in a matrix product
+        Matrix mat = random_mat(dim, 10);
+        linear_algebra.rescale_to_next_inplace(col_to_row);
+        EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit1, col_to_row.he_level());
+        ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.multiply(col_to_row, ct_mat)),
+                                 prec_prod(trans(mat), vec)),
+                  MAX_NORM);
+    }
+}
+
 TEST(LinearAlgebraTest, ReduceLevelToMinMatrix) {
     HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
     LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
@@ -2147,6 +3184,181 @@ TEST(LinearAlgebraTest, SumCols) {
     test_sum_cols(linear_algebra, 128, 128, PI, unit1);
 }
 
+TEST(LinearAlgebraTest, SumCols_NotZeroPadded) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    OpCount op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra la_op_count = LinearAlgebra(op_count);
+
+    // a 64x64 encoding unit
+    int unit1_height = 64;
+    EncodingUnit unit1 = linear_algebra.make_unit(unit1_height);
+    for (int width : {12, 24, 48, 64}) {
+        Matrix mat = random_mat(39, width);
+        // adding a scalar also adds it to the padding; since these widths are no more expensive to sum than
+        // the whole unit, only the first `width` columns are summed
+        EncryptedMatrix ct_mat = linear_algebra.add_plain(linear_algebra.encrypt_matrix(mat, unit1), PI);
+        ASSERT_FALSE(ct_mat.is_zero_padded());
+        Vector actual_output = linear_algebra.decrypt(linear_algebra.sum_cols(ct_mat));
+        Vector expected_output = sum_cols_plaintext(mat) + width * PI * Vector(vector<double>(39, 1));
+        ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+
+        // the columns are summed with a mixed-radix ladder when it is cheaper than summing the whole unit
+        EncryptedMatrix op_count_mat = la_op_count.add_plain(la_op_count.encrypt_matrix(mat, unit1), PI);
+        int rotations_before = op_count.num_rotations();
+        la_op_count.sum_cols(op_count_mat);
+        // rotations to sum the columns, plus six rotations to replicate the column sums across the unit
+        int expected_rotations = (width == 12 ? 4 : width == 24 ? 5 : 6) + 6;
+        ASSERT_EQ(op_count.num_rotations() - rotations_before, expected_rotations);
+    }
+
+    // a 32x128 encoding unit; these widths are cheaper to sum as the whole unit, which would include the padding
+    EncodingUnit unit2 = linear_algebra.make_unit(32);
+    for (int width : {60, 63, 100, 127}) {
+        Matrix mat = random_mat(39, width);
+        EncryptedMatrix ct_mat = linear_algebra.add_plain(linear_algebra.encrypt_matrix(mat, unit2), 2);
+        Vector actual_output = linear_algebra.decrypt(linear_algebra.sum_cols(ct_mat));
+        Vector expected_output = sum_cols_plaintext(mat) + width * 2 * Vector(vector<double>(39, 1));
+        ASSERT_LT(relative_error(actual_output, expected_output), MAX_NORM);
+    }
+
+    // the padding of a narrower input would be summed with the columns of a wider one
+    EncryptedMatrix ct_narrow = linear_algebra.add_plain(linear_algebra.encrypt_matrix(random_mat(39, 20), unit1), PI);
+    EncryptedMatrix ct_wide = linear_algebra.encrypt_matrix(random_mat(39, 40), unit1);
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the narrower input is not known to be zero padded.
+        (linear_algebra.sum_cols_many({ct_narrow, ct_wide})), invalid_argument);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.sum_cols_many({ct_wide, ct_wide})),
+                             2 * linear_algebra.decrypt(linear_algebra.sum_cols(ct_wide))),
+              MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, RotationRadix) {
+    // keys for every rotation needed by radix-4 ladders
+    vector<int> galois_steps;
+    for (int shift = 1; shift < NUM_OF_SLOTS; shift <<= 1) {
+        for (int k = 1; k < 4 && k * shift < NUM_OF_SLOTS; k++) {
+            galois_steps.push_back(k * shift);
+            galois_steps.push_back(-k * shift);
+        }
+    }
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, true, galois_steps);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    linear_algebra.set_max_rotation_radix(4);
+
+    EncodingUnit unit1 = linear_algebra.make_unit(64);
+    test_sum_cols(linear_algebra, 39, 37, PI, unit1);
+    test_sum_cols(linear_algebra, 64, 128, PI, unit1);
+    test_sum_rows(linear_algebra, 39, 37, unit1);
+    test_sum_rows(linear_algebra, 128, 64, unit1);
+
+    ASSERT_THROW(
+        // Expect invalid_argument is thrown because the radix is too small.
+        linear_algebra.set_max_rotation_radix(1), invalid_argument);
+}
+
+TEST(LinearAlgebraTest, MemoryArena) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    EncodingUnit unit = linear_algebra.make_unit(64);
+
+    // loops are evaluated by three long-lived worker threads
+    NumaTopology topology;
+    topology.node_cpus = {{0, 0, 0}};
+    topology.cpu_node = {0};
+    linear_algebra.enable_numa(topology);
+
+    Matrix mat = random_mat(64, 640);
+    EncryptedMatrix ct_mat = linear_algebra.encrypt_matrix(mat, unit);
+    size_t num_pools = ckks_instance.pool_stats().num_pools;
+
+    // the threads which evaluate the loops of a call made in an arena use it, so their temporaries are released
+    // with the arena
+    EncryptedColVector ct_sum;
+    {
+        MemoryArena arena(ckks_instance);
+        ct_sum = linear_algebra.sum_rows(ct_mat);
+    }
+    ASSERT_EQ(ckks_instance.pool_stats().num_pools, num_pools);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum), sum_rows_plaintext(mat)), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, RotationRadix_InFlight) {
+    vector<int> galois_steps;
+    for (int shift = 1; shift < NUM_OF_SLOTS; shift <<= 1) {
+        for (int k = 1; k < 4 && k * shift < NUM_OF_SLOTS; k++) {
+            galois_steps.push_back(k * shift);
+            galois_steps.push_back(-k * shift);
+        }
+    }
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, true, galois_steps);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    linear_algebra.set_max_rotation_radix(4);
+
+    // three worker threads on a single node, so that key switches are counted
+    NumaTopology topology;
+    topology.node_cpus = {{0, 0, 0}};
+    topology.cpu_node = {0};
+    ckks_instance.replicate_keys(topology);
+    linear_algebra.enable_numa(topology);
+
+    // a single ciphertext in flight: its ladder uses all three threads with three radix-4 rounds
+    EncodingUnit unit = linear_algebra.make_unit(64);
+    EncryptedMatrix ct_mat1 = linear_algebra.encrypt_matrix(random_mat(64, 64), unit);
+    size_t key_switches_before = ckks_instance.key_switches_per_node()[0];
+    linear_algebra.sum_rows(ct_mat1);
+    ASSERT_EQ(ckks_instance.key_switches_per_node()[0] - key_switches_before, 9);
+
+    // three ciphertexts in flight: each ladder uses the six rotations of radix 2
+    EncryptedMatrix ct_mat2 = linear_algebra.encrypt_matrix(random_mat(64, 192), unit);
+    key_switches_before = ckks_instance.key_switches_per_node()[0];
+    linear_algebra.sum_rows(ct_mat2);
+    ASSERT_EQ(ckks_instance.key_switches_per_node()[0] - key_switches_before, 18);
+}
+
+TEST(LinearAlgebraTest, RotationRadix_OpCount) {
+    vector<int> galois_steps;
+    for (int shift = 1; shift < NUM_OF_SLOTS; shift <<= 1) {
+        for (int k = 1; k < 4 && k * shift < NUM_OF_SLOTS; k++) {
+            galois_steps.push_back(k * shift);
+            galois_steps.push_back(-k * shift);
+        }
+    }
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE, true, galois_steps);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    // a dry run with the same keys
+    OpCount op_count = OpCount(NUM_OF_SLOTS, galois_steps);
+    LinearAlgebra op_count_linear_algebra = LinearAlgebra(op_count);
+    // a dry run with the default keys
+    OpCount default_op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra default_linear_algebra = LinearAlgebra(default_op_count);
+
+    // three worker threads on a single node, so that key switches are counted
+    NumaTopology topology;
+    topology.node_cpus = {{0, 0, 0}};
+    topology.cpu_node = {0};
+    ckks_instance.replicate_keys(topology);
+    for (LinearAlgebra *la : {&linear_algebra, &op_count_linear_algebra, &default_linear_algebra}) {
+        la->set_max_rotation_radix(4);
+        la->enable_numa(topology);
+    }
+
+    EncodingUnit unit = linear_algebra.make_unit(64);
+    Matrix mat = random_mat(64, 64);
+    size_t key_switches_before = ckks_instance.key_switches_per_node()[0];
+    linear_algebra.sum_rows(linear_algebra.encrypt_matrix(mat, unit));
+    linear_algebra.sum_cols(linear_algebra.encrypt_matrix(mat, unit));
+    op_count_linear_algebra.sum_rows(op_count_linear_algebra.encrypt_matrix(mat, unit));
+    op_count_linear_algebra.sum_cols(op_count_linear_algebra.encrypt_matrix(mat, unit));
+    default_linear_algebra.sum_rows(default_linear_algebra.encrypt_matrix(mat, unit));
+    default_linear_algebra.sum_cols(default_linear_algebra.encrypt_matrix(mat, unit));
+
+    // sum_rows and sum_cols don't relinearize, so every key switch is a rotation
+    ASSERT_EQ(op_count.num_rotations(), ckks_instance.key_switches_per_node()[0] - key_switches_before);
+    // without the extra keys, the dry run uses radix-2 ladders, which have fewer (but sequential) rotations
+    ASSERT_LT(default_op_count.num_rotations(), op_count.num_rotations());
+}
+
 void test_sum_cols_many(LinearAlgebra &linear_algebra, int height1, int width1, int height2, int width2,
                         EncodingUnit &unit) {
     Matrix mat1 = random_mat(height1, width1);
@@ -2562,3 +3774,271 @@ TEST(LinearAlgebraTest, RescaleToNext_RowVec) {
     ASSERT_FALSE(ct_vec1.needs_relin());
     ASSERT_FALSE(ct_vec1.needs_rescale());
 }
+
+// a random matrix where the (i,j) block of the unit grid is zero whenever i+j is odd
+Matrix random_block_sparse_mat(int height, int width, const EncodingUnit &unit) {
+    Matrix mat = random_mat(height, width);
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            if ((i / unit.encoding_height() + j / unit.encoding_width()) % 2 == 1) {
+                mat(i, j) = 0;
+            }
+        }
+    }
+    return mat;
+}
+
+void test_zero_units(const EncryptedMatrix &enc_mat) {
+    int num_vertical_units = enc_mat.num_vertical_units();
+    int num_horizontal_units = enc_mat.num_horizontal_units();
+    for (int i = 0; i < num_vertical_units; i++) {
+        for (int j = 0; j < num_horizontal_units; j++) {
+            ASSERT_EQ(enc_mat.is_zero_unit(i, j), (i + j) % 2 == 1);
+        }
+    }
+}
+
+TEST(LinearAlgebraTest, ZeroUnits) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit
+    EncodingUnit unit = linear_algebra.make_unit(64);
+
+    Matrix sparse1 = random_block_sparse_mat(150, 140, unit);
+    Matrix sparse2 = random_block_sparse_mat(150, 140, unit);
+    Matrix dense = random_mat(150, 140);
+    EncryptedMatrix ct_sparse1 = linear_algebra.encrypt_matrix(sparse1, unit, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_sparse2 = linear_algebra.encrypt_matrix(sparse2, unit, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_dense = linear_algebra.encrypt_matrix(dense, unit, -1, LAYOUT_ROW_MAJOR, true);
+    test_zero_units(ct_sparse1);
+    ASSERT_TRUE(ct_sparse1.is_zero_padded());
+    ASSERT_FALSE(ct_dense.is_zero_unit(0, 1));
+
+    // by default, the sparsity pattern is private, so no units are marked as zero
+    EncryptedMatrix ct_private = linear_algebra.encrypt_matrix(sparse1, unit);
+    for (int i = 0; i < ct_private.num_vertical_units(); i++) {
+        for (int j = 0; j < ct_private.num_horizontal_units(); j++) {
+            ASSERT_FALSE(ct_private.is_zero_unit(i, j));
+        }
+    }
+
+    // the sum of two matrices with the same zero units has the same zero units
+    EncryptedMatrix ct_sum = linear_algebra.add(ct_sparse1, ct_sparse2);
+    test_zero_units(ct_sum);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum), sparse1 + sparse2), MAX_NORM);
+    ct_sum = linear_algebra.add(ct_sparse1, ct_dense);
+    ASSERT_FALSE(ct_sum.is_zero_unit(0, 1));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum), sparse1 + dense), MAX_NORM);
+    ct_sum = linear_algebra.add(ct_dense, ct_sparse1);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum), dense + sparse1), MAX_NORM);
+
+    // subtracting a dense matrix from a zero unit negates the dense unit
+    EncryptedMatrix ct_diff = linear_algebra.sub(ct_sparse1, ct_dense);
+    ASSERT_FALSE(ct_diff.is_zero_unit(0, 1));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_diff), sparse1 - dense), MAX_NORM);
+
+    // adding a non-zero scalar makes every unit non-zero
+    EncryptedMatrix ct_shifted = linear_algebra.add_plain(ct_sparse1, PI);
+    ASSERT_FALSE(ct_shifted.is_zero_unit(0, 1));
+    ASSERT_FALSE(ct_shifted.is_zero_padded());
+
+    // the product is zero wherever either factor is zero
+    EncryptedMatrix ct_prod = linear_algebra.hadamard_multiply(ct_dense, ct_sparse1);
+    test_zero_units(ct_prod);
+    linear_algebra.relinearize_inplace(ct_prod);
+    linear_algebra.rescale_to_next_inplace(ct_prod);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_prod), element_prod(dense, sparse1)), MAX_NORM);
+    ct_prod = linear_algebra.hadamard_multiply(ct_sparse1, ct_dense);
+    linear_algebra.relinearize_inplace(ct_prod);
+    linear_algebra.rescale_to_next_inplace(ct_prod);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_prod), element_prod(sparse1, dense)), MAX_NORM);
+
+    // summing rows and columns skips the zero units
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.sum_rows(ct_sparse1)), sum_rows_plaintext(sparse1)),
+              MAX_NORM);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.sum_cols(ct_sparse1, PI)),
+                             PI * sum_cols_plaintext(sparse1)),
+              MAX_NORM);
+
+    // a zero-padded matrix which fits in a single horizontal unit only sums the populated columns
+    Matrix narrow = random_mat(100, 20);
+    Matrix narrow_sparse = random_block_sparse_mat(100, 20, unit);
+    EncryptedRowVector ct_narrow_sum = linear_algebra.sum_cols(linear_algebra.encrypt_matrix(narrow, unit));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_narrow_sum), sum_cols_plaintext(narrow)), MAX_NORM);
+    ct_narrow_sum =
+        linear_algebra.sum_cols(linear_algebra.encrypt_matrix(narrow_sparse, unit, -1, LAYOUT_ROW_MAJOR, true));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_narrow_sum), sum_cols_plaintext(narrow_sparse)), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, ZeroUnits_Multiply) {
+    HomomorphicEval ckks_instance = HomomorphicEval(8192, THREE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x128 encoding unit
+    EncodingUnit unit = linear_algebra.make_unit(64);
+
+    Matrix matrix_a_transpose = random_block_sparse_mat(150, 300, unit);
+    Matrix matrix_b = random_block_sparse_mat(150, 200, unit);
+    Matrix matrix_a = trans(matrix_a_transpose);
+    Matrix expected_output = PI * prec_prod(matrix_a, matrix_b);
+
+    EncryptedMatrix ct_a_transpose =
+        linear_algebra.encrypt_matrix(matrix_a_transpose, unit, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_b =
+        linear_algebra.encrypt_matrix(matrix_b, unit, ct_a_transpose.he_level() - 1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_row_major = linear_algebra.multiply_row_major(ct_a_transpose, ct_b, PI);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_row_major), expected_output), MAX_NORM);
+    ASSERT_EQ(ct_row_major.he_level(), ONE_MULTI_DEPTH);
+
+    // col-major multiplication takes A and B^T as inputs
+    Matrix matrix_b_transpose = trans(matrix_b);
+    EncryptedMatrix ct_b_transpose =
+        linear_algebra.encrypt_matrix(matrix_b_transpose, unit, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_a =
+        linear_algebra.encrypt_matrix(matrix_a, unit, ct_b_transpose.he_level() - 1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_col_major = linear_algebra.multiply_col_major(ct_a, ct_b_transpose, PI);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_col_major), expected_output), MAX_NORM);
+    ASSERT_EQ(ct_col_major.he_level(), ONE_MULTI_DEPTH);
+
+    // products with a public matrix
+    EncryptedMatrix ct_plain_right = linear_algebra.multiply_plain(ct_a, matrix_b, PI);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_plain_right), expected_output), MAX_NORM);
+    EncryptedMatrix ct_b_top = linear_algebra.encrypt_matrix(matrix_b, unit, -1, LAYOUT_ROW_MAJOR, true);
+    EncryptedMatrix ct_plain_left = linear_algebra.multiply_plain(matrix_a, ct_b_top, PI);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_plain_left), expected_output), MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, RvalueOverloads) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+
+    // a 64x64 encoding unit
+    EncodingUnit unit = linear_algebra.make_unit(64);
+
+    Matrix mat1 = random_mat(100, 80);
+    Matrix mat2 = random_mat(100, 80);
+    EncryptedMatrix ct_mat1 = linear_algebra.encrypt_matrix(mat1, unit);
+    EncryptedMatrix ct_mat2 = linear_algebra.encrypt_matrix(mat2, unit);
+
+    // temporaries are consumed by each step of the chain
+    EncryptedMatrix ct_prod =
+        linear_algebra.rescale_to_next(linear_algebra.relinearize(linear_algebra.hadamard_multiply(ct_mat1, ct_mat2)));
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_prod), element_prod(mat1, mat2)), MAX_NORM);
+    ASSERT_EQ(ct_prod.he_level(), ct_mat1.he_level() - 1);
+    ASSERT_FALSE(ct_prod.needs_relin());
+    ASSERT_FALSE(ct_prod.needs_rescale());
+
+    // lvalue arguments are unchanged
+    EncryptedMatrix ct_sum = linear_algebra.add(linear_algebra.sub(ct_mat1, ct_mat2), ct_mat2);
+    ct_sum = linear_algebra.multiply_plain(linear_algebra.negate(std::move(ct_sum)), PI);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_sum), -PI * mat1), MAX_NORM);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_mat1), mat1), MAX_NORM);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_mat2), mat2), MAX_NORM);
+    ct_sum = linear_algebra.reduce_level_to(linear_algebra.rescale_to_next(std::move(ct_sum)), ct_prod);
+    ASSERT_EQ(ct_sum.he_level(), ct_prod.he_level());
+
+    // vector/matrix hadamard products reuse a temporary matrix
+    Vector vec1 = random_vec(100);
+    Vector vec2 = random_vec(80);
+    EncryptedRowVector ct_vec1 = linear_algebra.encrypt_row_vector(vec1, unit);
+    EncryptedColVector ct_vec2 = linear_algebra.encrypt_col_vector(vec2, unit);
+    EncryptedMatrix ct_row_prod =
+        linear_algebra.hadamard_multiply(ct_vec1, linear_algebra.encrypt_matrix(mat1, unit));
+    EncryptedMatrix ct_col_prod =
+        linear_algebra.hadamard_multiply(linear_algebra.encrypt_matrix(mat1, unit), ct_vec2);
+    Matrix expected_row_prod = mat1;
+    Matrix expected_col_prod = mat1;
+    for (int i = 0; i < mat1.size1(); i++) {
+        for (int j = 0; j < mat1.size2(); j++) {
+            expected_row_prod(i, j) *= vec1(i);
+            expected_col_prod(i, j) *= vec2(j);
+        }
+    }
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.rescale_to_next(std::move(ct_row_prod))),
+                             expected_row_prod),
+              MAX_NORM);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(linear_algebra.rescale_to_next(std::move(ct_col_prod))),
+                             expected_col_prod),
+              MAX_NORM);
+}
+
+TEST(LinearAlgebraTest, NumaMode) {
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    LinearAlgebra numa_linear_algebra = LinearAlgebra(ckks_instance);
+
+    // two nodes which share a CPU, so that the test runs on any machine
+    NumaTopology topology;
+    topology.node_cpus = {{0}, {0}};
+    topology.cpu_node = {1};
+    ckks_instance.replicate_keys(topology);
+    numa_linear_algebra.enable_numa(topology);
+    ASSERT_EQ(linear_algebra.numa_stats().size(), 0);
+    ASSERT_EQ(numa_linear_algebra.numa_stats().size(), 2);
+
+    EncodingUnit unit = linear_algebra.make_unit(64);
+    Matrix mat1 = random_mat(150, 150);
+    Matrix mat2 = random_mat(150, 150);
+    EncryptedMatrix ct_mat1 = linear_algebra.encrypt_matrix(mat1, unit);
+    EncryptedMatrix ct_mat2 = linear_algebra.encrypt_matrix(mat2, unit);
+
+    EncryptedMatrix ct_prod = numa_linear_algebra.hadamard_multiply(ct_mat1, ct_mat2);
+    numa_linear_algebra.relinearize_inplace(ct_prod);
+    numa_linear_algebra.rescale_to_next_inplace(ct_prod);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(ct_prod), element_prod(mat1, mat2)), MAX_NORM);
+    ASSERT_LT(relative_error(linear_algebra.decrypt(numa_linear_algebra.sum_rows(ct_mat1)),
+                             linear_algebra.decrypt(linear_algebra.sum_rows(ct_mat1))),
+              MAX_NORM);
+
+    // each node processes a contiguous range of the 9 units
+    size_t num_units = 0;
+    for (const auto &stats : numa_linear_algebra.numa_stats()) {
+        ASSERT_GT(stats.num_units, 0);
+        num_units += stats.num_units;
+    }
+    ASSERT_GE(num_units, 3 * ct_prod.num_vertical_units() * ct_prod.num_horizontal_units());
+
+    // every key switch used one of the replicated keys
+    vector<size_t> key_switches = ckks_instance.key_switches_per_node();
+    ASSERT_EQ(key_switches.size(), 2);
+    ASSERT_GT(key_switches[0] + key_switches[1], 0);
+}
+
+TEST(LinearAlgebraTest, EncryptShape) {
+    OpCount op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra la_op_count = LinearAlgebra(op_count);
+    OpCount shape_op_count = OpCount(NUM_OF_SLOTS);
+    LinearAlgebra la_shape_op_count = LinearAlgebra(shape_op_count);
+    EncodingUnit unit = la_op_count.make_unit(64);
+
+    // placeholders have the same units and metadata as real encryptions
+    EncryptedMatrix ct_mat = la_op_count.encrypt_matrix(random_mat(150, 100), unit, TWO_MULTI_DEPTH);
+    EncryptedRowVector ct_vec = la_op_count.encrypt_row_vector(random_vec(150), unit, TWO_MULTI_DEPTH);
+    EncryptedMatrix shape_mat = la_shape_op_count.encrypt_matrix_shape(150, 100, unit, TWO_MULTI_DEPTH);
+    EncryptedRowVector shape_vec = la_shape_op_count.encrypt_row_vector_shape(150, unit, TWO_MULTI_DEPTH);
+    ASSERT_EQ(shape_mat.num_vertical_units(), ct_mat.num_vertical_units());
+    ASSERT_EQ(shape_mat.num_horizontal_units(), ct_mat.num_horizontal_units());
+    ASSERT_EQ(shape_mat.he_level(), ct_mat.he_level());
+    ASSERT_EQ(shape_vec.num_units(), ct_vec.num_units());
+    ASSERT_EQ(la_shape_op_count.encrypt_col_vector_shape(100, unit).num_units(),
+              la_op_count.encrypt_col_vector(random_vec(100), unit).num_units());
+    EncryptedMatrix diag_mat = la_op_count.encrypt_matrix(random_mat(100, 100), unit, -1, LAYOUT_DIAGONAL);
+    EncryptedMatrix shape_diag_mat = la_shape_op_count.encrypt_matrix_shape(100, 100, unit, -1, LAYOUT_DIAGONAL);
+    ASSERT_EQ(shape_diag_mat.num_vertical_units(), diag_mat.num_vertical_units());
+    ASSERT_EQ(shape_diag_mat.num_horizontal_units(), diag_mat.num_horizontal_units());
+
+    // so a dry run with placeholders counts the same operations
+    la_op_count.multiply(ct_vec, ct_mat);
+    la_shape_op_count.multiply(shape_vec, shape_mat);
+    ASSERT_EQ(shape_op_count.num_encryptions(), op_count.num_encryptions());
+    ASSERT_EQ(shape_op_count.num_multiplications(), op_count.num_multiplications());
+    ASSERT_EQ(shape_op_count.num_rotations(), op_count.num_rotations());
+
+    ASSERT_THROW(la_shape_op_count.encrypt_matrix_shape(0, 100, unit), invalid_argument);
+
+    // evaluators which compute on slot data do not support placeholders
+    HomomorphicEval ckks_instance = HomomorphicEval(NUM_OF_SLOTS, ONE_MULTI_DEPTH, LOG_SCALE);
+    LinearAlgebra linear_algebra = LinearAlgebra(ckks_instance);
+    ASSERT_THROW(linear_algebra.encrypt_matrix_shape(64, 64, unit), invalid_argument);
+}